@@ -60,6 +60,7 @@
 #include "app_error_weak.h"
 #include "nrf_bootloader_info.h"
 #include "nrf_delay.h"
+#include "staged_update.h"
 
 static void on_error(void)
 {
@@ -142,6 +143,10 @@ int main(void)
 
     NRF_LOG_INFO("Inside main");
 
+    // Images downloaded by the application are copied over before anything
+    // else looks at the DFU settings
+    staged_update_apply();
+
     ret_val = nrf_bootloader_init(dfu_observer);
     APP_ERROR_CHECK(ret_val);
 
@@ -0,0 +1,293 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include "nrf.h"
+#include "nrf_gpio.h"
+#include "nrf_spim.h"
+#include "nrf_nvmc.h"
+#include "nrf_log.h"
+#include "nrf_dfu_settings.h"
+#include "nrf_dfu_validation.h"
+#include "sha256.h"
+#include "staged_update.h"
+
+// Same wiring as the application, see monocle-core/monocle.h
+#define FLASH_CS_PIN 4
+#define FPGA_CS_MODE_PIN 8
+#define FPGA_RESET_INT_PIN 5
+#define FLASH_SPI_SCK_PIN 7
+#define FLASH_SPI_SDO_PIN 9
+#define FLASH_SPI_SDI_PIN 10
+
+#define SPIM NRF_SPIM2
+#define SPIM_MAX_XFER_LENGTH 255
+
+#define PAGE_SIZE 0x1000
+
+static uint32_t page[PAGE_SIZE / sizeof(uint32_t)];
+
+static void spi_init(void)
+{
+    // The pins went back to inputs on reset, which would let the FPGA boot
+    // and read the flash too. The application sets them up again after
+    nrf_gpio_pin_clear(FPGA_RESET_INT_PIN);
+    nrf_gpio_cfg_output(FPGA_RESET_INT_PIN);
+    nrf_gpio_pin_set(FPGA_CS_MODE_PIN);
+    nrf_gpio_cfg_output(FPGA_CS_MODE_PIN);
+
+    nrf_gpio_pin_set(FLASH_CS_PIN);
+    nrf_gpio_cfg_output(FLASH_CS_PIN);
+
+    // SCK idles high in mode 3
+    nrf_gpio_pin_set(FLASH_SPI_SCK_PIN);
+    nrf_gpio_cfg_output(FLASH_SPI_SCK_PIN);
+    nrf_gpio_pin_clear(FLASH_SPI_SDO_PIN);
+    nrf_gpio_cfg_output(FLASH_SPI_SDO_PIN);
+    nrf_gpio_cfg_input(FLASH_SPI_SDI_PIN, NRF_GPIO_PIN_NOPULL);
+
+    nrf_spim_pins_set(SPIM, FLASH_SPI_SCK_PIN, FLASH_SPI_SDO_PIN, FLASH_SPI_SDI_PIN);
+    nrf_spim_configure(SPIM, NRF_SPIM_MODE_3, NRF_SPIM_BIT_ORDER_MSB_FIRST);
+    nrf_spim_frequency_set(SPIM, NRF_SPIM_FREQ_8M);
+    nrf_spim_orc_set(SPIM, 0xFF);
+    nrf_spim_enable(SPIM);
+}
+
+static void spi_uninit(void)
+{
+    nrf_spim_disable(SPIM);
+    nrf_gpio_cfg_default(FLASH_SPI_SCK_PIN);
+    nrf_gpio_cfg_default(FLASH_SPI_SDO_PIN);
+    nrf_gpio_cfg_default(FLASH_SPI_SDI_PIN);
+}
+
+// EasyDMA moves at most 255 bytes per transfer, so longer ones are split
+static void spi_xfer(uint8_t const *tx, uint8_t *rx, size_t length)
+{
+    while (length > 0)
+    {
+        size_t chunk = length < SPIM_MAX_XFER_LENGTH ? length : SPIM_MAX_XFER_LENGTH;
+
+        nrf_spim_tx_buffer_set(SPIM, tx, tx == NULL ? 0 : chunk);
+        nrf_spim_rx_buffer_set(SPIM, rx, rx == NULL ? 0 : chunk);
+        nrf_spim_event_clear(SPIM, NRF_SPIM_EVENT_END);
+        nrf_spim_task_trigger(SPIM, NRF_SPIM_TASK_START);
+
+        while (!nrf_spim_event_check(SPIM, NRF_SPIM_EVENT_END))
+        {
+        }
+
+        tx = tx == NULL ? NULL : tx + chunk;
+        rx = rx == NULL ? NULL : rx + chunk;
+        length -= chunk;
+    }
+}
+
+static void flash_command(uint8_t const *command, size_t length, bool hold_down_cs)
+{
+    nrf_gpio_pin_clear(FLASH_CS_PIN);
+    spi_xfer(command, NULL, length);
+
+    if (!hold_down_cs)
+    {
+        nrf_gpio_pin_set(FLASH_CS_PIN);
+    }
+}
+
+static void flash_read(void *buffer, uint32_t address, size_t length)
+{
+    uint8_t read_cmd[] = {0x03, address >> 16, address >> 8, address};
+    flash_command(read_cmd, sizeof(read_cmd), true);
+    spi_xfer(NULL, buffer, length);
+    nrf_gpio_pin_set(FLASH_CS_PIN);
+}
+
+static void flash_wait_ready(void)
+{
+    uint8_t status_cmd[] = {0x05};
+    uint8_t status;
+
+    do
+    {
+        flash_command(status_cmd, sizeof(status_cmd), true);
+        spi_xfer(NULL, &status, 1);
+        nrf_gpio_pin_set(FLASH_CS_PIN);
+    } while (status & 0x01);
+}
+
+static void slot_set_state(uint32_t state)
+{
+    uint32_t address = STAGED_UPDATE_START + offsetof(staged_update_header_t, state);
+
+    uint8_t write_enable_cmd[] = {0x06};
+    flash_command(write_enable_cmd, sizeof(write_enable_cmd), false);
+
+    uint8_t page_program_cmd[] = {0x02, address >> 16, address >> 8, address};
+    flash_command(page_program_cmd, sizeof(page_program_cmd), true);
+    spi_xfer((uint8_t const *)&state, NULL, sizeof(state));
+    nrf_gpio_pin_set(FLASH_CS_PIN);
+
+    flash_wait_ready();
+}
+
+static bool slot_hash_matches(staged_update_header_t const *header)
+{
+    uint8_t const *expected;
+    uint32_t image_length;
+
+    if (header->init_length > STAGED_UPDATE_INIT_MAX_LENGTH ||
+        !staged_update_parse(header->init, header->init_length,
+                             &expected, &image_length) ||
+        image_length != header->image_length ||
+        image_length > STAGED_UPDATE_IMAGE_MAX_LENGTH)
+    {
+        return false;
+    }
+
+    sha256_context_t context;
+    uint8_t digest[32];
+    sha256_init(&context);
+
+    for (uint32_t i = 0; i < image_length; i += PAGE_SIZE)
+    {
+        uint32_t chunk = image_length - i < PAGE_SIZE ? image_length - i : PAGE_SIZE;
+        flash_read(page, STAGED_UPDATE_IMAGE_START + i, chunk);
+        sha256_update(&context, (uint8_t const *)page, chunk);
+    }
+
+    // Little endian, as in the init packet
+    sha256_final(&context, digest, 1);
+
+    return memcmp(digest, expected, sizeof(digest)) == 0;
+}
+
+static bool slot_copy(uint32_t dst, uint32_t length)
+{
+    // Until the copy validates, the bootloader must not start what is left
+    // of the old app. If the flash has lost power by the next boot, this
+    // falls back to DFU mode instead
+    s_dfu_settings.bank_0.bank_code = NRF_DFU_BANK_INVALID;
+    if (nrf_dfu_settings_write_and_backup(NULL) != NRF_SUCCESS)
+    {
+        return false;
+    }
+
+    slot_set_state(STAGED_UPDATE_STATE_APPLYING);
+
+    for (uint32_t i = 0; i < length; i += PAGE_SIZE)
+    {
+        uint32_t chunk = length - i < PAGE_SIZE ? length - i : PAGE_SIZE;
+
+        memset(page, 0xFF, sizeof(page));
+        flash_read(page, STAGED_UPDATE_IMAGE_START + i, chunk);
+
+        nrf_nvmc_page_erase(dst + i);
+        nrf_nvmc_write_words(dst + i, page, (chunk + 3) / sizeof(uint32_t));
+    }
+
+    // The internal copy is checked again against the signed hash
+    return nrf_dfu_validation_post_data_execute(dst, length) == NRF_DFU_RES_CODE_SUCCESS;
+}
+
+static bool slot_activate(staged_update_header_t const *header)
+{
+    // Checks the signature and versions the same way as an update over
+    // Bluetooth, and tells where the image goes
+    if (nrf_dfu_validation_init_cmd_create(header->init_length) != NRF_DFU_RES_CODE_SUCCESS ||
+        nrf_dfu_validation_init_cmd_append(header->init, header->init_length) != NRF_DFU_RES_CODE_SUCCESS)
+    {
+        return false;
+    }
+
+    uint32_t dst;
+    uint32_t length;
+
+    if (nrf_dfu_validation_init_cmd_execute(&dst, &length) != NRF_DFU_RES_CODE_SUCCESS ||
+        length != header->image_length)
+    {
+        NRF_LOG_ERROR("Staged init packet rejected");
+        return false;
+    }
+
+    if (!slot_copy(dst, length))
+    {
+        NRF_LOG_ERROR("Staged image does not validate after copy");
+        return false;
+    }
+
+    return nrf_dfu_settings_write_and_backup(NULL) == NRF_SUCCESS;
+}
+
+void staged_update_apply(void)
+{
+    // Only when the application asked for it, as the flash is otherwise not
+    // powered after a cold boot. The flag outlives a reset during the copy
+    // and is only cleared once the slot is settled, so the copy then resumes
+    if (NRF_POWER->GPREGRET != STAGED_UPDATE_GPREGRET)
+    {
+        return;
+    }
+
+    spi_init();
+
+    // Release the flash from deep power down, in case it was
+    uint8_t wakeup_cmd[] = {0xAB, 0, 0, 0};
+    flash_command(wakeup_cmd, sizeof(wakeup_cmd), false);
+    flash_wait_ready();
+
+    static staged_update_header_t header;
+    flash_read(&header, STAGED_UPDATE_START, sizeof(header));
+
+    if (header.magic == STAGED_UPDATE_MAGIC &&
+        (header.state == STAGED_UPDATE_STATE_READY ||
+         header.state == STAGED_UPDATE_STATE_APPLYING))
+    {
+        NRF_LOG_INFO("Applying staged image of %d bytes", header.image_length);
+
+        // The current app is only touched once the image is known to be good
+        if (!slot_hash_matches(&header))
+        {
+            NRF_LOG_ERROR("Staged image does not match its init packet");
+        }
+        else if (nrf_dfu_settings_init(false) != NRF_SUCCESS)
+        {
+            NRF_LOG_ERROR("Could not read the DFU settings");
+        }
+        else
+        {
+            nrf_dfu_validation_init();
+
+            if (!slot_activate(&header))
+            {
+                NRF_LOG_ERROR("Staged update failed");
+            }
+        }
+
+        // Settles the slot, so that the same image is never applied twice
+        slot_set_state(STAGED_UPDATE_STATE_DONE);
+    }
+
+    NRF_POWER->GPREGRET = 0;
+    spi_uninit();
+}
@@ -0,0 +1,208 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Application images staged in external flash. The running app
+ *        downloads the nrfutil init packet and firmware into the slot, checks
+ *        the firmware against the hash of the init packet, then resets with
+ *        STAGED_UPDATE_GPREGRET set. The bootloader checks the signature of
+ *        the init packet, and copies the image into internal flash. Shared by
+ *        both, so only plain C here.
+ */
+
+// Between the filesystem and the asset store, sized for the whole app region
+// from the end of the SoftDevice at 0x26000 to the bootloader at 0x78000
+#define STAGED_UPDATE_START 0x9D000
+#define STAGED_UPDATE_IMAGE_START (STAGED_UPDATE_START + 0x1000)
+#define STAGED_UPDATE_IMAGE_MAX_LENGTH 0x52000
+#define STAGED_UPDATE_LENGTH (0x1000 + STAGED_UPDATE_IMAGE_MAX_LENGTH)
+
+// Same limit as INIT_COMMAND_MAX_SIZE in the DFU settings
+#define STAGED_UPDATE_INIT_MAX_LENGTH 512
+
+// Value of GPREGRET asking the bootloader to apply the slot. It doesn't have
+// all the bits of the 0xB1 that enters DFU mode
+#define STAGED_UPDATE_GPREGRET 0xB4
+
+#define STAGED_UPDATE_MAGIC 0x4D555044
+
+// The state word is only ever cleared bit by bit, so no erase is needed. A
+// slot left applying by a reset during the copy is copied again
+#define STAGED_UPDATE_STATE_READY 0x59444152
+#define STAGED_UPDATE_STATE_APPLYING 0x40404040
+#define STAGED_UPDATE_STATE_DONE 0x00000000
+
+typedef struct staged_update_header_t
+{
+    uint32_t magic;
+    uint32_t state;
+    uint32_t init_length;
+    uint32_t image_length;
+    uint8_t init[STAGED_UPDATE_INIT_MAX_LENGTH];
+} staged_update_header_t;
+
+void staged_update_apply(void);
+
+/**
+ * @brief Minimal protobuf reader for the init packet. Returns the bytes taken
+ *        by a varint, or 0 if it is truncated.
+ */
+
+static inline size_t staged_update_varint(const uint8_t *buf, size_t len,
+                                          uint32_t *value)
+{
+    *value = 0;
+
+    for (size_t i = 0; i < len && i < 5; i++)
+    {
+        *value |= (uint32_t)(buf[i] & 0x7F) << (7 * i);
+
+        if ((buf[i] & 0x80) == 0)
+        {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Finds the first occurrence of a field in a message. Length delimited
+ *        fields are returned in *data with their length in *value, varints
+ *        in *value with *data set to NULL.
+ */
+
+static inline bool staged_update_field(const uint8_t *msg, size_t len,
+                                       uint32_t field,
+                                       const uint8_t **data, uint32_t *value)
+{
+    size_t i = 0;
+
+    while (i < len)
+    {
+        uint32_t key;
+        size_t n = staged_update_varint(msg + i, len - i, &key);
+        if (n == 0)
+        {
+            return false;
+        }
+        i += n;
+
+        uint32_t v = 0;
+        const uint8_t *d = NULL;
+
+        switch (key & 0x07)
+        {
+        case 0: // Varint
+            n = staged_update_varint(msg + i, len - i, &v);
+            if (n == 0)
+            {
+                return false;
+            }
+            break;
+
+        case 1: // 64-bit
+            n = 8;
+            break;
+
+        case 2: // Length delimited
+            n = staged_update_varint(msg + i, len - i, &v);
+            if (n == 0 || v > len - i - n)
+            {
+                return false;
+            }
+            d = msg + i + n;
+            n += v;
+            break;
+
+        case 5: // 32-bit
+            n = 4;
+            break;
+
+        default:
+            return false;
+        }
+
+        if (n > len - i)
+        {
+            return false;
+        }
+
+        if ((key >> 3) == field)
+        {
+            *data = d;
+            *value = v;
+            return true;
+        }
+
+        i += n;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Gets the application size and its SHA-256 out of an init packet,
+ *        following dfu-cc.proto: Packet.signed_command.command.init. The hash
+ *        is stored little endian, as nrfutil writes it.
+ */
+
+static inline bool staged_update_parse(const uint8_t *packet, size_t len,
+                                       const uint8_t **hash,
+                                       uint32_t *image_length)
+{
+    const uint8_t *msg;
+    uint32_t msg_len;
+    const uint8_t *field;
+    uint32_t field_len;
+
+    if (!staged_update_field(packet, len, 2, &msg, &msg_len) || msg == NULL ||
+        !staged_update_field(msg, msg_len, 1, &msg, &msg_len) || msg == NULL ||
+        !staged_update_field(msg, msg_len, 2, &msg, &msg_len) || msg == NULL)
+    {
+        return false;
+    }
+
+    if (!staged_update_field(msg, msg_len, 7, &field, image_length) ||
+        field != NULL)
+    {
+        return false;
+    }
+
+    if (!staged_update_field(msg, msg_len, 8, &field, &field_len) ||
+        field == NULL ||
+        !staged_update_field(field, field_len, 2, hash, &field_len) ||
+        *hash == NULL || field_len != 32)
+    {
+        return false;
+    }
+
+    return true;
+}
@@ -24,6 +24,7 @@
 
 #pragma once
 #include <stdint.h>
+#include "monocle.h"
 
 typedef struct display_config_t
 {
@@ -163,11 +164,7 @@ const display_config_t display_config[] = {
     {0x00, 0x9F},
 };
 
-typedef struct camera_config_t
-{
-    uint16_t address;
-    uint8_t value;
-} camera_config_t;
+typedef i2c_register_t camera_config_t;
 
 // Useful resources for the camera configuration. The table below is based on
 // the Linux driver, along with some tweaks to enable MIPI and set resolution
@@ -25,9 +25,15 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "monocle.h"
+#include "battery.h"
 #include "bluetooth.h"
+#include "events.h"
+#include "filetransfer.h"
+#include "mpycache.h"
+#include "storage.h"
 #include "touch.h"
 #include "config-tables.h"
 
@@ -76,6 +82,8 @@ static struct ble_handles_t
     ble_gatts_char_handles_t repl_tx_notification;
     ble_gatts_char_handles_t data_rx_write;
     ble_gatts_char_handles_t data_tx_notification;
+    ble_gatts_char_handles_t file_rx_write;
+    ble_gatts_char_handles_t file_tx_notification;
 } ble_handles = {
     .connection = BLE_CONN_HANDLE_INVALID,
     .advertising = BLE_GAP_ADV_SET_HANDLE_NOT_SET,
@@ -91,24 +99,151 @@ static struct advertising_data_t
 };
 
 #define BLE_PREFERRED_MAX_MTU 256
+
+// Largest link layer payload allowed by data length extension
+#define BLE_PREFERRED_DATA_LENGTH 251
+
+// Link layer payload before any data length update
+#define BLE_DEFAULT_DATA_LENGTH 27
+
+// Radio time per connection event in 1.25ms units, extended when possible
+#define BLE_GAP_EVENT_LENGTH 6
 uint16_t ble_negotiated_mtu;
 
+static uint8_t repl_rx_buffer[BLE_REPL_RX_BUFFER_SIZE];
+static uint8_t repl_tx_buffer[BLE_REPL_TX_BUFFER_SIZE];
+
 static struct ble_ring_buffer_t
 {
-    uint8_t buffer[1024];
-    uint16_t head;
-    uint16_t tail;
+    uint8_t *buffer;
+    uint16_t size;
+    volatile uint16_t head;
+    volatile uint16_t tail;
 } repl_rx = {
-    .buffer = "",
+    .buffer = repl_rx_buffer,
+    .size = sizeof(repl_rx_buffer),
     .head = 0,
     .tail = 0,
 },
   repl_tx = {
-      .buffer = "",
+      .buffer = repl_tx_buffer,
+      .size = sizeof(repl_tx_buffer),
       .head = 0,
       .tail = 0,
 };
 
+// Counters are plain increments so they can stay on in production
+static ble_stats_t ble_stats = {
+    .tx_phy = BLE_GAP_PHY_1MBPS,
+    .rx_phy = BLE_GAP_PHY_1MBPS,
+    .max_tx_octets = BLE_DEFAULT_DATA_LENGTH,
+    .max_rx_octets = BLE_DEFAULT_DATA_LENGTH,
+};
+
+const ble_stats_t *ble_get_stats(void)
+{
+    return &ble_stats;
+}
+
+void ble_reset_stats(void)
+{
+    // Link parameters describe the current connection so are kept
+    uint8_t tx_phy = ble_stats.tx_phy;
+    uint8_t rx_phy = ble_stats.rx_phy;
+    uint16_t connection_interval = ble_stats.connection_interval;
+    uint16_t slave_latency = ble_stats.slave_latency;
+    uint16_t supervision_timeout = ble_stats.supervision_timeout;
+    uint16_t max_tx_octets = ble_stats.max_tx_octets;
+    uint16_t max_rx_octets = ble_stats.max_rx_octets;
+
+    memset(&ble_stats, 0, sizeof(ble_stats));
+
+    ble_stats.tx_phy = tx_phy;
+    ble_stats.rx_phy = rx_phy;
+    ble_stats.connection_interval = connection_interval;
+    ble_stats.slave_latency = slave_latency;
+    ble_stats.supervision_timeout = supervision_timeout;
+    ble_stats.max_tx_octets = max_tx_octets;
+    ble_stats.max_rx_octets = max_rx_octets;
+}
+
+static uint16_t ble_ring_used(struct ble_ring_buffer_t *ring)
+{
+    uint16_t head = ring->head;
+    uint16_t tail = ring->tail;
+
+    return head >= tail ? head - tail : ring->size - tail + head;
+}
+
+static uint16_t ble_ring_push(struct ble_ring_buffer_t *ring,
+                              const uint8_t *data,
+                              uint16_t len)
+{
+    // One slot is kept empty to tell a full ring from an empty one
+    uint16_t space = ring->size - 1 - ble_ring_used(ring);
+    uint16_t head = ring->head;
+
+    len = MIN(len, space);
+
+    // Copy up to the end of the buffer, and then the wrapped around part
+    uint16_t first = MIN(len, ring->size - head);
+    memcpy(&ring->buffer[head], data, first);
+    memcpy(&ring->buffer[0], &data[first], len - first);
+
+    head += len;
+    if (head >= ring->size)
+    {
+        head -= ring->size;
+    }
+    ring->head = head;
+
+    uint16_t used = ble_ring_used(ring);
+
+    if (ring == &repl_rx && used > ble_stats.repl_rx_high_water)
+    {
+        ble_stats.repl_rx_high_water = used;
+    }
+
+    if (ring == &repl_tx && used > ble_stats.repl_tx_high_water)
+    {
+        ble_stats.repl_tx_high_water = used;
+    }
+
+    return len;
+}
+
+static void repl_rx_push(const uint8_t *data, uint16_t len)
+{
+    while (len > 0)
+    {
+        // Keyboard interrupts are caught here rather than buffered
+        const uint8_t *interrupt = NULL;
+        if (mp_interrupt_char >= 0)
+        {
+            interrupt = memchr(data, mp_interrupt_char, len);
+        }
+
+        uint16_t span = interrupt ? interrupt - data : len;
+
+        // Bytes lost because the host wrote faster than the REPL could read
+        ble_stats.repl_rx_dropped += span - ble_ring_push(&repl_rx, data, span);
+
+        if (interrupt)
+        {
+            mp_sched_keyboard_interrupt();
+            span++;
+        }
+
+        data += span;
+        len -= span;
+    }
+}
+
+bool ble_is_connected(void)
+{
+    return ble_handles.connection != BLE_CONN_HANDLE_INVALID;
+}
+
 bool ble_are_tx_notifications_enabled(ble_tx_channel_t channel)
 {
     uint8_t value_buffer[2] = {0};
@@ -135,6 +270,14 @@ bool ble_are_tx_notifications_enabled(ble_tx_channel_t channel)
                                        &value));
         break;
     }
+
+    case FILE_TX:
+    {
+        app_err(sd_ble_gatts_value_get(ble_handles.connection,
+                                       ble_handles.file_tx_notification.cccd_handle,
+                                       &value));
+        break;
+    }
     }
 
     // Value of 0x0001 means that notifications are enabled
@@ -151,6 +294,15 @@ size_t ble_get_max_payload_size(void)
     return ble_negotiated_mtu;
 }
 
+// Number of notifications the softdevice may queue on each connection event
+#define BLE_HVN_TX_QUEUE_SIZE 8
+
+// Set when the softdevice notification queue is full, until a TX complete event
+static volatile bool ble_hvn_tx_queue_full = false;
+
+// Counts TX complete events, to catch one arriving just as the queue fills
+static volatile uint32_t ble_hvn_tx_completions = 0;
+
 static bool ble_send_repl_data(void)
 {
     if (ble_handles.connection == BLE_CONN_HANDLE_INVALID)
@@ -163,105 +315,332 @@ static bool ble_send_repl_data(void)
         return true;
     }
 
-    if (repl_tx.head == repl_tx.tail)
+    // Keep queuing notifications until the ring is empty or the queue is full
+    while (repl_tx.head != repl_tx.tail)
     {
-        return true;
-    }
+        // Wait for BLE_GATTS_EVT_HVN_TX_COMPLETE before trying again
+        if (ble_hvn_tx_queue_full)
+        {
+            return true;
+        }
 
-    uint8_t tx_buffer[BLE_PREFERRED_MAX_MTU] = "";
-    uint16_t tx_length = 0;
+        uint8_t tx_buffer[BLE_PREFERRED_MAX_MTU] = "";
+        uint16_t tx_length = 0;
 
-    uint16_t buffered_tail = repl_tx.tail;
+        uint16_t buffered_tail = repl_tx.tail;
 
-    while (buffered_tail != repl_tx.head)
-    {
-        tx_buffer[tx_length++] = repl_tx.buffer[buffered_tail++];
+        while (buffered_tail != repl_tx.head)
+        {
+            tx_buffer[tx_length++] = repl_tx.buffer[buffered_tail++];
+
+            if (buffered_tail == repl_tx.size)
+            {
+                buffered_tail = 0;
+            }
 
-        if (buffered_tail == sizeof(repl_tx.buffer))
+            if (tx_length == ble_negotiated_mtu)
+            {
+                break;
+            }
+        }
+
+        // Initialise the handle value parameters
+        ble_gatts_hvx_params_t hvx_params = {0};
+        hvx_params.handle = ble_handles.repl_tx_notification.value_handle;
+        hvx_params.p_data = tx_buffer;
+        hvx_params.p_len = (uint16_t *)&tx_length;
+        hvx_params.type = BLE_GATT_HVX_NOTIFICATION;
+
+        uint32_t completions = ble_hvn_tx_completions;
+        uint32_t status = sd_ble_gatts_hvx(ble_handles.connection, &hvx_params);
+
+        if (status == NRF_ERROR_RESOURCES)
         {
-            buffered_tail = 0;
+            ble_stats.repl_notifications_rejected++;
+            ble_hvn_tx_queue_full = true;
+
+            // A TX complete since the attempt has already freed some space,
+            // and won't come again to clear the flag
+            if (completions != ble_hvn_tx_completions)
+            {
+                ble_hvn_tx_queue_full = false;
+                continue;
+            }
+
+            return true;
         }
 
-        if (tx_length == ble_negotiated_mtu)
+        if (status != NRF_SUCCESS)
         {
-            break;
+            ble_stats.repl_notifications_rejected++;
+            return false;
         }
+
+        TRACE(TRACE_BLE_HVX_QUEUED, REPL_TX);
+        ble_stats.repl_notifications_queued++;
+        ble_stats.repl_bytes_sent += tx_length;
+        repl_tx.tail = buffered_tail;
+    }
+
+    return true;
+}
+
+bool ble_send_raw_data(const uint8_t *bytes, size_t len)
+{
+    if (ble_handles.connection == BLE_CONN_HANDLE_INVALID)
+    {
+        return true;
+    }
+
+    if (!ble_are_tx_notifications_enabled(DATA_TX))
+    {
+        return true;
     }
 
     // Initialise the handle value parameters
     ble_gatts_hvx_params_t hvx_params = {0};
-    hvx_params.handle = ble_handles.repl_tx_notification.value_handle;
-    hvx_params.p_data = tx_buffer;
-    hvx_params.p_len = (uint16_t *)&tx_length;
+    hvx_params.handle = ble_handles.data_tx_notification.value_handle;
+    hvx_params.p_data = bytes;
+    hvx_params.p_len = (uint16_t *)&len;
     hvx_params.type = BLE_GATT_HVX_NOTIFICATION;
 
     uint32_t status = sd_ble_gatts_hvx(ble_handles.connection, &hvx_params);
 
     if (status == NRF_SUCCESS)
     {
-        repl_tx.tail = buffered_tail;
+        TRACE(TRACE_BLE_HVX_QUEUED, DATA_TX);
+        ble_stats.data_notifications_queued++;
+        ble_stats.data_bytes_sent += len;
+        return false;
     }
 
-    return false;
+    ble_stats.data_notifications_rejected++;
+    return true;
 }
 
-bool ble_send_raw_data(const uint8_t *bytes, size_t len)
+bool ble_send_file_data(const uint8_t *bytes, size_t len)
 {
     if (ble_handles.connection == BLE_CONN_HANDLE_INVALID)
     {
         return true;
     }
 
-    if (!ble_are_tx_notifications_enabled(DATA_TX))
+    if (!ble_are_tx_notifications_enabled(FILE_TX))
     {
         return true;
     }
 
     // Initialise the handle value parameters
     ble_gatts_hvx_params_t hvx_params = {0};
-    hvx_params.handle = ble_handles.data_tx_notification.value_handle;
+    hvx_params.handle = ble_handles.file_tx_notification.value_handle;
     hvx_params.p_data = bytes;
     hvx_params.p_len = (uint16_t *)&len;
     hvx_params.type = BLE_GATT_HVX_NOTIFICATION;
 
-    uint32_t status = sd_ble_gatts_hvx(ble_handles.connection, &hvx_params);
+    if (sd_ble_gatts_hvx(ble_handles.connection, &hvx_params) != NRF_SUCCESS)
+    {
+        return true;
+    }
 
-    if (status == NRF_SUCCESS)
+    TRACE(TRACE_BLE_HVX_QUEUED, FILE_TX);
+    return false;
+}
+
+bool ble_request_connection_params(uint32_t min_interval_us,
+                                   uint32_t max_interval_us,
+                                   uint16_t slave_latency,
+                                   uint16_t supervision_timeout_ms)
+{
+    if (ble_handles.connection == BLE_CONN_HANDLE_INVALID)
     {
-        return false;
+        return true;
     }
 
-    return true;
+    ble_gap_conn_params_t conn_params = {
+        .min_conn_interval = min_interval_us / 1250,
+        .max_conn_interval = max_interval_us / 1250,
+        .slave_latency = slave_latency,
+        .conn_sup_timeout = supervision_timeout_ms / 10,
+    };
+
+    return sd_ble_gap_conn_param_update(ble_handles.connection,
+                                        &conn_params) != NRF_SUCCESS;
 }
 
-void mp_hal_stdout_tx_strn(const char *str, mp_uint_t len)
+#if MONOCLE_L2CAP
+
+// L2CAP connection oriented channel, only accepted once a PSM is opened
+#define BLE_L2CAP_MPS (BLE_PREFERRED_DATA_LENGTH - 4)
+#define BLE_L2CAP_SDU_SIZE 1024
+
+static uint8_t l2cap_sdu_buffer[BLE_L2CAP_SDU_SIZE];
+static uint8_t l2cap_rx_buffer[2 * BLE_L2CAP_SDU_SIZE];
+
+static struct ble_ring_buffer_t l2cap_rx = {
+    .buffer = l2cap_rx_buffer,
+    .size = sizeof(l2cap_rx_buffer),
+    .head = 0,
+    .tail = 0,
+};
+
+static struct ble_l2cap_t
 {
-    for (uint16_t position = 0; position < len; position++)
+    uint16_t psm;
+    uint16_t cid;
+    uint16_t tx_mtu;
+    volatile bool tx_pending;
+    bool rx_buffer_held;
+} l2cap = {
+    .psm = 0,
+    .cid = BLE_L2CAP_CID_INVALID,
+};
+
+static void ble_l2cap_give_rx_buffer(void)
+{
+    // Credits stop flowing while the softdevice has no buffer to fill
+    if (l2cap.cid == BLE_L2CAP_CID_INVALID || l2cap.rx_buffer_held ||
+        l2cap_rx.size - 1 - ble_ring_used(&l2cap_rx) < sizeof(l2cap_sdu_buffer))
+    {
+        return;
+    }
+
+    ble_data_t sdu_buf = {.p_data = l2cap_sdu_buffer,
+                          .len = sizeof(l2cap_sdu_buffer)};
+
+    if (sd_ble_l2cap_ch_rx(ble_handles.connection,
+                           l2cap.cid,
+                           &sdu_buf) == NRF_SUCCESS)
     {
-        while (repl_tx.head == repl_tx.tail - 1)
+        l2cap.rx_buffer_held = true;
+    }
+}
+
+void ble_l2cap_listen(uint16_t psm)
+{
+    l2cap.psm = psm;
+}
+
+void ble_l2cap_close(void)
+{
+    l2cap.psm = 0;
+
+    if (l2cap.cid != BLE_L2CAP_CID_INVALID)
+    {
+        app_err(sd_ble_l2cap_ch_release(ble_handles.connection, l2cap.cid));
+    }
+}
+
+bool ble_l2cap_is_connected(void)
+{
+    return l2cap.cid != BLE_L2CAP_CID_INVALID;
+}
+
+bool ble_l2cap_send(const uint8_t *bytes, size_t len)
+{
+    while (len > 0)
+    {
+        if (l2cap.cid == BLE_L2CAP_CID_INVALID)
+        {
+            return true;
+        }
+
+        // The softdevice sends straight from our buffer until the TX event
+        ble_data_t sdu_buf = {.p_data = (uint8_t *)bytes,
+                              .len = MIN(len, l2cap.tx_mtu)};
+
+        l2cap.tx_pending = true;
+        uint32_t status = sd_ble_l2cap_ch_tx(ble_handles.connection,
+                                             l2cap.cid,
+                                             &sdu_buf);
+
+        // Out of credits or queue space, so wait for the peer to catch up
+        if (status == NRF_ERROR_RESOURCES)
         {
+            l2cap.tx_pending = false;
             MICROPY_EVENT_POLL_HOOK;
+            continue;
         }
 
-        repl_tx.buffer[repl_tx.head++] = str[position];
+        if (status != NRF_SUCCESS)
+        {
+            l2cap.tx_pending = false;
+            return true;
+        }
 
-        if (repl_tx.head == sizeof(repl_tx.buffer))
+        while (l2cap.tx_pending)
         {
-            repl_tx.head = 0;
+            MICROPY_EVENT_POLL_HOOK;
+        }
+
+        bytes += sdu_buf.len;
+        len -= sdu_buf.len;
+    }
+
+    return false;
+}
+
+size_t ble_l2cap_available(void)
+{
+    return ble_ring_used(&l2cap_rx);
+}
+
+size_t ble_l2cap_read(uint8_t *buffer, size_t len)
+{
+    uint16_t tail = l2cap_rx.tail;
+
+    len = MIN(len, ble_ring_used(&l2cap_rx));
+
+    uint16_t first = MIN(len, l2cap_rx.size - tail);
+    memcpy(buffer, &l2cap_rx.buffer[tail], first);
+    memcpy(&buffer[first], &l2cap_rx.buffer[0], len - first);
+
+    tail += len;
+    if (tail >= l2cap_rx.size)
+    {
+        tail -= l2cap_rx.size;
+    }
+    l2cap_rx.tail = tail;
+
+    // Space may have freed up for the next SDU
+    ble_l2cap_give_rx_buffer();
+
+    return len;
+}
+
+#endif
+
+void mp_hal_stdout_tx_strn(const char *str, mp_uint_t len)
+{
+    while (len > 0)
+    {
+        uint16_t pushed = ble_ring_push(&repl_tx,
+                                        (const uint8_t *)str,
+                                        MIN(len, repl_tx.size));
+
+        str += pushed;
+        len -= pushed;
+
+        // Wait for the ring to drain if it's full
+        if (len > 0)
+        {
+            mp_hal_wakeup_ticks = MP_HAL_WAKEUP_ON_EVENT;
+            MICROPY_EVENT_POLL_HOOK;
         }
     }
 }
 
 int mp_hal_stdin_rx_chr(void)
 {
+    // Only received data ends this, so sleep until it comes
     while (repl_rx.head == repl_rx.tail)
     {
+        mp_hal_wakeup_ticks = MP_HAL_WAKEUP_ON_EVENT;
         MICROPY_EVENT_POLL_HOOK;
     }
 
     uint16_t next = repl_rx.tail + 1;
 
-    if (next == sizeof(repl_rx.buffer))
+    if (next == repl_rx.size)
     {
         next = 0;
     }
@@ -275,15 +654,29 @@ int mp_hal_stdin_rx_chr(void)
 
 uintptr_t mp_hal_stdio_poll(uintptr_t poll_flags)
 {
-    return (repl_rx.head == repl_rx.tail) ? poll_flags & MP_STREAM_POLL_RD : 0;
+    return (repl_rx.head != repl_rx.tail) ? poll_flags & MP_STREAM_POLL_RD : 0;
 }
 
+// The touch IC is read from a software interrupt, so that the GPIOTE and RTC
+// interrupts only pend it and return. The gesture timeouts come back here too
+#define TOUCH_BOTTOM_HALF_IRQn SWI3_EGU3_IRQn
+
 static void touch_interrupt_handler(nrfx_gpiote_pin_t pin,
                                     nrf_gpiote_polarity_t polarity)
 {
     (void)pin;
     (void)polarity;
 
+    NRFX_IRQ_PENDING_SET(TOUCH_BOTTOM_HALF_IRQn);
+}
+
+void mp_hal_alarm_handler(void)
+{
+    NRFX_IRQ_PENDING_SET(TOUCH_BOTTOM_HALF_IRQn);
+}
+
+void SWI3_EGU3_IRQHandler(void)
+{
     i2c_response_t interrupt = monocle_i2c_read(TOUCH_I2C_ADDRESS, 0x12, 0xFF);
     app_err(interrupt.fail);
 
@@ -296,6 +689,14 @@ static void touch_interrupt_handler(nrfx_gpiote_pin_t pin,
     {
         touch_event_handler(TOUCH_B);
     }
+
+    uint32_t delay_ms = touch_gesture_update(interrupt.value & 0x10,
+                                             interrupt.value & 0x20,
+                                             mp_hal_ticks_ms());
+    if (delay_ms)
+    {
+        mp_hal_alarm_set(delay_ms);
+    }
 }
 
 touch_action_t touch_get_state(void)
@@ -321,13 +722,71 @@ touch_action_t touch_get_state(void)
     return TOUCH_NONE;
 }
 
-void unused_rtc_event_handler(nrfx_rtc_int_type_t int_type) {}
-
 static void softdevice_assert_handler(uint32_t id, uint32_t pc, uint32_t info)
 {
     app_err(0x5D000000 & id);
 }
 
+// Set while a data length update is still to be started on this connection
+static bool ble_data_length_pending = false;
+
+static void ble_link_data_length_update(uint16_t connection)
+{
+    ble_gap_data_length_params_t params = {
+        .max_tx_octets = BLE_PREFERRED_DATA_LENGTH,
+        .max_rx_octets = BLE_PREFERRED_DATA_LENGTH,
+        .max_tx_time_us = BLE_GAP_DATA_LENGTH_AUTO,
+        .max_rx_time_us = BLE_GAP_DATA_LENGTH_AUTO,
+    };
+    ble_gap_data_length_limitation_t limitation = {0};
+
+    uint32_t status = sd_ble_gap_data_length_update(connection,
+                                                    &params,
+                                                    &limitation);
+
+    // If the event length can't fit the full payload, let the stack decide
+    if (status == NRF_ERROR_RESOURCES)
+    {
+        NRFX_LOG("Data length limited by %u us",
+                 limitation.tx_rx_time_limited_us);
+        status = sd_ble_gap_data_length_update(connection, NULL, NULL);
+    }
+
+    // Another link procedure is running, so try again when it completes
+    ble_data_length_pending = status == NRF_ERROR_BUSY;
+
+    // Centrals without data length extension keep the default 27 bytes
+    if (status != NRF_SUCCESS &&
+        status != NRF_ERROR_BUSY &&
+        status != NRF_ERROR_NOT_SUPPORTED)
+    {
+        NRFX_LOG("Data length update failed: 0x%x", status);
+    }
+}
+
+static void ble_link_tune(uint16_t connection)
+{
+    // Prefer 2M PHY, the softdevice falls back to 1M if it's not supported
+    ble_gap_phys_t const phys = {
+        .rx_phys = BLE_GAP_PHY_2MBPS | BLE_GAP_PHY_1MBPS,
+        .tx_phys = BLE_GAP_PHY_2MBPS | BLE_GAP_PHY_1MBPS,
+    };
+
+    uint32_t status = sd_ble_gap_phy_update(connection, &phys);
+
+    // Only one procedure can run at once, so the data length update is
+    // started once BLE_GAP_EVT_PHY_UPDATE reports the PHY update complete
+    if (status == NRF_SUCCESS)
+    {
+        ble_data_length_pending = true;
+        return;
+    }
+
+    NRFX_LOG("PHY update failed: 0x%x", status);
+
+    ble_link_data_length_update(connection);
+}
+
 void SD_EVT_IRQHandler(void)
 {
     uint32_t evt_id;
@@ -376,6 +835,19 @@ void SD_EVT_IRQHandler(void)
         case BLE_GAP_EVT_CONNECTED:
         {
             ble_handles.connection = ble_evt->evt.gap_evt.conn_handle;
+            ble_stats.connection_interval = ble_evt->evt.gap_evt.params
+                                                .connected.conn_params
+                                                .max_conn_interval;
+            ble_stats.slave_latency = ble_evt->evt.gap_evt.params
+                                          .connected.conn_params
+                                          .slave_latency;
+            ble_stats.supervision_timeout = ble_evt->evt.gap_evt.params
+                                                .connected.conn_params
+                                                .conn_sup_timeout;
+            ble_stats.tx_phy = BLE_GAP_PHY_1MBPS;
+            ble_stats.rx_phy = BLE_GAP_PHY_1MBPS;
+            ble_stats.max_tx_octets = BLE_DEFAULT_DATA_LENGTH;
+            ble_stats.max_rx_octets = BLE_DEFAULT_DATA_LENGTH;
 
             ble_gap_conn_params_t conn_params;
 
@@ -386,21 +858,33 @@ void SD_EVT_IRQHandler(void)
                                               NULL,
                                               0,
                                               0));
+
+            ble_link_tune(ble_handles.connection);
+            events_push(EVENT_BLE_CONNECTED);
             break;
         }
 
         case BLE_GAP_EVT_DISCONNECTED:
         {
             ble_handles.connection = BLE_CONN_HANDLE_INVALID;
+            ble_hvn_tx_queue_full = false;
+            ble_data_length_pending = false;
+#if MONOCLE_L2CAP
+            l2cap.cid = BLE_L2CAP_CID_INVALID;
+            l2cap.tx_pending = false;
+            l2cap.rx_buffer_held = false;
+#endif
             app_err(sd_ble_gap_adv_start(ble_handles.advertising, 1));
+            events_push(EVENT_BLE_DISCONNECTED);
             break;
         }
 
         case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
         {
+            // Let the softdevice pick 2M if the central supports it
             ble_gap_phys_t const phys = {
-                .rx_phys = BLE_GAP_PHY_1MBPS,
-                .tx_phys = BLE_GAP_PHY_1MBPS,
+                .rx_phys = BLE_GAP_PHY_AUTO,
+                .tx_phys = BLE_GAP_PHY_AUTO,
             };
             app_err(sd_ble_gap_phy_update(ble_evt->evt.gap_evt.conn_handle,
                                           &phys));
@@ -431,49 +915,32 @@ void SD_EVT_IRQHandler(void)
             if (ble_evt->evt.gatts_evt.params.write.handle ==
                 ble_handles.repl_rx_write.value_handle)
             {
-                for (uint16_t i = 0;
-                     i < ble_evt->evt.gatts_evt.params.write.len;
-                     i++)
-                {
-                    uint16_t next = repl_rx.head + 1;
-
-                    if (next == sizeof(repl_rx.buffer))
-                    {
-                        next = 0;
-                    }
-
-                    if (next == repl_rx.tail)
-                    {
-                        break;
-                    }
-
-                    // Catch keyboard interrupts
-                    if (ble_evt->evt.gatts_evt.params.write.data[i] ==
-                        mp_interrupt_char)
-                    {
-                        mp_sched_keyboard_interrupt();
-                    }
-
-                    // Otherwise add the character to the ring buffer
-                    else
-                    {
-                        repl_rx.buffer[repl_rx.head] =
-                            ble_evt->evt.gatts_evt.params.write.data[i];
-                    }
-
-                    repl_rx.head = next;
-                }
+                ble_stats.repl_bytes_received +=
+                    ble_evt->evt.gatts_evt.params.write.len;
+                repl_rx_push(ble_evt->evt.gatts_evt.params.write.data,
+                             ble_evt->evt.gatts_evt.params.write.len);
             }
 
             // If data service
             if (ble_evt->evt.gatts_evt.params.write.handle ==
                 ble_handles.data_rx_write.value_handle)
             {
+                ble_stats.data_bytes_received +=
+                    ble_evt->evt.gatts_evt.params.write.len;
                 bluetooth_receive_callback_handler(
                     ble_evt->evt.gatts_evt.params.write.data,
                     ble_evt->evt.gatts_evt.params.write.len);
             }
 
+            // If file transfer characteristic
+            if (ble_evt->evt.gatts_evt.params.write.handle ==
+                ble_handles.file_rx_write.value_handle)
+            {
+                filetransfer_receive_handler(
+                    ble_evt->evt.gatts_evt.params.write.data,
+                    ble_evt->evt.gatts_evt.params.write.len);
+            }
+
             break;
         }
 
@@ -496,9 +963,7 @@ void SD_EVT_IRQHandler(void)
 
         case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
         {
-            app_err(sd_ble_gap_data_length_update(ble_handles.connection,
-                                                  NULL,
-                                                  NULL));
+            ble_link_data_length_update(ble_handles.connection);
             break;
         }
 
@@ -513,12 +978,130 @@ void SD_EVT_IRQHandler(void)
             break;
         }
 
+        case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+        {
+            // Space is free in the queue, the poll hook resumes sending
+            ble_hvn_tx_completions++;
+            ble_hvn_tx_queue_full = false;
+            TRACE(TRACE_BLE_HVX_COMPLETE,
+                  ble_evt->evt.gatts_evt.params.hvn_tx_complete.count);
+            break;
+        }
+
+#if MONOCLE_L2CAP
+        case BLE_L2CAP_EVT_CH_SETUP_REQUEST:
+        {
+            ble_l2cap_ch_setup_params_t params = {0};
+            uint16_t cid = ble_evt->evt.l2cap_evt.local_cid;
+
+            params.rx_params.rx_mps = BLE_L2CAP_MPS;
+            params.rx_params.rx_mtu = BLE_L2CAP_SDU_SIZE;
+            params.status = BLE_L2CAP_CH_STATUS_CODE_SUCCESS;
+
+            // Refuse channels on anything other than the opened PSM
+            if (l2cap.psm == 0 ||
+                l2cap.cid != BLE_L2CAP_CID_INVALID ||
+                ble_evt->evt.l2cap_evt.params.ch_setup_request.le_psm !=
+                    l2cap.psm)
+            {
+                params.status = BLE_L2CAP_CH_STATUS_CODE_LE_PSM_NOT_SUPPORTED;
+            }
+
+            app_err(sd_ble_l2cap_ch_setup(ble_handles.connection,
+                                          &cid,
+                                          &params));
+            break;
+        }
+
+        case BLE_L2CAP_EVT_CH_SETUP:
+        {
+            l2cap.cid = ble_evt->evt.l2cap_evt.local_cid;
+            l2cap.tx_mtu = ble_evt->evt.l2cap_evt.params.ch_setup.tx_params
+                               .tx_mtu;
+            l2cap.tx_pending = false;
+            l2cap.rx_buffer_held = false;
+            ble_l2cap_give_rx_buffer();
+            break;
+        }
+
+        case BLE_L2CAP_EVT_CH_RELEASED:
+        {
+            l2cap.cid = BLE_L2CAP_CID_INVALID;
+            l2cap.tx_pending = false;
+            l2cap.rx_buffer_held = false;
+            break;
+        }
+
+        case BLE_L2CAP_EVT_CH_RX:
+        {
+            l2cap.rx_buffer_held = false;
+            ble_ring_push(&l2cap_rx,
+                          ble_evt->evt.l2cap_evt.params.rx.sdu_buf.p_data,
+                          ble_evt->evt.l2cap_evt.params.rx.sdu_len);
+            ble_l2cap_give_rx_buffer();
+            break;
+        }
+
+        case BLE_L2CAP_EVT_CH_TX:
+        {
+            l2cap.tx_pending = false;
+            break;
+        }
+
+        case BLE_L2CAP_EVT_CH_SETUP_REFUSED:
+        case BLE_L2CAP_EVT_CH_SDU_BUF_RELEASED:
+        case BLE_L2CAP_EVT_CH_CREDIT:
+        {
+            // Unused L2CAP events
+            break;
+        }
+#endif
+
         case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+        {
+            ble_stats.connection_interval = ble_evt->evt.gap_evt.params
+                                                .conn_param_update.conn_params
+                                                .max_conn_interval;
+            ble_stats.slave_latency = ble_evt->evt.gap_evt.params
+                                          .conn_param_update.conn_params
+                                          .slave_latency;
+            ble_stats.supervision_timeout = ble_evt->evt.gap_evt.params
+                                                .conn_param_update.conn_params
+                                                .conn_sup_timeout;
+            ble_stats.connection_param_updates++;
+            break;
+        }
+
         case BLE_GAP_EVT_PHY_UPDATE:
+        {
+            if (ble_evt->evt.gap_evt.params.phy_update.status ==
+                BLE_HCI_STATUS_CODE_SUCCESS)
+            {
+                ble_stats.tx_phy = ble_evt->evt.gap_evt.params.phy_update.tx_phy;
+                ble_stats.rx_phy = ble_evt->evt.gap_evt.params.phy_update.rx_phy;
+            }
+
+            if (ble_data_length_pending)
+            {
+                ble_link_data_length_update(ble_evt->evt.gap_evt.conn_handle);
+            }
+            break;
+        }
+
         case BLE_GAP_EVT_DATA_LENGTH_UPDATE:
-        case BLE_GATTS_EVT_HVN_TX_COMPLETE:
         {
-            // Unused events
+            ble_stats.max_tx_octets = ble_evt->evt.gap_evt.params
+                                          .data_length_update
+                                          .effective_params.max_tx_octets;
+            ble_stats.max_rx_octets = ble_evt->evt.gap_evt.params
+                                          .data_length_update
+                                          .effective_params.max_rx_octets;
+
+            // The central's own update may have kept ours from starting
+            if (ble_data_length_pending)
+            {
+                ble_link_data_length_update(ble_evt->evt.gap_evt.conn_handle);
+            }
             break;
         }
 
@@ -540,8 +1123,11 @@ int main(void)
     // Set up the PMIC and go to sleep if on charge
     monocle_critical_startup();
 
+    monocle_trace_init();
+
     // Start the FPGA
     monocle_fpga_reset(true);
+    monocle_boot_mark("fpga");
 
     // Setup the camera
     {
@@ -571,19 +1157,11 @@ int main(void)
         monocle_i2c_write(CAMERA_I2C_ADDRESS, 0x3008, 0xFF, 0x82);
         nrfx_systick_delay_ms(5);
 
-        // Send the default configuration
-        for (size_t i = 0;
-             i < sizeof(camera_config) / sizeof(camera_config_t);
-             i++)
-        {
-            monocle_i2c_write(CAMERA_I2C_ADDRESS,
-                              camera_config[i].address,
-                              0xFF,
-                              camera_config[i].value);
-        }
-
-        // Put the camera to sleep
-        nrf_gpio_pin_write(CAMERA_SLEEP_PIN, true);
+        // Send the default configuration, which carries on from the TWIM
+        // interrupt while the display is set up
+        monocle_i2c_write_table(CAMERA_I2C_ADDRESS,
+                                camera_config,
+                                sizeof(camera_config) / sizeof(camera_config_t));
     }
 
     // Enable, and setup the display
@@ -599,6 +1177,16 @@ int main(void)
                                   display_config[i].value};
             monocle_spi_write(DISPLAY, command, 2, false);
         }
+
+        monocle_boot_mark("display");
+    }
+
+    // Put the camera to sleep once configured
+    {
+        monocle_i2c_wait();
+        nrf_gpio_pin_write(CAMERA_SLEEP_PIN, true);
+
+        monocle_boot_mark("camera");
     }
 
     // Setup touch interrupt
@@ -614,6 +1202,15 @@ int main(void)
 
         nrfx_gpiote_in_event_enable(TOUCH_INTERRUPT_PIN,
                                     true);
+
+        NRFX_IRQ_PRIORITY_SET(TOUCH_BOTTOM_HALF_IRQn, 7);
+        NRFX_IRQ_ENABLE(TOUCH_BOTTOM_HALF_IRQn);
+
+        // The FPGA signals command completion on its reset line
+        monocle_fpga_irq_init();
+
+        // The PMIC signals charger and temperature events on its own line
+        monocle_pmic_irq_init();
     }
 
     // Setup battery ADC input
@@ -637,12 +1234,15 @@ int main(void)
         // 1024Hz = >1ms resolution
         config.prescaler = RTC_FREQ_TO_PRESCALER(1024);
 
-        app_err(nrfx_rtc_init(&rtc, &config, unused_rtc_event_handler));
+        app_err(nrfx_rtc_init(&rtc, &config, mp_hal_rtc_event_handler));
+
+        // Overflows extend the 24 bit counter, so ticks last beyond 4.5 hours
+        nrfx_rtc_overflow_enable(&rtc, true);
         nrfx_rtc_enable(&rtc);
 
-        // Wake up the softdevice every ms so that MICROPY_EVENT_POLL_HOOK
-        // doesn't block for longer than it's supposed to
-        nrfx_rtc_tick_enable(&rtc, true);
+        // Only the tick event, for the PPI capture used by mp_hal_time_ns().
+        // An interrupt every ms would keep waking the CPU while idle
+        nrfx_rtc_tick_enable(&rtc, false);
     }
 
     // Setup the Bluetooth
@@ -657,6 +1257,9 @@ int main(void)
         // Enable the softdevice
         app_err(sd_softdevice_enable(&clock_config, softdevice_assert_handler));
 
+        // The low frequency clock now runs the RTC, so time the boot with it
+        monocle_boot_rtc_started();
+
         // Enable softdevice interrupt
         app_err(sd_nvic_EnableIRQ((IRQn_Type)SD_EVT_IRQn));
 
@@ -664,7 +1267,7 @@ int main(void)
         ble_cfg_t cfg;
         cfg.conn_cfg.conn_cfg_tag = 1;
         cfg.conn_cfg.params.gap_conn_cfg.conn_count = 1;
-        cfg.conn_cfg.params.gap_conn_cfg.event_length = 3;
+        cfg.conn_cfg.params.gap_conn_cfg.event_length = BLE_GAP_EVENT_LENGTH;
         app_err(sd_ble_cfg_set(BLE_CONN_CFG_GAP, &cfg, ram_start));
 
         // Set BLE role to peripheral only
@@ -678,12 +1281,24 @@ int main(void)
         cfg.conn_cfg.params.gatt_conn_cfg.att_mtu = BLE_PREFERRED_MAX_MTU;
         app_err(sd_ble_cfg_set(BLE_CONN_CFG_GATT, &cfg, ram_start));
 
-        // Configure two queued transfers
+        // Configure several queued transfers per connection event
         memset(&cfg, 0, sizeof(cfg));
         cfg.conn_cfg.conn_cfg_tag = 1;
-        cfg.conn_cfg.params.gatts_conn_cfg.hvn_tx_queue_size = 2;
+        cfg.conn_cfg.params.gatts_conn_cfg.hvn_tx_queue_size = BLE_HVN_TX_QUEUE_SIZE;
         app_err(sd_ble_cfg_set(BLE_CONN_CFG_GATTS, &cfg, ram_start));
 
+#if MONOCLE_L2CAP
+        // One L2CAP channel with full sized link layer packets
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.conn_cfg.conn_cfg_tag = 1;
+        cfg.conn_cfg.params.l2cap_conn_cfg.rx_mps = BLE_L2CAP_MPS;
+        cfg.conn_cfg.params.l2cap_conn_cfg.tx_mps = BLE_L2CAP_MPS;
+        cfg.conn_cfg.params.l2cap_conn_cfg.rx_queue_size = 1;
+        cfg.conn_cfg.params.l2cap_conn_cfg.tx_queue_size = 1;
+        cfg.conn_cfg.params.l2cap_conn_cfg.ch_count = 1;
+        app_err(sd_ble_cfg_set(BLE_CONN_CFG_L2CAP, &cfg, ram_start));
+#endif
+
         // Configure number of custom UUIDs
         memset(&cfg, 0, sizeof(cfg));
         cfg.common_cfg.vs_uuid_cfg.vs_uuid_count = 2;
@@ -699,10 +1314,18 @@ int main(void)
         cfg.gatts_cfg.service_changed.service_changed = 0;
         app_err(sd_ble_cfg_set(BLE_GATTS_CFG_SERVICE_CHANGED, &cfg, ram_start));
 
-        // Start the Softdevice
+        // Start the Softdevice. It gives back the least RAM it needs, which
+        // sd_ram_end in monocle.ld must be at least
         app_err(sd_ble_enable(&ram_start));
 
-        NRFX_LOG("Softdevice using 0x%x bytes of RAM", ram_start - 0x20000000);
+        NRFX_LOG("Softdevice using 0x%x bytes of RAM, 0x%x reserved",
+                 ram_start - 0x20000000,
+                 (uint32_t)&_ram_start - 0x20000000);
+
+        // Extend connection events while there is still data to send
+        ble_opt_t opt = {0};
+        opt.common_opt.conn_evt_ext.enable = 1;
+        app_err(sd_ble_opt_set(BLE_COMMON_OPT_CONN_EVT_EXT, &opt));
 
         // Set security to open // TODO make this paired
         ble_gap_conn_sec_mode_t sec_mode;
@@ -818,6 +1441,20 @@ int main(void)
                                                 &tx_attr,
                                                 &ble_handles.data_tx_notification));
 
+        // File transfer uses its own pair of characteristics on the data service
+        rx_uuid.uuid = 0x0004;
+        tx_uuid.uuid = 0x0005;
+
+        app_err(sd_ble_gatts_characteristic_add(data_service_handle,
+                                                &rx_char_md,
+                                                &rx_attr,
+                                                &ble_handles.file_rx_write));
+
+        app_err(sd_ble_gatts_characteristic_add(data_service_handle,
+                                                &tx_char_md,
+                                                &tx_attr,
+                                                &ble_handles.file_tx_notification));
+
         // Add name to advertising payload
         adv.payload[adv.length++] = strlen((const char *)device_name) + 1;
         adv.payload[adv.length++] = BLE_GAP_AD_TYPE_COMPLETE_LOCAL_NAME;
@@ -862,8 +1499,13 @@ int main(void)
 
         // Start advertising
         app_err(sd_ble_gap_adv_start(ble_handles.advertising, 1));
+
+        monocle_boot_mark("bluetooth");
     }
 
+    // Sample the battery in the background, now that PPI is available
+    battery_start();
+
     // Initialise the stack pointer for the main thread
     mp_stack_set_top(&_stack_top);
 
@@ -874,12 +1516,21 @@ int main(void)
     gc_init(&_heap_start, &_heap_end);
     mp_init();
     readline_init0();
+    monocle_boot_mark("micropython");
 
     // Mount the filesystem, or format if needed
     pyexec_frozen_module("_mountfs.py");
+    monocle_boot_mark("filesystem");
 
-    // Run the user's main file if it exists
-    pyexec_file_if_exists("main.py");
+    // Refresh the compiled copies of the user's files and extend the path
+    pyexec_frozen_module("_mpycache.py");
+    monocle_boot_mark("main.py");
+
+    // Run the user's main file if it exists, from its compiled copy if any
+    if (!mpycache_exec_main())
+    {
+        pyexec_file_if_exists("main.py");
+    }
 
     // Stay in the friendly or raw REPL until a reset is called
     for (;;)
@@ -900,7 +1551,8 @@ int main(void)
         }
     }
 
-    // On exit, clean up and reset
+    // On exit, write back any cached filesystem data, clean up and reset
+    storage_flush_all();
     gc_sweep_all();
     mp_deinit();
     sd_softdevice_disable();
@@ -909,6 +1561,11 @@ int main(void)
 
 void mp_event_poll_hook(void)
 {
+    // Only the caller may sleep until its deadline. Loops run by scheduled
+    // callbacks below set their own
+    uint64_t wakeup_ticks = mp_hal_wakeup_ticks;
+    mp_hal_wakeup_ticks = 0;
+
     // Keep sending REPL data. Then if no more data is pending
     if (ble_send_repl_data())
     {
@@ -920,13 +1577,17 @@ void mp_event_poll_hook(void)
         (void)__get_FPSCR();
         NVIC_ClearPendingIRQ(FPU_IRQn);
 
-        app_err(sd_app_evt_wait());
+        // Find blank flash sectors so filesystem erases can skip them
+        monocle_flash_scan_step();
+
+        mp_hal_wait_for_event(wakeup_ticks);
     }
 }
 
 void gc_collect(void)
 {
     // start the GC
+    TRACE(TRACE_GC_START, 0);
     gc_collect_start();
 
     // Get stack pointer
@@ -940,6 +1601,7 @@ void gc_collect(void)
 
     // end the GC
     gc_collect_end();
+    TRACE(TRACE_GC_END, 0);
 }
 
 void nlr_jump_fail(void *val)
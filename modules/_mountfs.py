@@ -1,13 +1,215 @@
 import os, device
 
-bdev = device.Storage()
+# Cache the two blocks of the root directory metadata pair
+bdev = device.Storage(cache=2)
 
-try:
-    os.mount(bdev, '/')
-except OSError:
+class _Lfs(os.VfsLfs2):
+    # _mpycache.py only refreshes /.mpy at boot, so drop the compiled copy of
+    # any .py changed since, whether from the REPL or a file transfer, and
+    # let imports find the source until the next boot
+    def _invalidate(self, path):
+        name = path.rsplit('/', 1)[-1]
+        if name.endswith('.py'):
+            try:
+                super().remove('/.mpy/' + name[:-3] + '.mpy')
+            except OSError:
+                pass
+
+    def open(self, path, mode):
+        if 'w' in mode or 'a' in mode or '+' in mode or 'x' in mode:
+            self._invalidate(path)
+        return super().open(path, mode)
+
+    def remove(self, path):
+        self._invalidate(path)
+        super().remove(path)
+
+    def rename(self, old, new):
+        self._invalidate(old)
+        self._invalidate(new)
+        super().rename(old, new)
+
+def _read_tree(path, files):
+    for entry in os.ilistdir(path):
+        name = path + entry[0]
+        if entry[1] == 0x4000:
+            # The bytecode cache is rebuilt from the sources anyway
+            if name != '/.mpy':
+                files.append((name, None))
+                _read_tree(name + '/', files)
+        elif name != '/.migrate':
+            with open(name, 'rb') as f:
+                files.append((name, f.read()))
+
+def _stage(stage, files):
+    # Records of the name length, the data length or 0xFFFFFFFF for a
+    # directory, the name and the data, from the block after the header
+    buf = bytearray()
+    block = 1
+    length = 0
+    for name, data in files:
+        name = name.encode()
+        size = 0xFFFFFFFF if data is None else len(data)
+        head = len(name).to_bytes(2, 'little') + size.to_bytes(4, 'little')
+        for part in (head, name, data or b''):
+            i = 0
+            while i < len(part):
+                n = min(len(part) - i, 0x1000 - len(buf))
+                buf.extend(part[i:i + n])
+                i += n
+                if len(buf) == 0x1000:
+                    stage.writeblocks(block, buf)
+                    block += 1
+                    buf = bytearray()
+        length += len(head) + len(name) + len(data or b'')
+    if buf:
+        stage.writeblocks(block, buf)
+
+    # The header goes last, so only a complete copy is ever replayed
+    stage.writeblocks(0, bytearray(b'MIGRATE1' + length.to_bytes(4, 'little')))
+
+def _staged_length(stage):
+    buf = bytearray(12)
+    stage.readblocks(0, buf)
+    if buf[0:8] != b'MIGRATE1':
+        return None
+    return int.from_bytes(buf[8:12], 'little')
+
+def _replay(stage, length):
+    # This starts over from the formatting, so a reset at any point only
+    # repeats it on the next boot. The copy is dropped once it's all back
     os.VfsLfs2.mkfs(bdev)
-    os.mount(bdev, '/')
+    os.mount(_Lfs(bdev), '/')
+    offset = 0x1000
+    while offset < 0x1000 + length:
+        head = bytearray(6)
+        stage.readblocks(0, head, offset)
+        name = bytearray(int.from_bytes(head[0:2], 'little'))
+        stage.readblocks(0, name, offset + 6)
+        size = int.from_bytes(head[2:6], 'little')
+        offset += 6 + len(name)
+        if size == 0xFFFFFFFF:
+            os.mkdir(str(name, 'utf-8'))
+            continue
+        with open(str(name, 'utf-8'), 'wb') as f:
+            while size:
+                chunk = bytearray(min(size, 256))
+                stage.readblocks(0, chunk, offset)
+                f.write(chunk)
+                offset += len(chunk)
+                size -= len(chunk)
+    bdev.ioctl(3, 0)
+    stage.ioctl(6, 0)
+
+def _migrate(legacy, stage):
+    # The update slot is outside the new filesystem but still inside the
+    # legacy one, so everything is read before anything is copied there.
+    # update.migrate_filesystem() checked that the files fit in RAM
+    files = []
+    try:
+        _read_tree('/', files)
+        length = sum(6 + len(name.encode()) + len(data or b'')
+                     for name, data in files)
+        if length > stage.ioctl(4, 0) * 0x1000 - 0x1000:
+            raise OSError("the files don't fit in the update slot")
+    except (OSError, MemoryError) as e:
+        # Stay on the legacy layout, and tell why instead of trying again
+        files = None
+        os.remove('/.migrate')
+        with open('/.migrate_failed', 'w') as f:
+            f.write(repr(e))
+        bdev.ioctl(2, 0)
+        return
+    os.umount('/')
+    legacy.ioctl(2, 0)
+    _stage(stage, files)
+    files = None
+    _replay(stage, length)
+
+def _block_count():
+    # Both blocks of the superblock pair start with the revision, the name tag
+    # and "littlefs", then the struct tag, version, block size and block count
+    probe = device.Storage()
+    buf = bytearray(32)
+    revision = None
+    count = None
+    for block in (0, 1):
+        probe.readblocks(block, buf)
+        if (buf[8:16] != b'littlefs' or
+                int.from_bytes(buf[24:28], 'little') != 0x1000):
+            continue
+        r = int.from_bytes(buf[0:4], 'little')
+        if revision is None or (r - revision) & 0xFFFFFFFF < 0x80000000:
+            revision = r
+            count = int.from_bytes(buf[28:32], 'little')
+    return count
+
+# Filesystems formatted before the update slot or the asset store were
+# reserved also cover them, and are kept until migrated or formatted. The
+# size is taken from the superblock, as older littlefs mount any block count
+blocks = _block_count()
+legacy = None
+
+# A migration copied out of the legacy filesystem is written back first
+stage = device.Storage(start=0x9D000, length=0x53000)
+staged = _staged_length(stage)
+
+if staged is None and blocks in (0x83, 0x93):
+    legacy = device.Storage(length=blocks * 0x1000, cache=2)
+    try:
+        os.mount(_Lfs(legacy), '/')
+    except OSError:
+        legacy.ioctl(2, 0)
+        legacy = None
+
+try:
+    if staged is not None:
+        _replay(stage, staged)
+    elif legacy is not None:
+        try:
+            os.stat('/.migrate')
+        except OSError:
+            bdev.ioctl(2, 0)
+        else:
+            _migrate(legacy, stage)
+    else:
+        try:
+            if blocks != bdev.ioctl(4, 0):
+                raise OSError
+            os.mount(_Lfs(bdev), '/')
+        except OSError:
+            os.VfsLfs2.mkfs(bdev)
+            os.mount(_Lfs(bdev), '/')
+except Exception as e:
+    # Still boot to a filesystem, the legacy one while nothing was copied
+    # out of it yet. A staged copy is kept and replayed on the next boot
+    print("Filesystem migration failed:", repr(e))
+    try:
+        os.umount('/')
+    except OSError:
+        pass
+    try:
+        if legacy is None or _staged_length(stage) is not None:
+            raise OSError
+        os.mount(_Lfs(legacy), '/')
+    except OSError:
+        try:
+            os.mount(_Lfs(bdev), '/')
+        except OSError:
+            os.VfsLfs2.mkfs(bdev)
+            os.mount(_Lfs(bdev), '/')
 
+del(_Lfs)
+del(_read_tree)
+del(_block_count)
+del(_migrate)
+del(_stage)
+del(_staged_length)
+del(_replay)
 del(os)
 del(device)
-del(bdev)
\ No newline at end of file
+del(bdev)
+del(legacy)
+del(stage)
+del(staged)
+del(blocks)
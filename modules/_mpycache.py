@@ -0,0 +1,64 @@
+import os, sys, binascii, __mpycache
+
+# Compiled copies of the .py files in / are kept in /.mpy, and refreshed
+# whenever the crc32 of their source differs from the one saved with them
+def __refresh(cache):
+    def crc_of(path):
+        crc = 0
+        buffer = bytearray(256)
+        with open(path, 'rb') as f:
+            while True:
+                n = f.readinto(buffer)
+                if not n:
+                    return crc
+                crc = binascii.crc32(buffer[:n], crc)
+
+    def cached_crc_of(path):
+        try:
+            with open(path, 'rb') as f:
+                f.seek(-8, 2)
+                footer = f.read(8)
+        except OSError:
+            return None
+        if footer[4:] != b'MPYC':
+            return None
+        return int.from_bytes(footer[:4], 'little')
+
+    try:
+        os.mkdir(cache)
+    except OSError:
+        pass
+
+    compiled = []
+
+    for entry in os.ilistdir('/'):
+        name = entry[0]
+        if entry[1] != 0x8000 or not name.endswith('.py'):
+            continue
+        compiled.append(name[:-3] + '.mpy')
+        path = cache + '/' + compiled[-1]
+        crc = crc_of(name)
+        if cached_crc_of(path) == crc:
+            continue
+        try:
+            __mpycache.compile(name, path, crc)
+        except Exception:
+            # Importing the source reports the error, so keep no stale copy
+            try:
+                os.remove(path)
+            except OSError:
+                pass
+
+    for entry in list(os.ilistdir(cache)):
+        if entry[0] not in compiled:
+            os.remove(cache + '/' + entry[0])
+
+    sys.path.insert(0, cache)
+
+__refresh('/.mpy')
+
+del(__refresh)
+del(os)
+del(sys)
+del(binascii)
+del(__mpycache)
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "awaitable.h"
+#include "py/mperrno.h"
+#include "py/runtime.h"
+#include "py/stream.h"
+
+STATIC mp_obj_t awaitable_iternext(mp_obj_t self_in)
+{
+    const awaitable_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (self->ready())
+    {
+        return mp_make_stop_iteration(self->result());
+    }
+
+    // Same as the uasyncio streams: queue for reading, then yield to the loop
+    mp_obj_t uasyncio = mp_import_name(MP_QSTR_uasyncio,
+                                       mp_const_none,
+                                       MP_OBJ_NEW_SMALL_INT(0));
+    mp_obj_t core = mp_load_attr(uasyncio, MP_QSTR_core);
+    mp_obj_t io_queue = mp_load_attr(core, MP_QSTR__io_queue);
+    mp_call_function_1(mp_load_attr(io_queue, MP_QSTR_queue_read), self_in);
+
+    return mp_const_none;
+}
+
+STATIC mp_uint_t awaitable_ioctl(mp_obj_t self_in, mp_uint_t request,
+                                 uintptr_t arg, int *errcode)
+{
+    const awaitable_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Driver interrupts wake sd_app_evt_wait(), so the poller sees it at once
+    if (request == MP_STREAM_POLL)
+    {
+        return (arg & MP_STREAM_POLL_RD) && self->ready() ? MP_STREAM_POLL_RD : 0;
+    }
+
+    *errcode = MP_EINVAL;
+    return MP_STREAM_ERROR;
+}
+
+STATIC const mp_stream_p_t awaitable_stream_p = {
+    .ioctl = awaitable_ioctl,
+};
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    awaitable_type,
+    MP_QSTR_awaitable,
+    MP_TYPE_FLAG_ITER_IS_ITERNEXT,
+    iter, awaitable_iternext,
+    protocol, &awaitable_stream_p);
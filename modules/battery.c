@@ -0,0 +1,212 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <math.h>
+#include "battery.h"
+#include "events.h"
+#include "monocle.h"
+#include "py/runtime.h"
+#include "nrf_soc.h"
+#include "nrfx_saadc.h"
+
+// mphalport.c uses PPI channel 0 for time_ns()
+#define BATTERY_PPI_CHANNEL (1)
+
+// The IIR filter takes a quarter of each new sample, in 1/16 of an LSB
+#define BATTERY_FILTER_SHIFT (2)
+#define BATTERY_FILTER_SCALE (16)
+
+// Smaller changes don't call the voltage callback
+#define BATTERY_CALLBACK_MV (20)
+
+MP_REGISTER_ROOT_POINTER(mp_obj_t battery_voltage_callback);
+MP_REGISTER_ROOT_POINTER(mp_obj_t battery_charging_callback);
+
+static nrf_saadc_value_t battery_buffers[2];
+static uint8_t battery_next_buffer = 0;
+
+static volatile bool battery_sampled = false;
+static uint32_t battery_filtered = 0;
+static volatile uint32_t battery_mv = 0;
+static volatile uint8_t battery_percentage = 0;
+static uint32_t battery_reported_mv = 0;
+
+static bool battery_charging = false;
+static bool battery_charging_known = false;
+
+static void battery_schedule(mp_obj_t callback, mp_obj_t arg)
+{
+    if (callback == MP_OBJ_NULL || callback == mp_const_none)
+    {
+        return;
+    }
+
+    if (!mp_sched_schedule(callback, arg))
+    {
+        events_callback_lost();
+    }
+}
+
+static void battery_sample(nrf_saadc_value_t raw)
+{
+    if (raw < 0)
+    {
+        raw = 0;
+    }
+
+    // The first sample starts the filter where the battery is
+    uint32_t sample = (uint32_t)raw * BATTERY_FILTER_SCALE;
+
+    if (!battery_sampled)
+    {
+        battery_filtered = sample;
+    }
+    else
+    {
+        battery_filtered = battery_filtered - (battery_filtered >> BATTERY_FILTER_SHIFT) +
+                           (sample >> BATTERY_FILTER_SHIFT);
+    }
+
+    // V = (raw / 12bits) * Vref * (1/NRFgain) * AMUXgain
+    float voltage = ((float)battery_filtered / (4096.0f * BATTERY_FILTER_SCALE)) *
+                    0.6f * 2.0f * (4.5f / 1.25f);
+
+    // Percentage is based on a polynomial. Details in tools/battery-model
+    float percentage = roundf(((-118.13699f * voltage + 1249.63556f) * voltage -
+                               4276.33059f) *
+                                  voltage +
+                              4764.47488f);
+
+    if (percentage < 0.0f)
+    {
+        percentage = 0.0f;
+    }
+
+    if (percentage > 100.0f)
+    {
+        percentage = 100.0f;
+    }
+
+    battery_percentage = (uint8_t)percentage;
+    battery_mv = (uint32_t)(voltage * 1000.0f);
+    battery_sampled = true;
+
+    uint32_t change = battery_mv > battery_reported_mv
+                          ? battery_mv - battery_reported_mv
+                          : battery_reported_mv - battery_mv;
+
+    if (change >= BATTERY_CALLBACK_MV)
+    {
+        battery_reported_mv = battery_mv;
+        battery_schedule(MP_STATE_PORT(battery_voltage_callback),
+                         MP_OBJ_NEW_SMALL_INT(battery_mv));
+    }
+}
+
+static void battery_saadc_handler(nrfx_saadc_evt_t const *event)
+{
+    switch (event->type)
+    {
+    case NRFX_SAADC_EVT_READY:
+        // Take the first sample now, rather than at the next charge check
+        if (!battery_sampled)
+        {
+            NRF_SAADC->TASKS_SAMPLE = 1;
+        }
+        break;
+
+    case NRFX_SAADC_EVT_BUF_REQ:
+        app_err(nrfx_saadc_buffer_set(&battery_buffers[battery_next_buffer], 1));
+        battery_next_buffer ^= 1;
+        break;
+
+    case NRFX_SAADC_EVT_DONE:
+        battery_sample(event->data.done.p_buffer[0]);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void battery_start(void)
+{
+    // Each sample is the average of a burst of 16 conversions
+    nrfx_saadc_adv_config_t config = NRFX_SAADC_DEFAULT_ADV_CONFIG;
+    config.oversampling = NRF_SAADC_OVERSAMPLE_16X;
+    config.burst = NRF_SAADC_BURST_ENABLED;
+    config.start_on_end = true;
+
+    app_err(nrfx_saadc_advanced_mode_set(1,
+                                         NRF_SAADC_RESOLUTION_12BIT,
+                                         &config,
+                                         battery_saadc_handler));
+
+    app_err(nrfx_saadc_buffer_set(&battery_buffers[0], 1));
+    battery_next_buffer = 1;
+
+    app_err(nrfx_saadc_mode_trigger());
+
+    // The charge check runs twice a second, which is plenty for a battery
+    app_err(sd_ppi_channel_assign(BATTERY_PPI_CHANNEL,
+                                  &NRF_TIMER4->EVENTS_COMPARE[0],
+                                  &NRF_SAADC->TASKS_SAMPLE));
+    app_err(sd_ppi_channel_enable_set(1 << BATTERY_PPI_CHANNEL));
+}
+
+uint32_t battery_millivolts(void)
+{
+    // Only until the first sample is in, shortly after boot
+    while (!battery_sampled)
+    {
+        MICROPY_EVENT_POLL_HOOK;
+    }
+
+    return battery_mv;
+}
+
+uint8_t battery_level(void)
+{
+    battery_millivolts();
+
+    return battery_percentage;
+}
+
+void battery_charging_update(bool charging)
+{
+    if (battery_charging_known && charging == battery_charging)
+    {
+        return;
+    }
+
+    bool first = !battery_charging_known;
+    battery_charging = charging;
+    battery_charging_known = true;
+
+    if (!first)
+    {
+        battery_schedule(MP_STATE_PORT(battery_charging_callback),
+                         mp_obj_new_bool(charging));
+    }
+}
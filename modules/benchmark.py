@@ -0,0 +1,109 @@
+#
+# This file is part of the MicroPython for Monocle project:
+#      https://github.com/brilliantlabsAR/monocle-micropython
+#
+# Authored by: Josuah Demangeon (me@josuah.net)
+#              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+#
+# ISC Licence
+#
+# Copyright © 2023 Brilliant Labs Ltd.
+#
+# Permission to use, copy, modify, and/or distribute this software for any
+# purpose with or without fee is hereby granted, provided that the above
+# copyright notice and this permission notice appear in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+# REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+# AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+# INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+# LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+# OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+# PERFORMANCE OF THIS SOFTWARE.
+#
+
+import bluetooth
+import device
+import display
+import os
+import time
+
+def __rate(count, us):
+    return count * 1000000 // max(us, 1)
+
+def link():
+    stats = bluetooth.stats()
+    keys = ('mtu', 'tx_phy', 'rx_phy', 'connection_interval_us',
+            'slave_latency', 'supervision_timeout_ms')
+    return {key: stats[key] for key in keys}
+
+def send(total=32768):
+    chunk = bytes(bluetooth.max_length())
+    sent = 0
+    start = time.ticks_us()
+    while sent < total:
+        try:
+            bluetooth.send(chunk)
+            sent += len(chunk)
+        except OSError:
+            pass
+    us = time.ticks_diff(time.ticks_us(), start)
+    return {'bytes': sent, 'us': us, 'bytes_per_s': __rate(sent, us)}
+
+def receive(total=32768, timeout_ms=30000):
+    buffer = bytearray(256)
+    received = 0
+    start = None
+    deadline = time.ticks_add(time.ticks_ms(), timeout_ms)
+    while received < total and time.ticks_diff(deadline, time.ticks_ms()) > 0:
+        count = bluetooth.read_into(buffer)
+        if count and start is None:
+            start = time.ticks_us()
+        received += count
+    us = time.ticks_diff(time.ticks_us(), start) if start is not None else 0
+    return {'bytes': received, 'us': us, 'bytes_per_s': __rate(received, us)}
+
+def __scene_clear():
+    display.fill(0x000000)
+
+def __scene_text():
+    for row in range(0, 400, 50):
+        display.text('Monocle benchmark %d' % row, 20, row, 0xFFFFFF)
+
+def __scene_shapes():
+    for i in range(8):
+        display.rect(i * 80, 0, 60, 60, 0xFF0000)
+        display.line(i * 80, 100, 640 - i * 80, 400, 0x00FF00)
+
+__SCENES = {'clear': __scene_clear, 'text': __scene_text, 'shapes': __scene_shapes}
+
+def show(frames=30):
+    results = {}
+    for name, scene in __SCENES.items():
+        start = time.ticks_us()
+        for _ in range(frames):
+            scene()
+            display.show()
+        results[name] = __rate(frames, time.ticks_diff(time.ticks_us(), start))
+    display.show()
+    return results
+
+def flash(length=65536, path='/.benchmark'):
+    storage = device.Storage()
+    block = bytearray(4096)
+    start = time.ticks_us()
+    for offset in range(0, length, len(block)):
+        storage.readblocks(offset // len(block), block)
+    read_us = time.ticks_diff(time.ticks_us(), start)
+
+    # Writes go through the filesystem, so as not to clobber it. Any block
+    # cache only holds a little of the length
+    start = time.ticks_us()
+    with open(path, 'wb') as f:
+        for _ in range(0, length, len(block)):
+            f.write(block)
+    write_us = time.ticks_diff(time.ticks_us(), start)
+    os.remove(path)
+
+    return {'read_bytes_per_s': __rate(length, read_us),
+            'write_bytes_per_s': __rate(length, write_us)}
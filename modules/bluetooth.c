@@ -22,23 +22,131 @@
  * PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <string.h>
+#include "awaitable.h"
+#include "bluetooth.h"
+#include "events.h"
 #include "mphalport.h"
 #include "py/runtime.h"
 #include "py/objarray.h"
 
 static mp_obj_t receive_callback = mp_const_none;
 
+// Callback is given the byte count once this many bytes are buffered
+static size_t receive_threshold = 0;
+static volatile bool receive_threshold_pending = false;
+
+#ifndef BLUETOOTH_DATA_RX_BUFFER_SIZE
+#define BLUETOOTH_DATA_RX_BUFFER_SIZE 2048
+#endif
+
+static struct data_rx_ring_t
+{
+    uint8_t buffer[BLUETOOTH_DATA_RX_BUFFER_SIZE];
+    volatile size_t head;
+    volatile size_t tail;
+} data_rx = {
+    .head = 0,
+    .tail = 0,
+};
+
+// Bytes which didn't fit in the ring, and the most it has held
+static size_t data_rx_dropped = 0;
+static size_t data_rx_high_water = 0;
+
+static size_t data_rx_available(void)
+{
+    size_t head = data_rx.head;
+    size_t tail = data_rx.tail;
+
+    return head >= tail ? head - tail : sizeof(data_rx.buffer) - tail + head;
+}
+
+static void data_rx_push(const uint8_t *bytes, size_t len)
+{
+    // One slot is kept empty to tell a full ring from an empty one
+    size_t space = sizeof(data_rx.buffer) - 1 - data_rx_available();
+    size_t head = data_rx.head;
+
+    // Bytes which don't fit are dropped
+    data_rx_dropped += len > space ? len - space : 0;
+    len = MIN(len, space);
+
+    size_t first = MIN(len, sizeof(data_rx.buffer) - head);
+    memcpy(&data_rx.buffer[head], bytes, first);
+    memcpy(&data_rx.buffer[0], &bytes[first], len - first);
+
+    head += len;
+    if (head >= sizeof(data_rx.buffer))
+    {
+        head -= sizeof(data_rx.buffer);
+    }
+    data_rx.head = head;
+}
+
+static size_t data_rx_pop(uint8_t *buf, size_t len)
+{
+    size_t tail = data_rx.tail;
+    len = MIN(len, data_rx_available());
+
+    size_t first = MIN(len, sizeof(data_rx.buffer) - tail);
+    memcpy(buf, &data_rx.buffer[tail], first);
+    memcpy(&buf[first], &data_rx.buffer[0], len - first);
+
+    tail += len;
+    if (tail >= sizeof(data_rx.buffer))
+    {
+        tail -= sizeof(data_rx.buffer);
+    }
+    data_rx.tail = tail;
+
+    // Allow the threshold callback to fire again
+    receive_threshold_pending = false;
+
+    return len;
+}
+
 void bluetooth_receive_callback_handler(const uint8_t *bytes, size_t len)
 {
-    if (receive_callback != mp_const_none)
+    events_push(EVENT_BLE_DATA);
+
+    // Without a threshold, callbacks are given each write as a bytes object
+    if (receive_callback != mp_const_none && receive_threshold == 0)
     {
         mp_obj_t array = mp_obj_new_bytes(bytes, len);
-        mp_sched_schedule(receive_callback, array);
+        if (!mp_sched_schedule(receive_callback, array))
+        {
+            events_callback_lost();
+        }
+        return;
+    }
+
+    data_rx_push(bytes, len);
+
+    size_t available = data_rx_available();
+
+    if (available > data_rx_high_water)
+    {
+        data_rx_high_water = available;
+    }
+
+    if (receive_callback != mp_const_none &&
+        !receive_threshold_pending &&
+        available >= receive_threshold)
+    {
+        // Small integers don't allocate on the heap
+        receive_threshold_pending =
+            mp_sched_schedule(receive_callback, MP_OBJ_NEW_SMALL_INT(available));
     }
 }
 
 static mp_obj_t bluetooth_send(mp_obj_t buffer_in)
 {
+    if (!ble_is_connected())
+    {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("not connected"));
+    }
+
     if (!ble_are_tx_notifications_enabled(DATA_TX))
     {
         mp_raise_msg(&mp_type_OSError,
@@ -65,6 +173,63 @@ static mp_obj_t bluetooth_send(mp_obj_t buffer_in)
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(bluetooth_send_obj, bluetooth_send);
 
+static mp_obj_t bluetooth_send_stream(mp_obj_t buffer_in)
+{
+    mp_buffer_info_t array;
+    mp_get_buffer_raise(buffer_in, &array, MP_BUFFER_READ);
+
+    size_t max_payload = ble_get_max_payload_size();
+    if (max_payload < 2)
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("MTU is too small for streaming"));
+    }
+
+    // The softdevice copies every notification, so assemble each on the stack.
+    // Only the low bits of the count go in the headers
+    uint8_t fragment[max_payload];
+    const uint8_t *data = array.buf;
+    size_t sent = 0;
+    size_t sequence = 0;
+
+    do
+    {
+        size_t len = MIN(array.len - sent, max_payload - 1);
+
+        fragment[0] = sequence++ & STREAM_HEADER_SEQUENCE;
+        if (sent + len == array.len)
+        {
+            fragment[0] |= STREAM_HEADER_LAST;
+        }
+        memcpy(&fragment[1], &data[sent], len);
+
+        // Block while the notification queue is full, servicing events
+        while (ble_send_raw_data(fragment, len + 1))
+        {
+            // The CCCD can't be read once the connection is gone
+            if (!ble_is_connected())
+            {
+                mp_raise_msg(&mp_type_OSError,
+                             MP_ERROR_TEXT("disconnected during the stream"));
+            }
+
+            if (!ble_are_tx_notifications_enabled(DATA_TX))
+            {
+                mp_raise_msg(&mp_type_OSError,
+                             MP_ERROR_TEXT(
+                                 "notifications are not enabled on the data service"));
+            }
+
+            MICROPY_EVENT_POLL_HOOK;
+        }
+
+        sent += len;
+    } while (sent < array.len);
+
+    return mp_obj_new_int_from_uint(sequence);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bluetooth_send_stream_obj, bluetooth_send_stream);
+
 static mp_obj_t bluetooth_receive_callback(size_t n_args, const mp_obj_t *args)
 {
     if (n_args == 0)
@@ -78,15 +243,74 @@ static mp_obj_t bluetooth_receive_callback(size_t n_args, const mp_obj_t *args)
             MP_ERROR_TEXT("callback must be None or a callable object"));
     }
 
+    size_t threshold = 0;
+
+    if (n_args == 2)
+    {
+        mp_int_t value = mp_obj_get_int(args[1]);
+
+        if (value < 1 || value >= BLUETOOTH_DATA_RX_BUFFER_SIZE)
+        {
+            mp_raise_ValueError(
+                MP_ERROR_TEXT("threshold must be within the buffer size"));
+        }
+
+        threshold = value;
+    }
+
     receive_callback = args[0];
+    receive_threshold = threshold;
+    receive_threshold_pending = false;
 
     return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bluetooth_receive_callback_obj, 0, 1, bluetooth_receive_callback);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bluetooth_receive_callback_obj, 0, 2, bluetooth_receive_callback);
+
+static mp_obj_t bluetooth_read_into(mp_obj_t buffer_in)
+{
+    mp_buffer_info_t array;
+    mp_get_buffer_raise(buffer_in, &array, MP_BUFFER_WRITE);
+
+    return mp_obj_new_int(data_rx_pop(array.buf, array.len));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bluetooth_read_into_obj, bluetooth_read_into);
+
+static bool bluetooth_recv_ready(void)
+{
+    return data_rx_available() > 0;
+}
+
+static mp_obj_t bluetooth_recv_result(void)
+{
+    vstr_t vstr;
+    vstr_init_len(&vstr, data_rx_available());
+    vstr.len = data_rx_pop((uint8_t *)vstr.buf, vstr.len);
+
+    return mp_obj_new_bytes_from_vstr(&vstr);
+}
+
+STATIC const awaitable_obj_t bluetooth_recv_awaitable = {
+    {&awaitable_type},
+    bluetooth_recv_ready,
+    bluetooth_recv_result,
+};
+
+// Awaits buffered data, so it needs a threshold callback or none at all
+static mp_obj_t bluetooth_recv(void)
+{
+    return MP_OBJ_FROM_PTR(&bluetooth_recv_awaitable);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bluetooth_recv_obj, bluetooth_recv);
+
+static mp_obj_t bluetooth_any(void)
+{
+    return mp_obj_new_int(data_rx_available());
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bluetooth_any_obj, bluetooth_any);
 
 static mp_obj_t bluetooth_connected(void)
 {
-    return ble_are_tx_notifications_enabled(DATA_TX)
+    return ble_is_connected() && ble_are_tx_notifications_enabled(DATA_TX)
                ? mp_const_true
                : mp_const_false;
 }
@@ -98,11 +322,211 @@ STATIC mp_obj_t bluetooth_max_length(void)
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(bluetooth_max_length_obj, bluetooth_max_length);
 
+#if MONOCLE_L2CAP
+
+STATIC mp_obj_t bluetooth_l2cap_open(size_t n_args, const mp_obj_t *args)
+{
+    // LE dynamic PSMs are within 0x80 to 0xFF
+    mp_int_t psm = n_args == 0 ? 0x80 : mp_obj_get_int(args[0]);
+
+    if (psm < 0x80 || psm > 0xFF)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("psm must be between 0x80 and 0xFF"));
+    }
+
+    ble_l2cap_listen(psm);
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bluetooth_l2cap_open_obj, 0, 1, bluetooth_l2cap_open);
+
+STATIC mp_obj_t bluetooth_l2cap_close(void)
+{
+    ble_l2cap_close();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bluetooth_l2cap_close_obj, bluetooth_l2cap_close);
+
+STATIC mp_obj_t bluetooth_l2cap_connected(void)
+{
+    return ble_l2cap_is_connected() ? mp_const_true : mp_const_false;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bluetooth_l2cap_connected_obj, bluetooth_l2cap_connected);
+
+STATIC mp_obj_t bluetooth_l2cap_send(mp_obj_t buffer_in)
+{
+    mp_buffer_info_t array;
+    mp_get_buffer_raise(buffer_in, &array, MP_BUFFER_READ);
+
+    if (ble_l2cap_send(array.buf, array.len))
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("L2CAP channel is not connected"));
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bluetooth_l2cap_send_obj, bluetooth_l2cap_send);
+
+STATIC mp_obj_t bluetooth_l2cap_read_into(mp_obj_t buffer_in)
+{
+    mp_buffer_info_t array;
+    mp_get_buffer_raise(buffer_in, &array, MP_BUFFER_WRITE);
+
+    return mp_obj_new_int(ble_l2cap_read(array.buf, array.len));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bluetooth_l2cap_read_into_obj, bluetooth_l2cap_read_into);
+
+STATIC mp_obj_t bluetooth_l2cap_any(void)
+{
+    return mp_obj_new_int(ble_l2cap_available());
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bluetooth_l2cap_any_obj, bluetooth_l2cap_any);
+
+#endif
+
+static const struct connection_profile_t
+{
+    qstr name;
+    uint32_t min_interval_us;
+    uint32_t max_interval_us;
+    uint16_t slave_latency;
+    uint16_t supervision_timeout_ms;
+} connection_profiles[] = {
+    {MP_QSTR_low_latency, 7500, 15000, 0, 2000},
+    {MP_QSTR_balanced, 15000, 15000, 3, 2000},
+    {MP_QSTR_low_power, 400000, 500000, 4, 6000},
+};
+
+STATIC mp_obj_t bluetooth_connection_params(void)
+{
+    const ble_stats_t *stats = ble_get_stats();
+
+    mp_obj_t tuple[3] = {
+        mp_obj_new_int(stats->connection_interval * 1250),
+        mp_obj_new_int(stats->slave_latency),
+        mp_obj_new_int(stats->supervision_timeout * 10),
+    };
+
+    return mp_obj_new_tuple(3, tuple);
+}
+
+STATIC mp_obj_t bluetooth_profile(size_t n_args, const mp_obj_t *args)
+{
+    if (n_args == 0)
+    {
+        return bluetooth_connection_params();
+    }
+
+    qstr name = mp_obj_str_get_qstr(args[0]);
+    const struct connection_profile_t *profile = NULL;
+
+    for (size_t i = 0; i < MP_ARRAY_SIZE(connection_profiles); i++)
+    {
+        if (connection_profiles[i].name == name)
+        {
+            profile = &connection_profiles[i];
+        }
+    }
+
+    if (profile == NULL)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT(
+            "profile must be 'low_latency', 'balanced' or 'low_power'"));
+    }
+
+    uint32_t updates = ble_get_stats()->connection_param_updates;
+
+    if (ble_request_connection_params(profile->min_interval_us,
+                                      profile->max_interval_us,
+                                      profile->slave_latency,
+                                      profile->supervision_timeout_ms))
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("connection parameters can't be updated"));
+    }
+
+    // The central decides, so wait a little for what it grants
+    mp_uint_t start = mp_hal_ticks_ms();
+    while (ble_get_stats()->connection_param_updates == updates &&
+           mp_hal_ticks_ms() - start < 2000)
+    {
+        mp_hal_poll_hook_ms(2000 - (mp_hal_ticks_ms() - start));
+    }
+
+    return bluetooth_connection_params();
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bluetooth_profile_obj, 0, 1, bluetooth_profile);
+
+static void stats_store(mp_obj_dict_t *dict, qstr key, mp_uint_t value)
+{
+    mp_obj_dict_store(dict,
+                      MP_OBJ_NEW_QSTR(key),
+                      mp_obj_new_int_from_uint(value));
+}
+
+STATIC mp_obj_t bluetooth_stats(void)
+{
+    const ble_stats_t *stats = ble_get_stats();
+    mp_obj_dict_t *dict = mp_obj_new_dict(0);
+
+    stats_store(dict, MP_QSTR_repl_notifications_queued, stats->repl_notifications_queued);
+    stats_store(dict, MP_QSTR_repl_notifications_rejected, stats->repl_notifications_rejected);
+    stats_store(dict, MP_QSTR_data_notifications_queued, stats->data_notifications_queued);
+    stats_store(dict, MP_QSTR_data_notifications_rejected, stats->data_notifications_rejected);
+    stats_store(dict, MP_QSTR_repl_bytes_sent, stats->repl_bytes_sent);
+    stats_store(dict, MP_QSTR_repl_bytes_received, stats->repl_bytes_received);
+    stats_store(dict, MP_QSTR_data_bytes_sent, stats->data_bytes_sent);
+    stats_store(dict, MP_QSTR_data_bytes_received, stats->data_bytes_received);
+    stats_store(dict, MP_QSTR_repl_tx_high_water, stats->repl_tx_high_water);
+    stats_store(dict, MP_QSTR_repl_rx_high_water, stats->repl_rx_high_water);
+    stats_store(dict, MP_QSTR_repl_rx_dropped, stats->repl_rx_dropped);
+    stats_store(dict, MP_QSTR_data_rx_high_water, data_rx_high_water);
+    stats_store(dict, MP_QSTR_data_rx_dropped, data_rx_dropped);
+    stats_store(dict, MP_QSTR_mtu, ble_get_max_payload_size());
+    stats_store(dict, MP_QSTR_tx_phy, stats->tx_phy);
+    stats_store(dict, MP_QSTR_rx_phy, stats->rx_phy);
+    stats_store(dict, MP_QSTR_max_tx_octets, stats->max_tx_octets);
+    stats_store(dict, MP_QSTR_max_rx_octets, stats->max_rx_octets);
+
+    // Convert from 1.25ms units to microseconds
+    stats_store(dict, MP_QSTR_connection_interval_us, stats->connection_interval * 1250);
+    stats_store(dict, MP_QSTR_slave_latency, stats->slave_latency);
+    stats_store(dict, MP_QSTR_supervision_timeout_ms, stats->supervision_timeout * 10);
+
+    return MP_OBJ_FROM_PTR(dict);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bluetooth_stats_obj, bluetooth_stats);
+
+STATIC mp_obj_t bluetooth_reset_stats(void)
+{
+    ble_reset_stats();
+    data_rx_dropped = 0;
+    data_rx_high_water = data_rx_available();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bluetooth_reset_stats_obj, bluetooth_reset_stats);
+
 STATIC const mp_rom_map_elem_t bluetooth_module_globals_table[] = {
     {MP_ROM_QSTR(MP_QSTR_send), MP_ROM_PTR(&bluetooth_send_obj)},
+    {MP_ROM_QSTR(MP_QSTR_send_stream), MP_ROM_PTR(&bluetooth_send_stream_obj)},
     {MP_ROM_QSTR(MP_QSTR_receive_callback), MP_ROM_PTR(&bluetooth_receive_callback_obj)},
+    {MP_ROM_QSTR(MP_QSTR_read_into), MP_ROM_PTR(&bluetooth_read_into_obj)},
+    {MP_ROM_QSTR(MP_QSTR_any), MP_ROM_PTR(&bluetooth_any_obj)},
+    {MP_ROM_QSTR(MP_QSTR_recv), MP_ROM_PTR(&bluetooth_recv_obj)},
     {MP_ROM_QSTR(MP_QSTR_connected), MP_ROM_PTR(&bluetooth_connected_obj)},
     {MP_ROM_QSTR(MP_QSTR_max_length), MP_ROM_PTR(&bluetooth_max_length_obj)},
+#if MONOCLE_L2CAP
+    {MP_ROM_QSTR(MP_QSTR_l2cap_open), MP_ROM_PTR(&bluetooth_l2cap_open_obj)},
+    {MP_ROM_QSTR(MP_QSTR_l2cap_close), MP_ROM_PTR(&bluetooth_l2cap_close_obj)},
+    {MP_ROM_QSTR(MP_QSTR_l2cap_connected), MP_ROM_PTR(&bluetooth_l2cap_connected_obj)},
+    {MP_ROM_QSTR(MP_QSTR_l2cap_send), MP_ROM_PTR(&bluetooth_l2cap_send_obj)},
+    {MP_ROM_QSTR(MP_QSTR_l2cap_read_into), MP_ROM_PTR(&bluetooth_l2cap_read_into_obj)},
+    {MP_ROM_QSTR(MP_QSTR_l2cap_any), MP_ROM_PTR(&bluetooth_l2cap_any_obj)},
+#endif
+    {MP_ROM_QSTR(MP_QSTR_profile), MP_ROM_PTR(&bluetooth_profile_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&bluetooth_stats_obj)},
+    {MP_ROM_QSTR(MP_QSTR_reset_stats), MP_ROM_PTR(&bluetooth_reset_stats_obj)},
 };
 STATIC MP_DEFINE_CONST_DICT(bluetooth_module_globals, bluetooth_module_globals_table);
 
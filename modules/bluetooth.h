@@ -28,3 +28,7 @@
 #include <stdint.h>
 
 void bluetooth_receive_callback_handler(const uint8_t *bytes, size_t len);
+
+// Header of each fragment: bit 7 marks the last one, bits 0-6 count up
+#define STREAM_HEADER_LAST 0x80
+#define STREAM_HEADER_SEQUENCE 0x7F
@@ -22,10 +22,59 @@
  * PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <stdint.h>
+#include <string.h>
+#include "bluetooth.h"
 #include "monocle.h"
+#include "mphalport.h"
 #include "nrf_gpio.h"
+#include "py/mphal.h"
 #include "py/runtime.h"
 
+// FPGA commands for the JPEG encoder output
+#define FPGA_CAPTURE_COMMAND 0x1003
+#define FPGA_JPEG_AVAILABLE 0x5801
+#define FPGA_JPEG_DATA 0x5810
+
+// Chunks are read from the FPGA into one half while the other goes out
+#define CAPTURE_CHUNK_SIZE (1024)
+#define CAPTURE_TIMEOUT_MS (1000)
+
+static uint8_t capture_ring[2][CAPTURE_CHUNK_SIZE];
+
+// Set by camera.output(). Raw frames are 2 bytes per pixel, and JPEG ends
+// with the end of image marker
+static struct camera_output_t
+{
+    uint16_t width;
+    uint16_t height;
+    qstr format;
+} camera_output = {640, 400, MP_QSTR_JPEG};
+
+// Bytes of a raw frame still to be read from the FPGA
+static size_t capture_left;
+
+static struct capture_stats_t
+{
+    uint32_t bytes;
+    uint32_t fragments;
+    uint32_t first_byte_us;
+    uint32_t total_us;
+    uint32_t fpga_wait_us;
+    uint32_t ble_wait_us;
+} capture_stats;
+
+// Stream fragments are only sent once more data follows, so the last one
+// can be flagged when the capture ends
+typedef struct capture_stream_t
+{
+    bool l2cap;
+    uint8_t *fragment;
+    size_t max_payload;
+    size_t len;
+    uint8_t sequence;
+} capture_stream_t;
+
 STATIC mp_obj_t camera_sleep(void)
 {
     nrf_gpio_pin_write(CAMERA_SLEEP_PIN, true);
@@ -40,6 +89,275 @@ STATIC mp_obj_t camera_wake(void)
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(camera_wake_obj, camera_wake);
 
+static void capture_check_connected(capture_stream_t *stream)
+{
+    if (stream->l2cap ? !ble_l2cap_is_connected()
+                      : !ble_are_tx_notifications_enabled(DATA_TX))
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("bluetooth disconnected during capture"));
+    }
+}
+
+static void capture_flush(capture_stream_t *stream, bool last)
+{
+    stream->fragment[0] = stream->sequence++ & STREAM_HEADER_SEQUENCE;
+    if (last)
+    {
+        stream->fragment[0] |= STREAM_HEADER_LAST;
+    }
+
+    uint32_t start = mp_hal_ticks_us();
+
+    // Block while the notification queue is full, servicing events
+    while (ble_send_raw_data(stream->fragment, stream->len + 1))
+    {
+        capture_check_connected(stream);
+        MICROPY_EVENT_POLL_HOOK;
+    }
+
+    capture_stats.ble_wait_us += mp_hal_ticks_us() - start;
+    capture_stats.fragments++;
+    stream->len = 0;
+}
+
+static void capture_send(capture_stream_t *stream, const uint8_t *data,
+                         size_t len)
+{
+    // L2CAP frames with its own SDUs, straight from the ring
+    if (stream->l2cap)
+    {
+        uint32_t start = mp_hal_ticks_us();
+        if (ble_l2cap_send(data, len))
+        {
+            capture_check_connected(stream);
+        }
+        capture_stats.ble_wait_us += mp_hal_ticks_us() - start;
+        capture_stats.fragments++;
+        return;
+    }
+
+    while (len > 0)
+    {
+        if (stream->len == stream->max_payload - 1)
+        {
+            capture_flush(stream, false);
+        }
+
+        size_t n = MIN(len, stream->max_payload - 1 - stream->len);
+        memcpy(&stream->fragment[1 + stream->len], data, n);
+        stream->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static size_t capture_available(void)
+{
+    uint8_t addr_bytes[2] = {FPGA_JPEG_AVAILABLE >> 8, FPGA_JPEG_AVAILABLE & 0xFF};
+    uint8_t available[2];
+
+    monocle_spi_write(FPGA, addr_bytes, 2, true);
+    monocle_spi_read(FPGA, available, 2, false);
+
+    size_t len = MIN(available[0] << 8 | available[1], CAPTURE_CHUNK_SIZE);
+    return MIN(len, capture_left);
+}
+
+static void capture_read_async(uint8_t *buffer, size_t len)
+{
+    uint8_t addr_bytes[2] = {FPGA_JPEG_DATA >> 8, FPGA_JPEG_DATA & 0xFF};
+
+    monocle_spi_write_async(FPGA, addr_bytes, 2, true);
+    capture_left -= len;
+
+    spi_transaction_t transaction = {
+        .device = FPGA,
+        .rx = buffer,
+        .length = len,
+    };
+    monocle_spi_submit(&transaction);
+}
+
+static size_t capture_wait_available(uint32_t since_ms)
+{
+    uint32_t start = mp_hal_ticks_us();
+    size_t available;
+
+    while ((available = capture_available()) == 0)
+    {
+        if (mp_hal_ticks_ms() - since_ms >= CAPTURE_TIMEOUT_MS)
+        {
+            mp_raise_msg(&mp_type_OSError,
+                         MP_ERROR_TEXT("camera capture timed out"));
+        }
+
+        // The FPGA raises no interrupt for this, so poll it every ms
+        mp_hal_poll_hook_ms(1);
+    }
+
+    capture_stats.fpga_wait_us += mp_hal_ticks_us() - start;
+    return available;
+}
+
+// The encoder stops after the end of image marker
+static bool capture_ends_image(const uint8_t *data, size_t len, uint8_t *previous)
+{
+    bool end = (len >= 2 ? data[len - 2] : *previous) == 0xFF &&
+               data[len - 1] == 0xD9;
+    *previous = data[len - 1];
+    return end;
+}
+
+STATIC mp_obj_t camera_capture(mp_obj_t url_in)
+{
+    size_t url_len;
+    const char *url = mp_obj_str_get_data(url_in, &url_len);
+
+    capture_stream_t stream = {
+        .l2cap = ble_l2cap_is_connected(),
+        .max_payload = ble_get_max_payload_size(),
+    };
+
+    if (!stream.l2cap && !ble_are_tx_notifications_enabled(DATA_TX))
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT(
+                         "notifications are not enabled on the data service"));
+    }
+
+    if (stream.max_payload < 2)
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("MTU is too small for streaming"));
+    }
+
+    uint8_t fragment[stream.max_payload];
+    stream.fragment = fragment;
+
+    memset(&capture_stats, 0, sizeof(capture_stats));
+    uint32_t start_us = mp_hal_ticks_us();
+    uint32_t start_ms = mp_hal_ticks_ms();
+
+    bool raw = camera_output.format != MP_QSTR_JPEG;
+    capture_left = raw ? camera_output.width * camera_output.height * 2 : SIZE_MAX;
+
+    // The data byte selects between the JPEG encoder and the raw pixels
+    uint8_t capture_command[3] = {FPGA_CAPTURE_COMMAND >> 8, FPGA_CAPTURE_COMMAND & 0xFF, raw};
+    monocle_spi_write(FPGA, capture_command, 3, false);
+
+    // The phone is told where the image goes before the image itself
+    capture_send(&stream, (const uint8_t *)url, url_len);
+    capture_send(&stream, (const uint8_t *)"\n", 1);
+
+    size_t len = capture_wait_available(start_ms);
+    capture_stats.first_byte_us = mp_hal_ticks_us() - start_us;
+    capture_read_async(capture_ring[0], len);
+
+    uint8_t previous = 0;
+    size_t current = 0;
+
+    for (;;)
+    {
+        monocle_spi_wait();
+        bool end = raw ? capture_left == 0
+                       : capture_ends_image(capture_ring[current], len, &previous);
+
+        // Start reading the next chunk before sending this one
+        size_t next_len = end ? 0 : capture_available();
+        if (next_len > 0)
+        {
+            capture_read_async(capture_ring[!current], next_len);
+        }
+
+        capture_stats.bytes += len;
+        capture_send(&stream, capture_ring[current], len);
+
+        if (end)
+        {
+            break;
+        }
+
+        if (next_len == 0)
+        {
+            next_len = capture_wait_available(mp_hal_ticks_ms());
+            capture_read_async(capture_ring[!current], next_len);
+        }
+
+        len = next_len;
+        current = !current;
+    }
+
+    if (!stream.l2cap)
+    {
+        capture_flush(&stream, true);
+    }
+
+    capture_stats.total_us = mp_hal_ticks_us() - start_us;
+
+    return mp_obj_new_int_from_uint(capture_stats.bytes);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(camera_capture_obj, camera_capture);
+
+STATIC mp_obj_t camera_stats(void)
+{
+    mp_obj_t dict = mp_obj_new_dict(6);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes),
+                      mp_obj_new_int_from_uint(capture_stats.bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_fragments),
+                      mp_obj_new_int_from_uint(capture_stats.fragments));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_first_byte_us),
+                      mp_obj_new_int_from_uint(capture_stats.first_byte_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_total_us),
+                      mp_obj_new_int_from_uint(capture_stats.total_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_fpga_wait_us),
+                      mp_obj_new_int_from_uint(capture_stats.fpga_wait_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_ble_wait_us),
+                      mp_obj_new_int_from_uint(capture_stats.ble_wait_us));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(camera_stats_obj, camera_stats);
+
+STATIC mp_obj_t camera_output_set(mp_obj_t width, mp_obj_t height, mp_obj_t format)
+{
+    mp_int_t x = mp_obj_get_int(width);
+    mp_int_t y = mp_obj_get_int(height);
+    qstr mode = mp_obj_str_get_qstr(format);
+
+    if (mode != MP_QSTR_JPEG && mode != MP_QSTR_RGB && mode != MP_QSTR_YUV)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("format must be RGB, YUV or JPEG"));
+    }
+
+    // Same limits as camera.output(), the raw modes need whole YUYV pairs
+    if (x < 2 || x > 640 || y < 2 || y > 400 || x % 2)
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("size must be within 640x400, with an even width"));
+    }
+
+    camera_output.width = x;
+    camera_output.height = y;
+    camera_output.format = mode;
+
+    // The ISP scales the sensor window down to the output size
+    i2c_register_t const registers[] = {
+        {0x3808, camera_output.width >> 8},        // Timing X output size MSB
+        {0x3809, camera_output.width & 0xFF},      // Timing X output size LSB
+        {0x380a, camera_output.height >> 8},       // Timing Y output size MSB
+        {0x380b, camera_output.height & 0xFF},     // Timing Y output size LSB
+        {0x4300, camera_output.format == MP_QSTR_RGB ? 0x61 : 0x30}, // RGB565 or YUV422 YUYV
+        {0x501f, camera_output.format == MP_QSTR_RGB ? 0x01 : 0x00}, // ISP format RGB or YUV422
+    };
+
+    // The size goes out as one burst, and the table is on the stack
+    monocle_i2c_write_table(CAMERA_I2C_ADDRESS, registers, MP_ARRAY_SIZE(registers));
+    app_err(monocle_i2c_wait());
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(camera_output_obj, camera_output_set);
+
 STATIC mp_obj_t camera_zoom(mp_obj_t zoom)
 {
     switch (mp_obj_get_int(zoom))
@@ -48,9 +366,15 @@ STATIC mp_obj_t camera_zoom(mp_obj_t zoom)
         app_err(monocle_i2c_write(CAMERA_I2C_ADDRESS, 0x5600, 0xFF, 0x10).fail); // turns zoom 0ff
         break;
     case 16:
-        app_err(monocle_i2c_write(CAMERA_I2C_ADDRESS, 0x5600, 0xFF, 0x00).fail); // turns zoom on
-        app_err(monocle_i2c_write(CAMERA_I2C_ADDRESS, 0x5601, 0xFF, 0x88).fail); // Set zoom factor
+    {
+        i2c_register_t const registers[] = {
+            {0x5600, 0x00}, // turns zoom on
+            {0x5601, 0x88}, // Set zoom factor
+        };
+        monocle_i2c_write_table(CAMERA_I2C_ADDRESS, registers, MP_ARRAY_SIZE(registers));
+        app_err(monocle_i2c_wait());
         break;
+    }
     default:
         mp_raise_ValueError(MP_ERROR_TEXT("zoom must be 1 or 16"));
     }
@@ -60,6 +384,9 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(camera_zoom_obj, camera_zoom);
 
 STATIC const mp_rom_map_elem_t camera_module_globals_table[] = {
 
+    {MP_ROM_QSTR(MP_QSTR_capture), MP_ROM_PTR(&camera_capture_obj)},
+    {MP_ROM_QSTR(MP_QSTR_output), MP_ROM_PTR(&camera_output_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&camera_stats_obj)},
     {MP_ROM_QSTR(MP_QSTR_sleep), MP_ROM_PTR(&camera_sleep_obj)},
     {MP_ROM_QSTR(MP_QSTR_wake), MP_ROM_PTR(&camera_wake_obj)},
     {MP_ROM_QSTR(MP_QSTR_zoom), MP_ROM_PTR(&camera_zoom_obj)},
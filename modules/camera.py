@@ -32,30 +32,49 @@ YUV = 'YUV'
 JPEG = 'JPEG'
 
 __overlay_state = False
+__output = (640, 400, JPEG)
+
+# Compiled once, so that switching modes costs one call each
+__overlay_prepare = __fpga.Batch([(0x4404, b'', 100)])
+__overlay_on = __fpga.Batch([(0x1005, b''), (0x3005, b'')])
+__overlay_off = __fpga.Batch([(0x3004, b''), (0x1004, b'', 100)])
 
 def capture(url):
-  raise NotImplementedError
+  __camera.wake()
+  __camera.output(*__output)
+  __time.sleep_ms(100)
+  try:
+    return __camera.capture(url)
+  finally:
+    # The overlay shows the full frame on the display
+    __camera.output(640, 400, YUV)
+    if not overlay():
+      __camera.sleep()
+
+def stats():
+  return __camera.stats()
 
 def overlay(enable=None):
   if enable == None:
     global __overlay_state
     return __overlay_state
   if enable == True:
-    __fpga.write(0x4404, "")
-    __time.sleep_ms(100)
+    __overlay_prepare.run()
     __camera.wake()
-    __fpga.write(0x1005, "")
-    __fpga.write(0x3005, "")
+    __overlay_on.run()
     __overlay_state = True
   else:
-    __fpga.write(0x3004, "")
-    __fpga.write(0x1004, "")
-    __time.sleep_ms(100)
+    __overlay_off.run()
     __camera.sleep()
     __overlay_state = False
 
 def output(x, y, format):
-  raise NotImplementedError
+  if format not in (RGB, YUV, JPEG):
+    raise ValueError("format must be RGB, YUV or JPEG")
+  if not (2 <= x <= 640 and 2 <= y <= 400) or x % 2:
+    raise ValueError("size must be within 640x400, with an even width")
+  global __output
+  __output = (x, y, format)
 
 def zoom(multiplier):
   __camera.wake()
@@ -80,4 +99,4 @@ def replay():
 
   # This will trigger one replay of the recorded feed
   __fpga.write(0x3007, b'') # replay once
-  __time.sleep(4)
+  __fpga.wait(4000)
@@ -23,13 +23,15 @@
  */
 
 #include <stdio.h>
-#include <math.h>
+#include <string.h>
+#include "battery.h"
+#include "events.h"
 #include "monocle.h"
 #include "genhdr/mpversion.h"
+#include "py/gc.h"
 #include "py/objstr.h"
 #include "py/runtime.h"
 #include "ble_gap.h"
-#include "nrfx_saadc.h"
 
 STATIC const MP_DEFINE_STR_OBJ(device_name_obj, "monocle");
 
@@ -56,37 +58,47 @@ MP_DEFINE_CONST_FUN_OBJ_0(device_mac_address_obj, device_mac_address);
 
 STATIC mp_obj_t device_battery_level(void)
 {
-    nrf_saadc_value_t result;
-    app_err(nrfx_saadc_simple_mode_set(1,
-                                       NRF_SAADC_RESOLUTION_10BIT,
-                                       NRF_SAADC_OVERSAMPLE_DISABLED,
-                                       NULL));
-    app_err(nrfx_saadc_buffer_set(&result, 1));
-
-    app_err(nrfx_saadc_mode_trigger());
-
-    // V = (raw / 10bits) * Vref * (1/NRFgain) * AMUXgain
-    float voltage = ((float)result / 1024.0f) * 0.6f * 2.0f * (4.5f / 1.25f);
+    return MP_OBJ_NEW_SMALL_INT(battery_level());
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(device_battery_level_obj, device_battery_level);
 
-    // Percentage is based on a polynomial. Details in tools/battery-model
-    float percentage = roundf(-118.13699f * powf(voltage, 3.0f) +
-                              1249.63556f * powf(voltage, 2.0f) -
-                              4276.33059f * voltage +
-                              4764.47488f);
+STATIC mp_obj_t device_battery_voltage(void)
+{
+    return mp_obj_new_float(battery_millivolts() / 1000.0f);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(device_battery_voltage_obj, device_battery_voltage);
 
-    if (percentage < 0.0f)
+STATIC mp_obj_t device_battery_set_callback(mp_obj_t *slot, size_t n_args, const mp_obj_t *args)
+{
+    if (n_args == 0)
     {
-        percentage = 0.0f;
+        return *slot == MP_OBJ_NULL ? mp_const_none : *slot;
     }
 
-    if (percentage > 100.0f)
+    if (!mp_obj_is_callable(args[0]) && (args[0] != mp_const_none))
     {
-        percentage = 100.0f;
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("callback must be None or a callable object"));
     }
 
-    return mp_obj_new_int_from_uint((uint8_t)percentage);
+    *slot = args[0];
+
+    return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_0(device_battery_level_obj, device_battery_level);
+
+STATIC mp_obj_t device_battery_callback(size_t n_args, const mp_obj_t *args)
+{
+    return device_battery_set_callback(&MP_STATE_PORT(battery_voltage_callback),
+                                       n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(device_battery_callback_obj, 0, 1, device_battery_callback);
+
+STATIC mp_obj_t device_charging_callback(size_t n_args, const mp_obj_t *args)
+{
+    return device_battery_set_callback(&MP_STATE_PORT(battery_charging_callback),
+                                       n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(device_charging_callback_obj, 0, 1, device_charging_callback);
 
 STATIC mp_obj_t device_reset(void)
 {
@@ -125,6 +137,9 @@ STATIC mp_obj_t device_prevent_sleep(size_t n_args, const mp_obj_t *args)
 
     prevent_sleep_flag = mp_obj_is_true(args[0]);
 
+    // Go to sleep now if on charge, rather than at the next charger event
+    monocle_pmic_check();
+
     if (prevent_sleep_flag)
     {
         mp_printf(&mp_plat_print,
@@ -143,10 +158,130 @@ STATIC mp_obj_t device_force_sleep(void)
 
     force_sleep_flag = true;
 
+    monocle_pmic_check();
+
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(device_force_sleep_obj, device_force_sleep);
 
+STATIC mp_obj_t device_flash_info(void)
+{
+    uint8_t id[3];
+    monocle_flash_jedec_id(id);
+
+    // The last ID byte is the capacity as a power of two for most parts
+    mp_int_t size = (id[2] >= 0x10 && id[2] <= 0x1F) ? 1 << id[2] : 0;
+
+    mp_obj_t dict = mp_obj_new_dict(2);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_jedec_id),
+                      mp_obj_new_int(id[0] << 16 | id[1] << 8 | id[2]));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_size),
+                      mp_obj_new_int(size));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(device_flash_info_obj, device_flash_info);
+
+STATIC mp_obj_t device_boot_timeline(void)
+{
+    const boot_mark_t *marks;
+    size_t length = monocle_boot_timeline(&marks);
+
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    for (size_t i = 0; i < length; i++)
+    {
+        mp_obj_t mark[2] = {
+            mp_obj_new_str(marks[i].step, strlen(marks[i].step)),
+            mp_obj_new_int_from_uint(marks[i].us),
+        };
+        mp_obj_list_append(list, mp_obj_new_tuple(2, mark));
+    }
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(device_boot_timeline_obj, device_boot_timeline);
+
+STATIC mp_obj_t device_allocations(size_t n_args, const mp_obj_t *args)
+{
+    // A collection during the call would hide what it allocated
+    bool auto_collect = MP_STATE_MEM(gc_auto_collect_enabled);
+    MP_STATE_MEM(gc_auto_collect_enabled) = false;
+
+    gc_info_t before;
+    gc_info(&before);
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0)
+    {
+        mp_call_function_n_kw(args[0], n_args - 1, 0, args + 1);
+        nlr_pop();
+    }
+    else
+    {
+        MP_STATE_MEM(gc_auto_collect_enabled) = auto_collect;
+        nlr_jump(nlr.ret_val);
+    }
+
+    gc_info_t after;
+    gc_info(&after);
+
+    MP_STATE_MEM(gc_auto_collect_enabled) = auto_collect;
+
+    return mp_obj_new_int(after.used - before.used);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(device_allocations_obj, 1, MP_OBJ_FUN_ARGS_MAX, device_allocations);
+
+STATIC mp_obj_t device_events(void)
+{
+    static const qstr names[] = {
+        [EVENT_TOUCH_A] = MP_QSTR_touch_A,
+        [EVENT_TOUCH_B] = MP_QSTR_touch_B,
+        [EVENT_BLE_CONNECTED] = MP_QSTR_connected,
+        [EVENT_BLE_DISCONNECTED] = MP_QSTR_disconnected,
+        [EVENT_BLE_DATA] = MP_QSTR_data,
+        [EVENT_CHARGER] = MP_QSTR_charger,
+        [EVENT_THERMAL] = MP_QSTR_thermal,
+    };
+
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    event_t events[8];
+    size_t taken;
+
+    // Drain in small batches, without allocating inside the critical section
+    do
+    {
+        taken = events_take(events, MP_ARRAY_SIZE(events));
+        for (size_t i = 0; i < taken; i++)
+        {
+            mp_obj_t event[4] = {
+                MP_OBJ_NEW_QSTR(names[events[i].type]),
+                mp_obj_new_int_from_uint(events[i].first_ms),
+                mp_obj_new_int_from_uint(events[i].last_ms),
+                mp_obj_new_int_from_uint(events[i].count),
+            };
+            mp_obj_list_append(list, mp_obj_new_tuple(4, event));
+        }
+    } while (taken == MP_ARRAY_SIZE(events));
+
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(device_events_obj, device_events);
+
+STATIC mp_obj_t device_event_stats(void)
+{
+    event_stats_t *stats = events_stats();
+
+    mp_obj_t dict = mp_obj_new_dict(4);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_queued),
+                      mp_obj_new_int_from_uint(stats->queued));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_coalesced),
+                      mp_obj_new_int_from_uint(stats->coalesced));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_dropped),
+                      mp_obj_new_int_from_uint(stats->dropped));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_callbacks_lost),
+                      mp_obj_new_int_from_uint(stats->callbacks_lost));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(device_event_stats_obj, device_event_stats);
+
 extern const struct _mp_obj_type_t device_storage_type;
 
 STATIC const mp_rom_map_elem_t device_module_globals_table[] = {
@@ -157,10 +292,18 @@ STATIC const mp_rom_map_elem_t device_module_globals_table[] = {
     {MP_ROM_QSTR(MP_QSTR_GIT_TAG), MP_ROM_PTR(&device_git_tag_obj)},
     {MP_ROM_QSTR(MP_QSTR_GIT_REPO), MP_ROM_PTR(&device_git_repo_obj)},
     {MP_ROM_QSTR(MP_QSTR_battery_level), MP_ROM_PTR(&device_battery_level_obj)},
+    {MP_ROM_QSTR(MP_QSTR_battery_voltage), MP_ROM_PTR(&device_battery_voltage_obj)},
+    {MP_ROM_QSTR(MP_QSTR_battery_callback), MP_ROM_PTR(&device_battery_callback_obj)},
+    {MP_ROM_QSTR(MP_QSTR_charging_callback), MP_ROM_PTR(&device_charging_callback_obj)},
     {MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&device_reset_obj)},
     {MP_ROM_QSTR(MP_QSTR_reset_cause), MP_ROM_PTR(&device_reset_cause_obj)},
     {MP_ROM_QSTR(MP_QSTR_prevent_sleep), MP_ROM_PTR(&device_prevent_sleep_obj)},
     {MP_ROM_QSTR(MP_QSTR_force_sleep), MP_ROM_PTR(&device_force_sleep_obj)},
+    {MP_ROM_QSTR(MP_QSTR_flash_info), MP_ROM_PTR(&device_flash_info_obj)},
+    {MP_ROM_QSTR(MP_QSTR_allocations), MP_ROM_PTR(&device_allocations_obj)},
+    {MP_ROM_QSTR(MP_QSTR_boot_timeline), MP_ROM_PTR(&device_boot_timeline_obj)},
+    {MP_ROM_QSTR(MP_QSTR_events), MP_ROM_PTR(&device_events_obj)},
+    {MP_ROM_QSTR(MP_QSTR_event_stats), MP_ROM_PTR(&device_event_stats_obj)},
     {MP_ROM_QSTR(MP_QSTR_Storage), MP_ROM_PTR(&device_storage_type)},
 };
 STATIC MP_DEFINE_CONST_DICT(device_module_globals, device_module_globals_table);
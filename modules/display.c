@@ -31,8 +31,11 @@
 #include "nrfx_log.h"
 #include "nrfx_systick.h"
 
-#include "math.h"
-#include "font.h"
+#include "awaitable.h"
+#include "display.h"
+#include "fontspans.h"
+#include "fontstore.h"
+#include "monocle.h"
 
 #define FPGA_ADDR_ALIGN 128
 #define DISPLAY_WIDTH 640
@@ -61,8 +64,11 @@ enum
     OBJ_NULL,      // skip this object
     OBJ_RECTANGLE, // filled
     OBJ_LINE,      // diagonal line
-    OBJ_ELLIPSIS,  // diagonal line
-    OBJ_TEXT,      // a single line of text truncated at the end
+    OBJ_ELLIPSIS,  // filled, or outlined if arg is 0
+    OBJ_TEXT,      // a laid out Text object, possibly on several lines
+    OBJ_FRAME,     // rectangle outline
+    OBJ_POLYGON,   // filled, arg points to a poly_t
+    OBJ_BITMAP,    // image, arg points to a bitmap_t
 };
 
 typedef struct
@@ -78,7 +84,8 @@ typedef union
     uint32_t u32;
 } arg_t;
 
-typedef struct
+// Packed to 2 bytes, the Cortex-M4 handles the unaligned arg
+typedef struct __attribute__((packed, aligned(2)))
 {
     int16_t x, y, width, height;
     uint8_t yuv444[3];
@@ -86,11 +93,111 @@ typedef struct
     arg_t arg;
 } obj_t;
 
-obj_t obj_list[512];
-size_t obj_num;
+// Recent colours are converted to YUV444 once, and objects keep a copy, so
+// a frame can use any number of them
+#define PALETTE_SIZE 64
+
+typedef struct
+{
+    uint32_t rgb;
+    uint8_t yuv444[3];
+} color_t;
+
+static color_t palette[PALETTE_SIZE];
+static size_t palette_num;
+static size_t palette_last;
+static size_t palette_next;
+
+#define OBJ_YUV444(obj) ((obj)->yuv444)
+
+// Everything the renderer needs lives in one statically sized arena. The
+// row buffers and row index take a fixed share, the rest holds objects.
+// It can be overridden from the Makefile to give more RAM to the heap.
+#ifndef DISPLAY_ARENA_SIZE
+#define DISPLAY_ARENA_SIZE (12 * 1024)
+#endif
+
+#define ROW_SIZE (DISPLAY_WIDTH * 2)
+#define OBJ_SLOT_SIZE (sizeof(obj_t) + 2 * sizeof(uint16_t))
+#define ARENA_FIXED_SIZE (2 * ROW_SIZE + (DISPLAY_HEIGHT + 1) * sizeof(uint16_t))
+#define OBJ_MAX ((DISPLAY_ARENA_SIZE - ARENA_FIXED_SIZE) / OBJ_SLOT_SIZE)
+
+typedef struct
+{
+    // One row is rendered while the other is sent over SPI
+    uint8_t row_buf[2][ROW_SIZE];
+
+    // Objects in drawing order, sorted by their first row, and those
+    // overlapping the current row
+    obj_t obj_list[OBJ_MAX];
+    uint16_t obj_by_row[OBJ_MAX];
+    uint16_t obj_active[OBJ_MAX];
+    uint16_t row_start[DISPLAY_HEIGHT + 1];
+} arena_t;
+
+_Static_assert(sizeof(arena_t) <= DISPLAY_ARENA_SIZE, "display arena overflow");
+_Static_assert(OBJ_MAX > 0 && OBJ_MAX <= UINT16_MAX, "bad display arena size");
+
+static arena_t arena __attribute__((aligned(4)));
 
-static uint8_t const *font = font_50;
+static obj_t *const obj_list = arena.obj_list;
+static uint16_t *const obj_by_row = arena.obj_by_row;
+static uint16_t *const obj_active = arena.obj_active;
+static uint16_t *const row_start = arena.row_start;
+static uint8_t (*const row_buf)[ROW_SIZE] = arena.row_buf;
+
+static size_t obj_num;
+static size_t obj_peak;
+
+// Heap data referred to by queued objects is kept alive from here until the
+// next show(). The list is only walked by the GC.
+MP_REGISTER_ROOT_POINTER(mp_obj_t display_pinned);
+
+static void pin_obj(void *ptr)
+{
+    if (MP_STATE_PORT(display_pinned) == MP_OBJ_NULL)
+    {
+        MP_STATE_PORT(display_pinned) = mp_obj_new_list(0, NULL);
+    }
+    mp_obj_list_append(MP_STATE_PORT(display_pinned), MP_OBJ_FROM_PTR(ptr));
+}
+
+// The built-in font, in spans, others are loaded from the font store when
+// asked for
+static uint8_t const *font = span_font_50;
+static uint16_t const *font_index = span_font_50_index;
 static int16_t glyph_gap_width = 2;
+static int16_t line_gap_height = 4;
+
+// Retained mode compares each frame against the one in the FPGA back buffer
+// in tiles of TILE_HEIGHT rows by one FPGA block, and only redraws changes.
+#define TILE_HEIGHT 16
+#define TILE_ROWS (DISPLAY_HEIGHT / TILE_HEIGHT)
+#define TILE_COLUMNS (DISPLAY_WIDTH * 2 / FPGA_ADDR_ALIGN)
+
+typedef uint32_t tile_hash_t[TILE_ROWS][TILE_COLUMNS];
+
+static bool retained_mode = false;
+static uint8_t retained_frames = 0;
+static tile_hash_t front_hash;
+static tile_hash_t back_hash;
+static tile_hash_t new_hash;
+
+// The SPI transaction that last sends each row buffer, to wait for before
+// rendering into that buffer again
+static uint32_t row_sent[2];
+
+// Timings of the last show(), in CPU cycles from the DWT cycle counter
+static struct
+{
+    uint32_t show_cycles;
+    uint32_t clear_cycles;
+    uint32_t render_cycles;
+    uint32_t flush_cycles;
+    uint32_t rows_flushed;
+    uint32_t bytes_sent;
+    uint32_t objects;
+} show_stats;
 
 STATIC mp_obj_t display_brightness(mp_obj_t brightness)
 {
@@ -130,17 +237,78 @@ static inline void draw_pixel(row_t row, int16_t x, uint8_t yuv444[3])
     }
 }
 
+/**
+ * Pack a pair of YUV422 pixels, as stored in the row buffer: U Y V Y.
+ */
+static inline uint32_t pack_yuv422(uint8_t const yuv444[3])
+{
+    return yuv444[1] | yuv444[0] << 8 | yuv444[2] << 16 | yuv444[0] << 24;
+}
+
+/**
+ * Fill the pixels from p_beg to p_end included, counted in the order of the
+ * row buffer, which is flipped from the x coordinates. Whole pixel pairs are
+ * stored as words.
+ */
+static inline void fill_span(row_t row, int16_t p_beg, int16_t p_end, uint8_t yuv444[3])
+{
+    // Same range as draw_pixel() would write to, pixel by pixel
+    p_beg = MAX(p_beg, 1);
+    p_end = MIN(p_end, row.len / 2 - 1);
+    if (p_beg > p_end)
+    {
+        return;
+    }
+
+    uint8_t *buf = row.buf + p_beg * 2;
+
+    // Unaligned head: the V half of a pair
+    if (p_beg % 2 == 1)
+    {
+        buf[0] = yuv444[2];
+        buf[1] = yuv444[0];
+        buf += 2;
+        p_beg++;
+    }
+
+    uint32_t pair = pack_yuv422(yuv444);
+    uint32_t *word = (uint32_t *)buf;
+    for (; p_beg + 1 <= p_end; p_beg += 2)
+    {
+        *word++ = pair;
+    }
+
+    // Unaligned tail: the U half of a pair
+    if (p_beg == p_end)
+    {
+        buf = (uint8_t *)word;
+        buf[0] = yuv444[1];
+        buf[1] = yuv444[0];
+    }
+}
+
+/**
+ * Fill the pixels from x_beg to x_end, excluding x_end. Clipping and the
+ * horizontal flip are done once for the whole segment.
+ */
 static inline void draw_segment(row_t row, int16_t x_beg, int16_t x_end, uint8_t yuv444[3])
 {
-    for (size_t len = row.len / 2, x = x_beg; x < x_end && x < len; x++)
+    int16_t len = row.len / 2;
+
+    x_beg = MAX(x_beg, 0);
+    x_end = MIN(x_end, len);
+    if (x_beg >= x_end)
     {
-        draw_pixel(row, x, yuv444);
+        return;
     }
+
+    // TODO this flips the screen horizontally on purpose
+    fill_span(row, len - (x_end - 1), len - x_beg, yuv444);
 }
 
 static void render_rectangle(row_t row, obj_t *obj)
 {
-    draw_segment(row, obj->x, obj->x + obj->width, obj->yuv444);
+    draw_segment(row, obj->x, obj->x + obj->width, OBJ_YUV444(obj));
 }
 
 /**
@@ -185,32 +353,28 @@ static void render_line(row_t row, obj_t *obj)
     x1 = intersect_line(row.y, line_x1, line_y1, obj->width, obj->height, flip);
 
     // We then fill the pixels between these two points.
-    draw_segment(row, MIN(x0, x1), MAX(x0, x1), obj->yuv444);
+    draw_segment(row, MIN(x0, x1), MAX(x0, x1), OBJ_YUV444(obj));
 }
 
-static inline glyph_t get_glyph(uint8_t const *font, char c)
+static inline uint16_t get_glyph_offset(uint16_t const *index, unichar c)
 {
-    glyph_t glyph;
-    uint8_t const *f = font;
-
-    // Only ASCII is supported for this early release
-    // see how https://www.cl.cam.ac.uk/~mgk25/ucs/wcwidth.c
-    // encoded lookup tables for a strategy to support UTF-8.
+    // The built-in font only has ASCII, the font store has the rest
     if (c < ' ' || c > '~')
     {
-        return get_glyph(font, ' ');
+        c = ' ';
     }
 
-    // Store the global font header properties.
-    glyph.height = *f++;
+    // The index generated by txt2cfont points at each glyph's width byte
+    return index[c - ' '];
+}
 
-    // Scan the font, seeking for the glyph to render.
-    for (char i = ' '; i <= c; i++)
-    {
-        glyph.width = *f++;
-        glyph.bitmap = f;
-        f += (glyph.width * glyph.height + 7) / 8;
-    }
+static inline glyph_t get_glyph_at(uint8_t const *data, uint8_t height)
+{
+    glyph_t glyph;
+
+    glyph.height = height;
+    glyph.width = data[0];
+    glyph.bitmap = data + 1;
     return glyph;
 }
 
@@ -233,109 +397,481 @@ static inline bool get_glyph_bit(glyph_t *glyph, int16_t x, int16_t y)
  */
 static inline void draw_glyph(row_t row, int16_t x0, glyph_t *glyph, uint16_t y0, uint8_t yuv444[3])
 {
-    // for each vertical position
-    for (int16_t x = 0; x < glyph->width; x++)
+    // for each run of set bits on this line of the glyph
+    for (int16_t x = 0; x < glyph->width;)
     {
-        // check if the bit is set
-        if (get_glyph_bit(glyph, x, y0) == true)
+        if (get_glyph_bit(glyph, x, y0) == false)
+        {
+            x++;
+            continue;
+        }
+
+        int16_t beg = x;
+        while (x < glyph->width && get_glyph_bit(glyph, x, y0) == true)
         {
-            // and only if so, fill the buffer with it
-            draw_pixel(row, x0 + x, yuv444);
+            x++;
         }
+
+        // and only fill the buffer with the run
+        draw_segment(row, x0 + beg, x0 + x, yuv444);
     }
 }
 
-/*
- * Accurately compute the given string's display width
+/**
+ * Render a glyph from the span encoding of txt2cfont -s: the width, then a
+ * table of the first span of each row, then each span as a start counted from
+ * the right edge and a length. As the starts are already mirrored, each span
+ * maps straight to the row buffer, with no bit to test.
  */
-int16_t get_text_width(char const *s, size_t len)
+static inline void draw_glyph_spans(row_t row, int16_t x0, uint8_t const *data,
+                                    uint8_t height, uint16_t y0, uint8_t yuv444[3])
 {
-    int16_t width = 0;
+    uint8_t width = data[0];
+    uint8_t const *first = data + 1;
+    uint8_t const *spans = data + 1 + height + 1;
 
-    // Scan the whole string and get the width of each glyph
-    for (size_t i = 0; i < len; i++)
+    // Where the right edge of the glyph lands in the flipped row buffer
+    int16_t base = row.len / 2 - (x0 + width - 1);
+
+    for (uint8_t i = first[y0]; i < first[y0 + 1]; i++)
+    {
+        int16_t p_beg = base + spans[i * 2];
+        fill_span(row, p_beg, p_beg + spans[i * 2 + 1] - 1, yuv444);
+    }
+}
+
+/**
+ * Text objects are laid out once when created: each glyph gets a pointer to
+ * its data and its position, and lines are indexed by their first glyph.
+ * Scanlines then only walk the glyphs of the line they cross.
+ */
+typedef struct
+{
+    uint8_t const *data;
+    int16_t x;
+} text_glyph_t;
+
+typedef struct _display_text_obj_t
+{
+    mp_obj_base_t base;
+    mp_obj_t string;
+    mp_int_t x, y, rgb;
+    int16_t width, height;
+    uint8_t font_height;
+    bool spans;
+    uint16_t line_num;
+    uint16_t *line_start;
+    text_glyph_t *glyphs;
+} display_text_obj_t;
+
+const struct _mp_obj_type_t display_text_type;
+
+static int16_t text_line_height(display_text_obj_t const *self)
+{
+    return self->font_height + line_gap_height;
+}
+
+// Glyph data for the built-in font when store_font is NULL
+static uint8_t const *text_glyph_data(fontstore_font_t const *store_font, unichar c)
+{
+    if (store_font == NULL)
     {
-        // Accumulate the width of this glyph to render
-        width += (i == 0) ? 0 : glyph_gap_width;
-        width += get_glyph(font, s[i]).width;
+        return font + get_glyph_offset(font_index, c);
     }
-    return width;
+
+    return fontstore_glyph(store_font, c);
+}
+
+static void text_end_line(display_text_obj_t *self, size_t glyph_num, int16_t x)
+{
+    self->width = MAX(self->width, x);
+    self->line_start[++self->line_num] = glyph_num;
 }
 
-int16_t get_text_height(void)
+/**
+ * Greedy layout: break lines on '\n', and when the line would get wider
+ * than max_width, at the last space or else before the glyph that overflows.
+ */
+static void text_layout(display_text_obj_t *self, char const *s, size_t len,
+                        int16_t max_width, fontstore_font_t const *store_font)
 {
-    return font[0];
+    size_t glyph_num = 0;
+    size_t line_break = 0;
+    int16_t x = 0;
+
+    self->font_height = store_font == NULL ? font[0] : store_font->height;
+    self->spans = store_font == NULL || store_font->spans;
+    self->glyphs = m_new(text_glyph_t, MAX(len, 1));
+    self->line_start = m_new(uint16_t, len + 2);
+    self->line_start[0] = 0;
+    self->line_num = 0;
+    self->width = 0;
+
+    byte const *end = (byte const *)s + len;
+
+    for (byte const *p = (byte const *)s; p < end; p = utf8_next_char(p))
+    {
+        unichar c = utf8_get_char(p);
+
+        if (c == '\n')
+        {
+            text_end_line(self, glyph_num, x);
+            x = 0;
+            continue;
+        }
+
+        uint8_t const *data = text_glyph_data(store_font, c);
+        int16_t gap = (x == 0) ? 0 : glyph_gap_width;
+        int16_t advance = gap + data[0];
+        size_t line_beg = self->line_start[self->line_num];
+
+        if (max_width > 0 && x > 0 && x + advance > max_width)
+        {
+            // Spaces at a line break are dropped
+            if (c == ' ')
+            {
+                text_end_line(self, glyph_num, x);
+                x = 0;
+                continue;
+            }
+
+            if (line_break > line_beg && line_break < glyph_num)
+            {
+                // Move the last word down to the new line
+                text_glyph_t *last = &self->glyphs[glyph_num - 1];
+                int16_t shift = self->glyphs[line_break].x;
+
+                text_end_line(self, line_break, self->glyphs[line_break - 1].x +
+                                                    self->glyphs[line_break - 1].data[0]);
+                for (size_t j = line_break; j < glyph_num; j++)
+                {
+                    self->glyphs[j].x -= shift;
+                }
+                x = last->x + last->data[0];
+            }
+            else
+            {
+                text_end_line(self, glyph_num, x);
+                x = 0;
+            }
+
+            gap = (x == 0) ? 0 : glyph_gap_width;
+            advance = gap + data[0];
+        }
+
+        self->glyphs[glyph_num].data = data;
+        self->glyphs[glyph_num].x = x + gap;
+        glyph_num++;
+        x += advance;
+
+        if (c == ' ')
+        {
+            line_break = glyph_num;
+        }
+    }
+
+    text_end_line(self, glyph_num, x);
+    self->height = self->line_num * text_line_height(self) - line_gap_height;
 }
 
-static void render_text(row_t row, obj_t *obj)
+RAMFUNC static void render_text(row_t row, obj_t *obj)
 {
-    char const *s = obj->arg.ptr;
+    display_text_obj_t const *text = obj->arg.ptr;
+    int16_t y = row.y - obj->y;
+    uint16_t line = y / text_line_height(text);
+    int16_t y0 = y % text_line_height(text);
 
-    // Only a single row of text is supported.
-    if (row.y > obj->y + font[0])
+    // Rows within the gap between two lines stay empty
+    if (line >= text->line_num || y0 >= text->font_height)
     {
         return;
     }
 
-    for (int16_t x = obj->x; *s != '\0'; s++)
+    for (size_t i = text->line_start[line]; i < text->line_start[line + 1]; i++)
     {
-        glyph_t glyph;
+        if (text->spans)
+        {
+            draw_glyph_spans(row, obj->x + text->glyphs[i].x, text->glyphs[i].data,
+                             text->font_height, y0, OBJ_YUV444(obj));
+            continue;
+        }
 
-        // search the glyph within the font data
-        glyph = get_glyph(font, *s);
+        glyph_t glyph = get_glyph_at(text->glyphs[i].data, text->font_height);
 
-        // render the glyph, reduce the buffer to only the section to draw into,
         // y coordinate is adjusted to be height within the glyph
-        draw_glyph(row, x, &glyph, row.y - obj->y, obj->yuv444);
-        x += glyph.width + glyph_gap_width;
-    }
-}
-
-#if 0 // TODO: implement
-static inline int16_t intersect_ellipsis(int16_t y,
-        int16_t obj_x, int16_t obj_y, int16_t obj_width, int16_t obj_height, bool flip)
-{
-    // |     Intersection with this slice
-    // |     that we want to compute.
-    // |      : 
-    // +--.._ :              Slice of the screen that
-    // y======a===========   we are rendering at this
-    // |     /: '.           step
-    // |    / :   '.
-    // |  r/  :     '.       [c,x] or [y,a] is seg_width
-    // |  /   :      '.      [c,a] is the radius
-    // | /    :       '.     [c,y] is slice_y which we deduce
-    // |/     :        :
-    // c------x--------+---
-    //
-    // We know the radius and 
-    int16_t radius = obj->width / 2;
-    int16_t slice_y = obj->y + obj->height / 2 - y;
-    int16_t ;
+        draw_glyph(row, obj->x + text->glyphs[i].x, &glyph, y0, OBJ_YUV444(obj));
+    }
+}
+
+static uint32_t isqrt(uint32_t n)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > n)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (n >= root + bit)
+        {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * Get the span [beg,end) of the ellipse inscribed in a width x height box,
+ * on the row y within that box. This is computed in half pixels, so that
+ * the row is sampled at its center: the span is w * sqrt(h^2 - dy^2) / h.
+ */
+static bool ellipse_span(int16_t y, int16_t width, int16_t height, int16_t *beg, int16_t *end)
+{
+    if (y < 0 || y >= height || width <= 0)
+    {
+        return false;
+    }
+
+    int32_t dy = 2 * y + 1 - height;
+    int32_t span = (int32_t)width * isqrt((uint32_t)height * height - dy * dy) / height;
+
+    *beg = (width - span) / 2;
+    *end = (width + span) / 2;
+    return true;
 }
-#endif
 
 static void render_ellipsis(row_t row, obj_t *obj)
 {
+    int16_t y = row.y - obj->y;
+    int16_t beg, end, inner_beg, inner_end;
+
+    if (!ellipse_span(y, obj->width, obj->height, &beg, &end))
+    {
+        return;
+    }
+
+    // The outline is what is left outside of a smaller ellipse
+    if (obj->arg.u32 == 0 &&
+        ellipse_span(y - LINE_THICKNESS,
+                     obj->width - 2 * LINE_THICKNESS,
+                     obj->height - 2 * LINE_THICKNESS,
+                     &inner_beg, &inner_end))
+    {
+        draw_segment(row, obj->x + beg, obj->x + LINE_THICKNESS + inner_beg, OBJ_YUV444(obj));
+        draw_segment(row, obj->x + LINE_THICKNESS + inner_end, obj->x + end, OBJ_YUV444(obj));
+        return;
+    }
+
+    draw_segment(row, obj->x + beg, obj->x + end, OBJ_YUV444(obj));
+}
+
+static void render_frame(row_t row, obj_t *obj)
+{
+    int16_t y = row.y - obj->y;
+    int16_t thickness = MIN(LINE_THICKNESS, obj->width);
+
+    if (y < 0 || y >= obj->height)
+    {
+        return;
+    }
+
+    // Top and bottom edges are full spans, the sides are two short ones
+    if (y < LINE_THICKNESS || y >= obj->height - LINE_THICKNESS)
+    {
+        draw_segment(row, obj->x, obj->x + obj->width, OBJ_YUV444(obj));
+        return;
+    }
+
+    draw_segment(row, obj->x, obj->x + thickness, OBJ_YUV444(obj));
+    draw_segment(row, obj->x + obj->width - thickness, obj->x + obj->width, OBJ_YUV444(obj));
+}
+
+/**
+ * Polygons are stored as an edge table built once: each edge covers the
+ * rows y_top <= y < y_bottom, and its x on a row is one multiply away.
+ * Rows are filled with the even-odd rule between sorted intersections.
+ */
+#define POLY_MAX_VERTICES 64
+
+typedef struct
+{
+    int16_t y_top, y_bottom;
+    int32_t x_top; // 16.16 fixed point, at the center of the row y_top
+    int32_t slope; // 16.16 fixed point, x step for each row
+} poly_edge_t;
+
+typedef struct
+{
+    uint16_t edge_num;
+    poly_edge_t edges[];
+} poly_t;
+
+static void render_polygon(row_t row, obj_t *obj)
+{
+    poly_t const *poly = obj->arg.ptr;
+    int16_t xs[POLY_MAX_VERTICES];
+    size_t xs_num = 0;
+
+    for (size_t i = 0; i < poly->edge_num; i++)
+    {
+        poly_edge_t const *edge = &poly->edges[i];
+
+        if (row.y < edge->y_top || row.y >= edge->y_bottom)
+        {
+            continue;
+        }
+
+        int32_t x = edge->x_top + (row.y - edge->y_top) * edge->slope;
+        int16_t xr = (x + (1 << 15)) >> 16;
+
+        // Insertion sort, there are only a few intersections on a row
+        size_t pos = xs_num++;
+        while (pos > 0 && xs[pos - 1] > xr)
+        {
+            xs[pos] = xs[pos - 1];
+            pos--;
+        }
+        xs[pos] = xr;
+    }
+
+    for (size_t i = 0; i + 1 < xs_num; i += 2)
+    {
+        draw_segment(row, xs[i], xs[i + 1], OBJ_YUV444(obj));
+    }
+}
+
+/**
+ * Bitmaps are read from their source buffer as rows get rendered, and
+ * converted right into the row buffer. MONO is 1 bit per pixel, most
+ * significant bit first, set bits are drawn and clear ones transparent.
+ * INDEXED4 is 4 bits per pixel, high nibble first, into a palette of up
+ * to 16 colors. YUV422 is in the FPGA's own U Y V Y order.
+ */
+enum
+{
+    BITMAP_MONO = 1,
+    BITMAP_INDEXED4 = 4,
+    BITMAP_YUV422 = 16,
+};
+
+typedef struct
+{
+    mp_obj_t buffer;
+    uint8_t const *data;
+    size_t stride;
+    uint8_t format;
+    uint8_t colors[16][3];
+} bitmap_t;
+
+static inline uint8_t get_bitmap_index(uint8_t const *src, int16_t x)
+{
+    return (x % 2 == 0) ? src[x / 2] >> 4 : src[x / 2] & 0x0F;
+}
+
+RAMFUNC static void render_bitmap(row_t row, obj_t *obj)
+{
+    bitmap_t const *bitmap = obj->arg.ptr;
+    int16_t y = row.y - obj->y;
+
+    if (y < 0 || y >= obj->height)
+    {
+        return;
+    }
+
+    uint8_t const *src = bitmap->data + y * bitmap->stride;
+
+    switch (bitmap->format)
+    {
+    case BITMAP_MONO:
+    {
+        // Draw each run of set bits at once, as for glyphs
+        for (int16_t x = 0; x < obj->width;)
+        {
+            if ((src[x / 8] & 0x80 >> (x % 8)) == 0)
+            {
+                x++;
+                continue;
+            }
+
+            int16_t beg = x;
+            while (x < obj->width && (src[x / 8] & 0x80 >> (x % 8)))
+            {
+                x++;
+            }
+            draw_segment(row, obj->x + beg, obj->x + x, OBJ_YUV444(obj));
+        }
+        break;
+    }
+    case BITMAP_INDEXED4:
+    {
+        for (int16_t x = 0; x < obj->width;)
+        {
+            uint8_t index = get_bitmap_index(src, x);
+            int16_t beg = x;
+
+            while (x < obj->width && get_bitmap_index(src, x) == index)
+            {
+                x++;
+            }
+            draw_segment(row, obj->x + beg, obj->x + x,
+                         bitmap->colors[index]);
+        }
+        break;
+    }
+    case BITMAP_YUV422:
+    {
+        int16_t len = row.len / 2;
+
+        for (int16_t x = 0; x < obj->width; x++)
+        {
+            // TODO this flips the screen horizontally on purpose
+            int16_t p = len - (obj->x + x);
+
+            if (p < 0 || p >= len)
+            {
+                continue;
+            }
+
+            // Each pixel takes the luma of its own and the chroma of its
+            // destination, as the flip can change which of U or V that is
+            row.buf[p * 2 + 0] = src[(x & ~1) * 2 + (p % 2) * 2];
+            row.buf[p * 2 + 1] = src[x * 2 + 1];
+        }
+        break;
+    }
+    }
 }
 
 void fill_black(row_t row)
 {
-    uint8_t black[] = YUV422_BLACK;
+    uint8_t black[] = {0x00, 0x80, 0x80};
+    uint32_t pair = pack_yuv422(black);
+    uint32_t *word = (uint32_t *)row.buf;
 
-    for (size_t i = 0; i + 1 < row.len; i += 2)
+    assert(row.len % sizeof pair == 0);
+
+    for (size_t i = 0; i < row.len / sizeof pair; i++)
     {
-        memcpy(row.buf + i, black, sizeof black);
+        word[i] = pair;
     }
 }
 
-bool render_row(row_t row, obj_t *obj_list, size_t obj_num)
+RAMFUNC bool render_row(row_t row, obj_t *obj_list, uint16_t const *active, size_t active_num)
 {
     bool drawn = false;
 
-    for (size_t i = 0; i < obj_num; i++)
+    for (size_t i = 0; i < active_num; i++)
     {
-        obj_t *obj = obj_list + i;
+        obj_t *obj = obj_list + active[i];
 
         // skip the object if it is not on the row we render.
         if (row.y < obj->y || row.y > obj->y + obj->height)
@@ -371,6 +907,21 @@ bool render_row(row_t row, obj_t *obj_list, size_t obj_num)
             render_ellipsis(row, obj);
             break;
         }
+        case OBJ_FRAME:
+        {
+            render_frame(row, obj);
+            break;
+        }
+        case OBJ_POLYGON:
+        {
+            render_polygon(row, obj);
+            break;
+        }
+        case OBJ_BITMAP:
+        {
+            render_bitmap(row, obj);
+            break;
+        }
         default:
         {
             assert(!"unknown type");
@@ -380,7 +931,7 @@ bool render_row(row_t row, obj_t *obj_list, size_t obj_num)
     return drawn;
 }
 
-STATIC void flush_blocks(row_t yuv422, size_t pos, size_t len)
+RAMFUNC STATIC void flush_blocks(row_t yuv422, size_t pos, size_t len)
 {
     assert(pos + len <= yuv422.len);
 
@@ -397,29 +948,19 @@ STATIC void flush_blocks(row_t yuv422, size_t pos, size_t len)
     assert(u32 < DISPLAY_WIDTH * DISPLAY_HEIGHT * 2);
     uint8_t base[sizeof u32] = {u32 >> 24, u32 >> 16, u32 >> 8, u32 >> 0};
 
+    // Commands are short enough to be copied into the SPI queue
     uint8_t base_addr_command[2] = {0x44, 0x10};
-    monocle_spi_write(FPGA, base_addr_command, 2, true);
-    monocle_spi_write(FPGA, base, sizeof(base), false);
+    monocle_spi_write_async(FPGA, base_addr_command, 2, true);
+    monocle_spi_write_async(FPGA, base, sizeof(base), false);
 
     // Flush the content of the screen skipping empty bytes.
     uint8_t data_command[2] = {0x44, 0x11};
-    monocle_spi_write(FPGA, data_command, 2, true);
+    monocle_spi_write_async(FPGA, data_command, 2, true);
 
-    uint8_t chunks = (uint8_t)ceil((double)len / (double)255);
-    for (uint8_t chunk = 0; chunk < chunks; chunk++)
-    {
-        size_t chunk_size = 255;
-        bool cs_hold = true;
-
-        // The last chunk will be smaller
-        if (chunk == chunks - 1)
-        {
-            chunk_size = 255 - ((chunks * 255) - len);
-            cs_hold = false;
-        }
-
-        monocle_spi_write(FPGA, yuv422.buf + pos + (chunk * 255), chunk_size, cs_hold);
-    }
+    // The data goes out in the background while the next row is rendered
+    monocle_spi_write_async(FPGA, yuv422.buf + pos, len, false);
+    row_sent[yuv422.buf == row_buf[1]] = monocle_spi_last_submitted();
+    show_stats.bytes_sent += len;
 }
 
 STATIC bool block_has_content(row_t yuv422, size_t pos)
@@ -475,56 +1016,518 @@ STATIC void flush_row(row_t yuv422)
     }
 }
 
-STATIC mp_obj_t display_show(void)
+static uint32_t hash_bytes(uint32_t hash, void const *data, size_t len)
+{
+    uint8_t const *bytes = data;
+
+    // FNV-1a
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619;
+    }
+    return hash;
+}
+
+static uint32_t hash_obj(obj_t *obj)
+{
+    uint32_t hash = 2166136261;
+
+    hash = hash_bytes(hash, &obj->x, sizeof obj->x);
+    hash = hash_bytes(hash, &obj->y, sizeof obj->y);
+    hash = hash_bytes(hash, &obj->width, sizeof obj->width);
+    hash = hash_bytes(hash, &obj->height, sizeof obj->height);
+    hash = hash_bytes(hash, OBJ_YUV444(obj), sizeof OBJ_YUV444(obj));
+    hash = hash_bytes(hash, &obj->type, sizeof obj->type);
+
+    // Text is compared by its layout, as the object may be a new one
+    if (obj->type == OBJ_TEXT)
+    {
+        display_text_obj_t const *text = obj->arg.ptr;
+        size_t glyph_num = text->line_start[text->line_num];
+
+        hash = hash_bytes(hash, text->line_start,
+                          (text->line_num + 1) * sizeof *text->line_start);
+        return hash_bytes(hash, text->glyphs, glyph_num * sizeof *text->glyphs);
+    }
+
+    if (obj->type == OBJ_BITMAP)
+    {
+        bitmap_t const *bitmap = obj->arg.ptr;
+
+        for (size_t i = 0; i < LEN(bitmap->colors); i++)
+        {
+            hash = hash_bytes(hash, bitmap->colors[i], 3);
+        }
+        return hash_bytes(hash, bitmap->data, bitmap->stride * obj->height);
+    }
+
+    if (obj->type == OBJ_POLYGON)
+    {
+        poly_t const *poly = obj->arg.ptr;
+
+        return hash_bytes(hash, poly->edges, poly->edge_num * sizeof *poly->edges);
+    }
+    return hash_bytes(hash, &obj->arg.u32, sizeof obj->arg.u32);
+}
+
+/**
+ * Mix every object into the hash of each tile it covers. Objects are mixed
+ * in order, so that a change of stacking order is also a change of tile.
+ */
+static void hash_tiles(tile_hash_t tiles)
 {
-    uint8_t buf[DISPLAY_WIDTH * 2];
-    uint8_t buf2[1 << 15];
-    memset(buf2, 0, sizeof buf2);
-    row_t yuv422 = {.buf = buf, .len = sizeof buf, .y = 0};
+    memset(tiles, 0, sizeof(tile_hash_t));
+
+    for (size_t i = 0; i < obj_num; i++)
+    {
+        obj_t *obj = obj_list + i;
+        uint32_t hash = hash_obj(obj);
+
+        // Lines can spill their thickness outside of their bounding box
+        int16_t y0 = MAX(obj->y - LINE_THICKNESS, 0);
+        int16_t y1 = MIN(obj->y + obj->height + LINE_THICKNESS, DISPLAY_HEIGHT - 1);
+        int16_t x0 = MAX(obj->x - LINE_THICKNESS, 0);
+        int16_t x1 = MIN(obj->x + obj->width + LINE_THICKNESS, DISPLAY_WIDTH);
+
+        if (y0 > y1 || x0 > x1)
+        {
+            continue;
+        }
+
+        // The screen is flipped horizontally, see draw_pixel()
+        int16_t c0 = (DISPLAY_WIDTH - x1) * 2 / FPGA_ADDR_ALIGN;
+        int16_t c1 = MIN((DISPLAY_WIDTH - x0) * 2 / FPGA_ADDR_ALIGN, TILE_COLUMNS - 1);
+
+        for (int16_t r = y0 / TILE_HEIGHT; r <= y1 / TILE_HEIGHT; r++)
+        {
+            for (int16_t c = c0; c <= c1; c++)
+            {
+                tiles[r][c] = tiles[r][c] * 31 + hash;
+            }
+        }
+    }
+}
+
+STATIC mp_obj_t display_retained(mp_obj_t enable)
+{
+    retained_mode = mp_obj_is_true(enable);
+
+    // The FPGA buffers have to be redrawn fully before they can be trusted
+    retained_frames = 0;
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(display_retained_obj, display_retained);
+
+/**
+ * Counting sort of the objects by their first visible row. The sort is
+ * stable, so objects starting on the same row stay in drawing order.
+ */
+static void index_objects(size_t num)
+{
+    memset(row_start, 0, sizeof arena.row_start);
+
+    // Objects starting below the screen are never drawn
+    for (size_t i = 0; i < num; i++)
+    {
+        int16_t y = MAX(obj_list[i].y, 0);
+
+        if (y < DISPLAY_HEIGHT)
+        {
+            row_start[y]++;
+        }
+    }
+
+    // Each entry now points after the end of its row's objects
+    for (size_t y = 1; y <= DISPLAY_HEIGHT; y++)
+    {
+        row_start[y] += row_start[y - 1];
+    }
+
+    // Fill backwards, leaving each entry pointing at the start of its row
+    for (size_t i = num; i-- > 0;)
+    {
+        int16_t y = MAX(obj_list[i].y, 0);
+
+        if (y < DISPLAY_HEIGHT)
+        {
+            obj_by_row[--row_start[y]] = i;
+        }
+    }
+}
+
+/**
+ * Update the active set for the row y: drop the objects which ended on the
+ * previous row, and add those starting here, keeping the drawing order.
+ */
+static size_t update_active(int16_t y, size_t active_num)
+{
+    size_t kept = 0;
+
+    for (size_t i = 0; i < active_num; i++)
+    {
+        obj_t *obj = obj_list + obj_active[i];
+
+        if (y <= obj->y + obj->height)
+        {
+            obj_active[kept++] = obj_active[i];
+        }
+    }
+    active_num = kept;
+
+    for (size_t i = row_start[y]; i < row_start[y + 1]; i++)
+    {
+        uint16_t index = obj_by_row[i];
+        obj_t *obj = obj_list + index;
+
+        if (y > obj->y + obj->height)
+        {
+            continue;
+        }
+
+        // Insert sorted by index, which is the drawing order
+        size_t pos = active_num;
+        while (pos > 0 && obj_active[pos - 1] > index)
+        {
+            obj_active[pos] = obj_active[pos - 1];
+            pos--;
+        }
+        obj_active[pos] = index;
+        active_num++;
+    }
+
+    return active_num;
+}
+
+/**
+ * Convert an object to the primitive a graphics backend understands.
+ * Text, polygons and bitmaps are only drawn by the CPU.
+ */
+static bool get_primitive(obj_t *obj, display_primitive_t *primitive)
+{
+    static const int8_t shapes[] = {
+        [OBJ_NULL] = -1,
+        [OBJ_RECTANGLE] = DISPLAY_SHAPE_RECTANGLE,
+        [OBJ_LINE] = DISPLAY_SHAPE_LINE,
+        [OBJ_ELLIPSIS] = DISPLAY_SHAPE_ELLIPSE,
+        [OBJ_TEXT] = -1,
+        [OBJ_FRAME] = DISPLAY_SHAPE_FRAME,
+        [OBJ_POLYGON] = -1,
+        [OBJ_BITMAP] = -1,
+    };
+
+    if (obj->type >= LEN(shapes) || shapes[obj->type] < 0)
+    {
+        return false;
+    }
+
+    primitive->shape = shapes[obj->type];
+    primitive->x = obj->x;
+    primitive->y = obj->y;
+    primitive->width = obj->width;
+    primitive->height = obj->height;
+    primitive->flag = obj->arg.u32 != 0;
+    memcpy(primitive->yuv444, OBJ_YUV444(obj), sizeof primitive->yuv444);
+    return true;
+}
+
+static bool offload_frame(display_backend_t const *backend)
+{
+    display_primitive_t primitive;
+
+    if (!backend->available())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < obj_num; i++)
+    {
+        if (!get_primitive(&obj_list[i], &primitive) || !backend->accepts(&primitive))
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < obj_num; i++)
+    {
+        get_primitive(&obj_list[i], &primitive);
+        backend->draw(&primitive);
+    }
+    return true;
+}
+
+STATIC void display_show_frame(bool wait)
+{
+    row_t yuv422 = {.buf = row_buf[0], .len = ROW_SIZE, .y = 0};
+    uint32_t show_start;
+    uint32_t start;
+
+    monocle_cycles_enable();
+    memset(&show_stats, 0, sizeof show_stats);
+    show_stats.objects = obj_num;
+    show_start = monocle_cycles_now();
+    TRACE(TRACE_SHOW_START, 0);
 
     // fill the display with YUV422 black pixels
     uint8_t enable_command[2] = {0x44, 0x05};
     monocle_spi_write(FPGA, enable_command, 2, false);
 
-    uint8_t clear_command[2] = {0x44, 0x06};
-    monocle_spi_write(FPGA, clear_command, 2, false);
-    nrfx_systick_delay_ms(30);
+    // Both buffers must have been drawn in retained mode to update in place
+    bool partial = retained_mode && retained_frames >= 2;
+
+    if (retained_mode)
+    {
+        hash_tiles(new_hash);
+    }
+
+    if (!partial)
+    {
+        uint8_t clear_command[2] = {0x44, 0x06};
+        monocle_fpga_irq_clear();
+        monocle_spi_write(FPGA, clear_command, 2, false);
+
+        // Returns as soon as the FPGA is done, 30ms is the worst case
+        start = monocle_cycles_now();
+        monocle_fpga_irq_wait(30);
+        show_stats.clear_cycles = monocle_cycles_now() - start;
+    }
 
     // Walk through every line of the display, render it, send it to the FPGA.
+    // If the FPGA can rasterize the whole frame itself, it has no objects
+    // left for the CPU. Retained mode tracks CPU rendered tiles only.
+    size_t active_num = 0;
+    bool offloaded = !retained_mode && offload_frame(&display_fpga_backend);
+
+    index_objects(offloaded ? 0 : obj_num);
+
     for (; yuv422.y < DISPLAY_HEIGHT; yuv422.y++)
     {
+        active_num = update_active(yuv422.y, active_num);
+
+        // Rows without any object stay black
+        if (active_num == 0 && !partial)
+        {
+            continue;
+        }
+
+        bool dirty[TILE_COLUMNS];
+        bool any_dirty = false;
+
+        if (partial)
+        {
+            size_t r = yuv422.y / TILE_HEIGHT;
+
+            for (size_t c = 0; c < TILE_COLUMNS; c++)
+            {
+                dirty[c] = new_hash[r][c] != back_hash[r][c];
+                any_dirty |= dirty[c];
+            }
+
+            // Nothing has changed in this band since the back buffer was drawn
+            if (!any_dirty)
+            {
+                continue;
+            }
+        }
+
+        // Alternate buffers, and wait for the last transfer out of this one,
+        // as the queue may still hold it behind the other buffer's
+        yuv422.buf = row_buf[yuv422.y % 2];
+        monocle_spi_wait_for(row_sent[yuv422.y % 2]);
+
         // Clean the row before writing to it
+        start = monocle_cycles_now();
+        TRACE(TRACE_ROW_RENDER_START, 0);
         fill_black(yuv422);
 
         // Render a single row, and if anything was updated, also flush it
-        if (render_row(yuv422, obj_list, obj_num))
+        bool drawn = render_row(yuv422, obj_list, obj_active, active_num);
+        TRACE(TRACE_ROW_RENDER_END, 0);
+        show_stats.render_cycles += monocle_cycles_now() - start;
+
+        start = monocle_cycles_now();
+        TRACE(TRACE_ROW_FLUSH_START, 0);
+
+        if (!partial)
         {
-            flush_row(yuv422);
+            if (drawn)
+            {
+                flush_row(yuv422);
+                show_stats.rows_flushed++;
+            }
+            TRACE(TRACE_ROW_FLUSH_END, 0);
+            show_stats.flush_cycles += monocle_cycles_now() - start;
+            continue;
         }
+
+        show_stats.rows_flushed++;
+
+        // Without a clear, changed blocks are sent even if they are now black
+        for (size_t c = 0; c < TILE_COLUMNS;)
+        {
+            if (!dirty[c])
+            {
+                c++;
+                continue;
+            }
+
+            size_t beg = c;
+            while (c < TILE_COLUMNS && dirty[c])
+            {
+                c++;
+            }
+
+            flush_blocks(yuv422,
+                         beg * FPGA_ADDR_ALIGN,
+                         (c - beg) * FPGA_ADDR_ALIGN);
+        }
+        TRACE(TRACE_ROW_FLUSH_END, 0);
+        show_stats.flush_cycles += monocle_cycles_now() - start;
     }
 
     // The framebuffer we wrote to is ready, now we can display it.
+    // This also waits for the last row to be sent.
+    start = monocle_cycles_now();
     uint8_t buffer_swap_command[2] = {0x44, 0x07};
-    monocle_spi_write(FPGA, buffer_swap_command, 2, false);
+    if (wait)
+    {
+        monocle_spi_write(FPGA, buffer_swap_command, 2, false);
+    }
+    else
+    {
+        monocle_spi_write_async(FPGA, buffer_swap_command, 2, false);
+    }
+    show_stats.flush_cycles += monocle_cycles_now() - start;
+
+    // The boot timeline ends with the first frame on screen
+    static bool first_frame_shown = false;
+    if (!first_frame_shown)
+    {
+        monocle_boot_mark("first_frame");
+        first_frame_shown = true;
+    }
+
+    // After the swap, the back buffer holds what was on screen until now
+    if (retained_mode)
+    {
+        memcpy(back_hash, front_hash, sizeof(tile_hash_t));
+        memcpy(front_hash, new_hash, sizeof(tile_hash_t));
+        retained_frames = MIN(retained_frames + 1, 2);
+    }
 
-    // Empty the list of elements to draw.
-    memset(obj_list, 0, sizeof obj_list);
+    // Empty the list of elements to draw, the slots are overwritten when reused.
     obj_num = 0;
+    MP_STATE_PORT(display_pinned) = MP_OBJ_NULL;
+
+    show_stats.show_cycles = monocle_cycles_now() - show_start;
+    TRACE(TRACE_SHOW_END, 0);
+}
+
+STATIC mp_obj_t display_show(void)
+{
+    display_show_frame(true);
 
     return mp_const_none;
 }
 MP_DEFINE_CONST_FUN_OBJ_0(display_show_obj, &display_show);
 
+STATIC mp_obj_t display_show_async_result(void)
+{
+    return mp_const_none;
+}
+
+STATIC const awaitable_obj_t display_show_awaitable = {
+    {&awaitable_type},
+    monocle_spi_idle,
+    display_show_async_result,
+};
+
+// Rendering still runs at once, but the tail of the frame and the buffer
+// swap are left to the DMA while other tasks run
+STATIC mp_obj_t display_show_async(void)
+{
+    display_show_frame(false);
+
+    return MP_OBJ_FROM_PTR(&display_show_awaitable);
+}
+MP_DEFINE_CONST_FUN_OBJ_0(display_show_async_obj, &display_show_async);
+
+STATIC mp_obj_t display_stats(void)
+{
+    // Cycles are reported in microseconds at the 64MHz core clock
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    mp_obj_t dict = mp_obj_new_dict(0);
+
+    mp_obj_dict_store(dict, MP_ROM_QSTR(MP_QSTR_show_us),
+                      mp_obj_new_int_from_uint(show_stats.show_cycles / cycles_per_us));
+    mp_obj_dict_store(dict, MP_ROM_QSTR(MP_QSTR_clear_us),
+                      mp_obj_new_int_from_uint(show_stats.clear_cycles / cycles_per_us));
+    mp_obj_dict_store(dict, MP_ROM_QSTR(MP_QSTR_render_us),
+                      mp_obj_new_int_from_uint(show_stats.render_cycles / cycles_per_us));
+    mp_obj_dict_store(dict, MP_ROM_QSTR(MP_QSTR_flush_us),
+                      mp_obj_new_int_from_uint(show_stats.flush_cycles / cycles_per_us));
+    mp_obj_dict_store(dict, MP_ROM_QSTR(MP_QSTR_rows_flushed),
+                      mp_obj_new_int_from_uint(show_stats.rows_flushed));
+    mp_obj_dict_store(dict, MP_ROM_QSTR(MP_QSTR_bytes_sent),
+                      mp_obj_new_int_from_uint(show_stats.bytes_sent));
+    mp_obj_dict_store(dict, MP_ROM_QSTR(MP_QSTR_objects),
+                      mp_obj_new_int_from_uint(show_stats.objects));
+
+    return dict;
+}
+MP_DEFINE_CONST_FUN_OBJ_0(display_stats_obj, &display_stats);
+
+/**
+ * Fixed-point BT.601 full range conversion, with weights scaled by 256.
+ */
+static void rgb_to_yuv444(uint32_t rgb, uint8_t yuv444[3])
+{
+    int32_t r = (rgb >> 16) & 0xFF;
+    int32_t g = (rgb >> 8) & 0xFF;
+    int32_t b = (rgb >> 0) & 0xFF;
+
+    yuv444[0] = (77 * r + 150 * g + 29 * b + 128) >> 8;
+    // No rounding on the chroma so that it stays within 0 to 255
+    yuv444[1] = 128 + ((-43 * r - 85 * g + 128 * b) >> 8);
+    yuv444[2] = 128 + ((128 * r - 107 * g - 21 * b) >> 8);
+}
+
+static uint8_t const *palette_get(uint32_t rgb)
+{
+    // Draw calls tend to come in runs of the same colour
+    if (palette_num > 0 && palette[palette_last].rgb == rgb)
+    {
+        return palette[palette_last].yuv444;
+    }
+
+    for (size_t i = 0; i < palette_num; i++)
+    {
+        if (palette[i].rgb == rgb)
+        {
+            palette_last = i;
+            return palette[i].yuv444;
+        }
+    }
+
+    // Objects hold their own copy, so once full the oldest entry is reused
+    if (palette_num < PALETTE_SIZE)
+    {
+        palette_last = palette_num++;
+    }
+    else
+    {
+        palette_last = palette_next;
+        palette_next = (palette_next + 1) % PALETTE_SIZE;
+    }
+
+    palette[palette_last].rgb = rgb;
+    rgb_to_yuv444(rgb, palette[palette_last].yuv444);
+
+    return palette[palette_last].yuv444;
+}
+
 STATIC void new_obj(int type, mp_int_t x, mp_int_t y, mp_int_t width, mp_int_t height, mp_int_t rgb, arg_t arg)
 {
-    uint8_t r = (rgb >> 16) & 0xFF;
-    uint8_t g = (rgb >> 8) & 0xFF;
-    uint8_t b = (rgb >> 0) & 0xFF;
-    uint8_t yuv444[3] = {
-        (uint8_t)(128.0 + 0.29900 * (r) + 0.58700 * (g) + 0.11400 * (b)-128.0),
-        (uint8_t)(128.0 - 0.16874 * (r)-0.33126 * (g) + 0.50000 * (b)),
-        (uint8_t)(128.0 + 0.50000 * (r)-0.41869 * (g)-0.08131 * (b)),
-    };
     obj_t *gfx;
 
     assert(width >= 0);
@@ -536,14 +1539,16 @@ STATIC void new_obj(int type, mp_int_t x, mp_int_t y, mp_int_t width, mp_int_t h
     }
 
     // Get the latest free slot
-    if (obj_num >= LEN(obj_list))
+    if (obj_num >= OBJ_MAX)
     {
         mp_raise_OSError(MP_ENOMEM);
     }
+    uint8_t const *yuv444 = palette_get(rgb);
     gfx = obj_list + obj_num;
 
     // This is the only place where we increment this number.
     obj_num++;
+    obj_peak = MAX(obj_peak, obj_num);
 
     // Fill the new slot.
     gfx->type = type;
@@ -551,7 +1556,7 @@ STATIC void new_obj(int type, mp_int_t x, mp_int_t y, mp_int_t width, mp_int_t h
     gfx->y = y;
     gfx->width = width;
     gfx->height = height;
-    memcpy(gfx->yuv444, yuv444, sizeof yuv444);
+    memcpy(gfx->yuv444, yuv444, sizeof gfx->yuv444);
     gfx->arg = arg;
 }
 
@@ -582,19 +1587,127 @@ STATIC mp_obj_t display_line(size_t argc, mp_obj_t const args[])
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(display_line_obj, 5, 5, display_line);
 
+STATIC mp_obj_t display_text_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args)
+{
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_string, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_x, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0}},
+        {MP_QSTR_y, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0}},
+        {MP_QSTR_color, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0}},
+        {MP_QSTR_width, MP_ARG_INT, {.u_int = 0}},
+        {MP_QSTR_font, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0}},
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    size_t len;
+    char const *s;
+
+    // Buffers are laid out too, such as one refilled by time.clock()
+    if (mp_obj_is_str_or_bytes(args[0].u_obj))
+    {
+        s = mp_obj_str_get_data(args[0].u_obj, &len);
+    }
+    else
+    {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[0].u_obj, &bufinfo, MP_BUFFER_READ);
+        s = bufinfo.buf;
+        len = bufinfo.len;
+    }
+
+    if (len > UINT16_MAX)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("text is too long"));
+    }
+
+    if (args[4].u_int < 0 || args[4].u_int > INT16_MAX)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("width must be positive"));
+    }
+
+    // Zero, or the height of the built-in font, needs no font store lookup
+    fontstore_font_t store_font;
+    bool from_store = args[5].u_int != 0 && args[5].u_int != font[0];
+
+    if (from_store &&
+        (args[5].u_int < 0 || args[5].u_int > UINT8_MAX ||
+         !fontstore_find(args[5].u_int, &store_font)))
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("font not found"));
+    }
+
+    display_text_obj_t *self = mp_obj_malloc(display_text_obj_t, &display_text_type);
+    self->string = args[0].u_obj;
+    self->x = args[1].u_int;
+    self->y = args[2].u_int;
+    self->rgb = args[3].u_int;
+    text_layout(self, s, len, args[4].u_int, from_store ? &store_font : NULL);
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+STATIC void display_text_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind)
+{
+    display_text_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "Text(");
+    mp_obj_print_helper(print, self->string, PRINT_REPR);
+    mp_printf(print, ", x=%d, y=%d, width=%d, height=%d)",
+              self->x, self->y, self->width, self->height);
+}
+
+STATIC void display_text_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest)
+{
+    display_text_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Only the measured size is exposed, and it is read-only
+    if (dest[0] != MP_OBJ_NULL)
+    {
+        return;
+    }
+
+    if (attr == MP_QSTR_width)
+    {
+        dest[0] = mp_obj_new_int(self->width);
+    }
+    else if (attr == MP_QSTR_height)
+    {
+        dest[0] = mp_obj_new_int(self->height);
+    }
+}
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    display_text_type,
+    MP_QSTR_Text,
+    MP_TYPE_FLAG_NONE,
+    make_new, display_text_make_new,
+    print, display_text_print,
+    attr, display_text_attr);
+
 STATIC mp_obj_t display_text(size_t argc, mp_obj_t const args[])
 {
-    arg_t arg = {.ptr = mp_obj_str_get_str(args[0])};
-    mp_int_t x = mp_obj_get_int(args[1]);
-    mp_int_t y = mp_obj_get_int(args[2]);
-    mp_int_t rgb = mp_obj_get_int(args[3]);
-    mp_int_t width = get_text_width(arg.ptr, strlen(arg.ptr));
-    mp_int_t height = get_text_height();
+    mp_obj_t text = args[0];
+
+    // A Text object is laid out already, otherwise build a throwaway one
+    if (!mp_obj_is_type(text, &display_text_type))
+    {
+        text = display_text_make_new(&display_text_type, argc, 0, args);
+    }
+    else if (argc > 1)
+    {
+        mp_raise_TypeError(MP_ERROR_TEXT("Text objects carry their own position"));
+    }
+
+    display_text_obj_t *self = MP_OBJ_TO_PTR(text);
+    arg_t arg = {.ptr = self};
+
+    new_obj(OBJ_TEXT, self->x, self->y, self->width, self->height, self->rgb, arg);
+
+    pin_obj(self);
 
-    new_obj(OBJ_TEXT, x, y, width, height, rgb, arg);
     return mp_const_none;
 }
-MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(display_text_obj, 4, 4, display_text);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(display_text_obj, 1, 5, display_text);
 
 STATIC mp_obj_t display_fill(mp_obj_t rgb_in)
 {
@@ -634,18 +1747,270 @@ STATIC mp_obj_t display_vline(size_t argc, mp_obj_t const args[])
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(display_vline_obj, 4, 4, display_vline);
 
+STATIC mp_obj_t display_pixel(mp_obj_t x, mp_obj_t y, mp_obj_t rgb)
+{
+    arg_t none = {0};
+
+    // The bottom row is inclusive, so a height of 0 is a single row
+    new_obj(OBJ_RECTANGLE, mp_obj_get_int(x), mp_obj_get_int(y), 1, 0,
+            mp_obj_get_int(rgb), none);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_3(display_pixel_obj, display_pixel);
+
+STATIC mp_obj_t display_rect(size_t argc, mp_obj_t const args[])
+{
+    mp_int_t x = mp_obj_get_int(args[0]);
+    mp_int_t y = mp_obj_get_int(args[1]);
+    mp_int_t width = mp_obj_get_int(args[2]);
+    mp_int_t height = mp_obj_get_int(args[3]);
+    mp_int_t rgb = mp_obj_get_int(args[4]);
+    bool fill = argc > 5 && mp_obj_is_true(args[5]);
+    arg_t none = {0};
+
+    if (width < 0 || height < 0)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("width and height must be positive"));
+    }
+
+    if (height == 0)
+    {
+        return mp_const_none;
+    }
+
+    if (fill)
+    {
+        new_obj(OBJ_RECTANGLE, x, y, width, height - 1, rgb, none);
+    }
+    else
+    {
+        new_obj(OBJ_FRAME, x, y, width, height, rgb, none);
+    }
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(display_rect_obj, 5, 6, display_rect);
+
+STATIC mp_obj_t display_ellipse(size_t argc, mp_obj_t const args[])
+{
+    mp_int_t x = mp_obj_get_int(args[0]);
+    mp_int_t y = mp_obj_get_int(args[1]);
+    mp_int_t x_radius = mp_obj_get_int(args[2]);
+    mp_int_t y_radius = mp_obj_get_int(args[3]);
+    mp_int_t rgb = mp_obj_get_int(args[4]);
+    arg_t fill = {.u32 = argc > 5 && mp_obj_is_true(args[5])};
+
+    if (x_radius < 0 || y_radius < 0 || x_radius > DISPLAY_WIDTH || y_radius > DISPLAY_WIDTH)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("radius must be between 0 and 640"));
+    }
+
+    // Stored as the bounding box, centered on the pixel x,y
+    new_obj(OBJ_ELLIPSIS, x - x_radius, y - y_radius,
+            2 * x_radius + 1, 2 * y_radius + 1, rgb, fill);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(display_ellipse_obj, 5, 6, display_ellipse);
+
+STATIC mp_obj_t display_poly(size_t argc, mp_obj_t const args[])
+{
+    mp_int_t x = mp_obj_get_int(args[0]);
+    mp_int_t y = mp_obj_get_int(args[1]);
+    mp_int_t rgb = mp_obj_get_int(args[3]);
+    size_t len;
+    mp_obj_t *coords;
+
+    // Like framebuf: a flat sequence of x,y offsets from x,y
+    mp_obj_get_array(args[2], &len, &coords);
+
+    if (len % 2 != 0 || len < 6 || len > 2 * POLY_MAX_VERTICES)
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("coords must hold between 3 and " STR(POLY_MAX_VERTICES) " x,y pairs"));
+    }
+
+    size_t vertex_num = len / 2;
+    poly_t *poly = m_malloc(sizeof(poly_t) + vertex_num * sizeof(poly_edge_t));
+    int16_t y_min = INT16_MAX;
+    int16_t y_max = INT16_MIN;
+    int16_t x_min = INT16_MAX;
+    int16_t x_max = INT16_MIN;
+
+    poly->edge_num = 0;
+
+    for (size_t i = 0; i < vertex_num; i++)
+    {
+        size_t j = (i + 1) % vertex_num;
+        int32_t x0 = x + mp_obj_get_int(coords[i * 2]);
+        int32_t y0 = y + mp_obj_get_int(coords[i * 2 + 1]);
+        int32_t x1 = x + mp_obj_get_int(coords[j * 2]);
+        int32_t y1 = y + mp_obj_get_int(coords[j * 2 + 1]);
+
+        x_min = MIN(x_min, x0);
+        x_max = MAX(x_max, x0);
+        y_min = MIN(y_min, y0);
+        y_max = MAX(y_max, y0);
+
+        // Horizontal edges never cross a row center
+        if (y0 == y1)
+        {
+            continue;
+        }
+
+        // Edges always go downwards
+        if (y0 > y1)
+        {
+            int32_t tmp;
+            tmp = x0, x0 = x1, x1 = tmp;
+            tmp = y0, y0 = y1, y1 = tmp;
+        }
+
+        poly_edge_t *edge = &poly->edges[poly->edge_num++];
+        edge->y_top = y0;
+        edge->y_bottom = y1;
+        edge->slope = ((x1 - x0) << 16) / (y1 - y0);
+        edge->x_top = (x0 << 16) + edge->slope / 2;
+    }
+
+    arg_t arg = {.ptr = poly};
+
+    new_obj(OBJ_POLYGON, x_min, y_min, x_max - x_min, y_max - y_min, rgb, arg);
+    pin_obj(poly);
+
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(display_poly_obj, 4, 4, display_poly);
+
+STATIC mp_obj_t display_bitmap(size_t argc, mp_obj_t const args[])
+{
+    mp_int_t x = mp_obj_get_int(args[0]);
+    mp_int_t y = mp_obj_get_int(args[1]);
+    mp_int_t width = mp_obj_get_int(args[2]);
+    mp_int_t height = mp_obj_get_int(args[3]);
+    mp_int_t format = mp_obj_get_int(args[5]);
+    mp_int_t rgb = 0xFFFFFF;
+
+    if (width <= 0 || height <= 0 || width > DISPLAY_WIDTH || height > DISPLAY_HEIGHT)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("bitmap must fit within the display"));
+    }
+
+    bitmap_t *bitmap = m_new_obj(bitmap_t);
+    memset(bitmap->colors, 0, sizeof bitmap->colors);
+    bitmap->buffer = args[4];
+    bitmap->format = format;
+
+    switch (format)
+    {
+    case BITMAP_MONO:
+        bitmap->stride = (width + 7) / 8;
+        if (argc > 6)
+        {
+            rgb = mp_obj_get_int(args[6]);
+        }
+        break;
+
+    case BITMAP_INDEXED4:
+    {
+        size_t colors_len;
+        mp_obj_t *colors;
+
+        if (argc < 7)
+        {
+            mp_raise_TypeError(MP_ERROR_TEXT("INDEXED4 bitmaps need a palette"));
+        }
+
+        mp_obj_get_array(args[6], &colors_len, &colors);
+        if (colors_len == 0 || colors_len > LEN(bitmap->colors))
+        {
+            mp_raise_ValueError(MP_ERROR_TEXT("palette must hold 1 to 16 colors"));
+        }
+
+        bitmap->stride = (width + 1) / 2;
+        for (size_t i = 0; i < colors_len; i++)
+        {
+            memcpy(bitmap->colors[i], palette_get(mp_obj_get_int(colors[i])),
+                   sizeof bitmap->colors[i]);
+        }
+        break;
+    }
+
+    case BITMAP_YUV422:
+        bitmap->stride = (width + 1) / 2 * 4;
+        break;
+
+    default:
+        mp_raise_ValueError(MP_ERROR_TEXT("format must be MONO, INDEXED4 or YUV422"));
+    }
+
+    // Rows are read in place when rendering, the buffer is not copied
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[4], &bufinfo, MP_BUFFER_READ);
+
+    if (bufinfo.len < bitmap->stride * height)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer is too small for the bitmap"));
+    }
+    bitmap->data = bufinfo.buf;
+
+    arg_t arg = {.ptr = bitmap};
+
+    new_obj(OBJ_BITMAP, x, y, width, height, rgb, arg);
+    pin_obj(bitmap);
+
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(display_bitmap_obj, 6, 7, display_bitmap);
+
+STATIC mp_obj_t display_memory(void)
+{
+    // Report the arena size, and the bytes used now and at most so far
+    mp_obj_t tuple[3] = {
+        mp_obj_new_int(DISPLAY_ARENA_SIZE),
+        mp_obj_new_int(ARENA_FIXED_SIZE + obj_num * OBJ_SLOT_SIZE),
+        mp_obj_new_int(ARENA_FIXED_SIZE + obj_peak * OBJ_SLOT_SIZE),
+    };
+
+    return mp_obj_new_tuple(3, tuple);
+}
+MP_DEFINE_CONST_FUN_OBJ_0(display_memory_obj, &display_memory);
+
+STATIC mp_obj_t display_fonts(void)
+{
+    // The built-in font comes first, then the heights in the font store
+    mp_obj_t builtin = MP_OBJ_NEW_SMALL_INT(font[0]);
+    mp_obj_t stored = fontstore_list();
+
+    return mp_binary_op(MP_BINARY_OP_ADD, mp_obj_new_tuple(1, &builtin), stored);
+}
+MP_DEFINE_CONST_FUN_OBJ_0(display_fonts_obj, &display_fonts);
+
 STATIC const mp_rom_map_elem_t display_module_globals_table[] = {
 
     {MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&display_fill_obj)},
     {MP_ROM_QSTR(MP_QSTR_line), MP_ROM_PTR(&display_line_obj)},
     {MP_ROM_QSTR(MP_QSTR_text), MP_ROM_PTR(&display_text_obj)},
+    {MP_ROM_QSTR(MP_QSTR_Text), MP_ROM_PTR(&display_text_type)},
     {MP_ROM_QSTR(MP_QSTR_hline), MP_ROM_PTR(&display_hline_obj)},
     {MP_ROM_QSTR(MP_QSTR_vline), MP_ROM_PTR(&display_vline_obj)},
+    {MP_ROM_QSTR(MP_QSTR_pixel), MP_ROM_PTR(&display_pixel_obj)},
+    {MP_ROM_QSTR(MP_QSTR_rect), MP_ROM_PTR(&display_rect_obj)},
+    {MP_ROM_QSTR(MP_QSTR_ellipse), MP_ROM_PTR(&display_ellipse_obj)},
+    {MP_ROM_QSTR(MP_QSTR_poly), MP_ROM_PTR(&display_poly_obj)},
+    {MP_ROM_QSTR(MP_QSTR_bitmap), MP_ROM_PTR(&display_bitmap_obj)},
     {MP_ROM_QSTR(MP_QSTR_show), MP_ROM_PTR(&display_show_obj)},
+    {MP_ROM_QSTR(MP_QSTR_show_async), MP_ROM_PTR(&display_show_async_obj)},
+    {MP_ROM_QSTR(MP_QSTR_retained), MP_ROM_PTR(&display_retained_obj)},
     {MP_ROM_QSTR(MP_QSTR_brightness), MP_ROM_PTR(&display_brightness_obj)},
+    {MP_ROM_QSTR(MP_QSTR_memory), MP_ROM_PTR(&display_memory_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fonts), MP_ROM_PTR(&display_fonts_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&display_stats_obj)},
 
     {MP_ROM_QSTR(MP_QSTR_WIDTH), MP_OBJ_NEW_SMALL_INT(DISPLAY_WIDTH)},
     {MP_ROM_QSTR(MP_QSTR_HEIGHT), MP_OBJ_NEW_SMALL_INT(DISPLAY_HEIGHT)},
+    {MP_ROM_QSTR(MP_QSTR_PALETTE_SIZE), MP_OBJ_NEW_SMALL_INT(PALETTE_SIZE)},
+    {MP_ROM_QSTR(MP_QSTR_MONO), MP_OBJ_NEW_SMALL_INT(BITMAP_MONO)},
+    {MP_ROM_QSTR(MP_QSTR_INDEXED4), MP_OBJ_NEW_SMALL_INT(BITMAP_INDEXED4)},
+    {MP_ROM_QSTR(MP_QSTR_YUV422), MP_OBJ_NEW_SMALL_INT(BITMAP_YUV422)},
 };
 STATIC MP_DEFINE_CONST_DICT(display_module_globals, display_module_globals_table);
 
@@ -0,0 +1,64 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Shapes that display.show() can hand over to an FPGA graphics
+ *        engine instead of rasterizing them on the CPU.
+ */
+
+typedef enum display_shape_t
+{
+    DISPLAY_SHAPE_RECTANGLE,
+    DISPLAY_SHAPE_FRAME,
+    DISPLAY_SHAPE_LINE,
+    DISPLAY_SHAPE_ELLIPSE,
+} display_shape_t;
+
+typedef struct display_primitive_t
+{
+    display_shape_t shape;
+    int16_t x, y, width, height;
+    bool flag; // Lines: rising from left to right. Ellipses: filled.
+    uint8_t yuv444[3];
+} display_primitive_t;
+
+/**
+ * @brief Only whole frames are offloaded, so that the CPU never has to
+ *        composite over what the engine drew. If accepts() is false for
+ *        any object, the CPU scanline renderer draws the frame instead.
+ */
+
+typedef struct display_backend_t
+{
+    bool (*available)(void);
+    bool (*accepts)(display_primitive_t const *primitive);
+    void (*draw)(display_primitive_t const *primitive);
+} display_backend_t;
+
+extern const display_backend_t display_fpga_backend;
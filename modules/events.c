@@ -0,0 +1,91 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "events.h"
+#include "mphalport.h"
+#include "nrfx_glue.h"
+
+#define EVENTS_RING_SIZE (32)
+
+static event_t events_ring[EVENTS_RING_SIZE];
+static size_t events_head = 0;
+static size_t events_tail = 0;
+static event_stats_t stats;
+
+void events_push(event_type_t type)
+{
+    uint32_t now = mp_hal_ticks_ms();
+
+    // Producers run both from GPIOTE and from the SoftDevice event handler
+    NRFX_CRITICAL_SECTION_ENTER();
+
+    size_t newest = (events_head + EVENTS_RING_SIZE - 1) % EVENTS_RING_SIZE;
+    size_t next = (events_head + 1) % EVENTS_RING_SIZE;
+
+    if (events_head != events_tail && events_ring[newest].type == type)
+    {
+        events_ring[newest].count++;
+        events_ring[newest].last_ms = now;
+        stats.coalesced++;
+    }
+    else if (next == events_tail)
+    {
+        stats.dropped++;
+    }
+    else
+    {
+        events_ring[events_head] = (event_t){type, 1, now, now};
+        events_head = next;
+        stats.queued++;
+    }
+
+    NRFX_CRITICAL_SECTION_EXIT();
+}
+
+size_t events_take(event_t *events, size_t max)
+{
+    size_t taken = 0;
+
+    NRFX_CRITICAL_SECTION_ENTER();
+
+    while (events_tail != events_head && taken < max)
+    {
+        events[taken++] = events_ring[events_tail];
+        events_tail = (events_tail + 1) % EVENTS_RING_SIZE;
+    }
+
+    NRFX_CRITICAL_SECTION_EXIT();
+
+    return taken;
+}
+
+void events_callback_lost(void)
+{
+    stats.callbacks_lost++;
+}
+
+event_stats_t *events_stats(void)
+{
+    return &stats;
+}
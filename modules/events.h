@@ -0,0 +1,69 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Ring of hardware events for Python to drain in batches. Repeats of
+ *        the newest event are coalesced into it, and each entry keeps the
+ *        ticks_ms() of its first and last occurrence.
+ */
+
+typedef enum event_type_t
+{
+    EVENT_TOUCH_A,
+    EVENT_TOUCH_B,
+    EVENT_BLE_CONNECTED,
+    EVENT_BLE_DISCONNECTED,
+    EVENT_BLE_DATA,
+    EVENT_CHARGER,
+    EVENT_THERMAL,
+} event_type_t;
+
+typedef struct event_t
+{
+    event_type_t type;
+    uint32_t count;
+    uint32_t first_ms;
+    uint32_t last_ms;
+} event_t;
+
+typedef struct event_stats_t
+{
+    uint32_t queued;
+    uint32_t coalesced;
+    uint32_t dropped;
+    uint32_t callbacks_lost;
+} event_stats_t;
+
+void events_push(event_type_t type);
+
+size_t events_take(event_t *events, size_t max);
+
+void events_callback_lost(void);
+
+event_stats_t *events_stats(void);
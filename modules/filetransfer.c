@@ -0,0 +1,371 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Binary file transfer over the file characteristics of the data service.
+ *
+ * Every write starts with an opcode, followed by its payload:
+ *   0x01 OPEN   <path>      Open (and truncate) a file for writing
+ *   0x02 WRITE  <data>      Append data to the open file
+ *   0x03 CLOSE  [crc32 LE]  Close the file, checking the CRC if given
+ *   0x04 LIST   <path>      List a directory, one notification per entry
+ *   0x05 DELETE <path>      Remove a file
+ *   0x06 OPEN_Z <path>      Like OPEN, but WRITE data is zlib compressed
+ *
+ * Notifications reply with the opcode, a status, and an optional payload.
+ * WRITE only replies every FILETRANSFER_ACK_INTERVAL bytes, with the total
+ * byte count, so the host can stream writes without a response each time.
+ * Counts and the CRC are of the data as stored, after any decompression.
+ */
+
+#include <string.h>
+#include "filetransfer.h"
+#include "inflate.h"
+#include "mphalport.h"
+#include "lib/uzlib/uzlib.h"
+#include "extmod/vfs.h"
+#include "py/nlr.h"
+#include "py/objlist.h"
+#include "py/runtime.h"
+#include "py/stream.h"
+
+#define FILETRANSFER_ACK_INTERVAL 2048
+#define FILETRANSFER_RING_SIZE 4096
+
+enum filetransfer_opcode_t
+{
+    OPCODE_OPEN = 0x01,
+    OPCODE_WRITE = 0x02,
+    OPCODE_CLOSE = 0x03,
+    OPCODE_LIST = 0x04,
+    OPCODE_DELETE = 0x05,
+    OPCODE_OPEN_COMPRESSED = 0x06,
+};
+
+enum filetransfer_status_t
+{
+    STATUS_OK = 0x00,
+    STATUS_MORE = 0x01,
+    STATUS_ERROR = 0x02,
+    STATUS_CRC_MISMATCH = 0x03,
+    STATUS_OVERFLOW = 0x04,
+    STATUS_NOT_OPEN = 0x05,
+};
+
+// Packets are stored with a two byte length prefix
+static struct filetransfer_ring_t
+{
+    uint8_t buffer[FILETRANSFER_RING_SIZE];
+    volatile size_t head;
+    volatile size_t tail;
+} ring = {
+    .head = 0,
+    .tail = 0,
+};
+
+static volatile bool process_scheduled = false;
+static volatile bool ring_overflowed = false;
+
+static uint32_t file_crc;
+static uint32_t file_length;
+
+// Kept as root pointers so the GC doesn't free them between packets
+MP_REGISTER_ROOT_POINTER(mp_obj_t filetransfer_file);
+MP_REGISTER_ROOT_POINTER(void *filetransfer_inflate);
+
+static size_t ring_used(void)
+{
+    size_t head = ring.head;
+    size_t tail = ring.tail;
+
+    return head >= tail ? head - tail : sizeof(ring.buffer) - tail + head;
+}
+
+static void ring_copy_in(size_t *index, const uint8_t *data, size_t len)
+{
+    size_t first = MIN(len, sizeof(ring.buffer) - *index);
+    memcpy(&ring.buffer[*index], data, first);
+    memcpy(&ring.buffer[0], &data[first], len - first);
+
+    *index = (*index + len) % sizeof(ring.buffer);
+}
+
+static void ring_copy_out(size_t *index, uint8_t *data, size_t len)
+{
+    size_t first = MIN(len, sizeof(ring.buffer) - *index);
+    memcpy(data, &ring.buffer[*index], first);
+    memcpy(&data[first], &ring.buffer[0], len - first);
+
+    *index = (*index + len) % sizeof(ring.buffer);
+}
+
+static void reply(uint8_t opcode, uint8_t status, const void *data, size_t len)
+{
+    // Before an MTU exchange only the default 20 byte payload is allowed
+    uint8_t packet[MAX(ble_get_max_payload_size(), 20)];
+
+    packet[0] = opcode;
+    packet[1] = status;
+    len = MIN(len, sizeof(packet) - 2);
+    memcpy(&packet[2], data, len);
+
+    // Replies are rare, so wait for space in the notification queue
+    while (ble_send_file_data(packet, len + 2))
+    {
+        if (!ble_are_tx_notifications_enabled(FILE_TX))
+        {
+            return;
+        }
+
+        MICROPY_EVENT_POLL_HOOK;
+    }
+}
+
+static void write_file(void *context, const uint8_t *bytes, size_t len)
+{
+    (void)context;
+
+    mp_stream_write(MP_STATE_PORT(filetransfer_file),
+                    bytes,
+                    len,
+                    MP_STREAM_RW_WRITE);
+
+    file_crc = uzlib_crc32(bytes, len, file_crc);
+
+    uint32_t previous = file_length;
+    file_length += len;
+
+    if (previous / FILETRANSFER_ACK_INTERVAL !=
+        file_length / FILETRANSFER_ACK_INTERVAL)
+    {
+        reply(OPCODE_WRITE, STATUS_OK, &file_length, sizeof(file_length));
+    }
+}
+
+static void check_inflate(int status)
+{
+    if (status < 0)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("compressed data is invalid"));
+    }
+}
+
+static void close_file(void)
+{
+    if (MP_STATE_PORT(filetransfer_inflate) != NULL)
+    {
+        m_del_obj(inflate_stream_t, MP_STATE_PORT(filetransfer_inflate));
+        MP_STATE_PORT(filetransfer_inflate) = NULL;
+    }
+
+    if (MP_STATE_PORT(filetransfer_file) != MP_OBJ_NULL)
+    {
+        mp_stream_close(MP_STATE_PORT(filetransfer_file));
+        MP_STATE_PORT(filetransfer_file) = MP_OBJ_NULL;
+    }
+}
+
+static void handle_packet(uint8_t opcode, const uint8_t *payload, size_t len)
+{
+    switch (opcode)
+    {
+    case OPCODE_OPEN:
+    case OPCODE_OPEN_COMPRESSED:
+    {
+        close_file();
+
+        mp_obj_t args[2] = {mp_obj_new_str((const char *)payload, len),
+                            MP_OBJ_NEW_QSTR(MP_QSTR_wb)};
+        mp_map_t kwargs;
+        mp_map_init(&kwargs, 0);
+
+        MP_STATE_PORT(filetransfer_file) = mp_vfs_open(2, args, &kwargs);
+        file_crc = 0xFFFFFFFF;
+        file_length = 0;
+        ring_overflowed = false;
+
+        if (opcode == OPCODE_OPEN_COMPRESSED)
+        {
+            MP_STATE_PORT(filetransfer_inflate) = m_new_obj(inflate_stream_t);
+            inflate_stream_init(MP_STATE_PORT(filetransfer_inflate),
+                                true,
+                                write_file,
+                                NULL);
+        }
+
+        reply(opcode, STATUS_OK, NULL, 0);
+        break;
+    }
+
+    case OPCODE_WRITE:
+    {
+        if (MP_STATE_PORT(filetransfer_file) == MP_OBJ_NULL)
+        {
+            reply(opcode, STATUS_NOT_OPEN, NULL, 0);
+            break;
+        }
+
+        if (MP_STATE_PORT(filetransfer_inflate) != NULL)
+        {
+            check_inflate(inflate_stream_write(MP_STATE_PORT(filetransfer_inflate),
+                                               payload,
+                                               len));
+        }
+        else
+        {
+            write_file(NULL, payload, len);
+        }
+        break;
+    }
+
+    case OPCODE_CLOSE:
+    {
+        if (MP_STATE_PORT(filetransfer_file) == MP_OBJ_NULL)
+        {
+            reply(opcode, STATUS_NOT_OPEN, NULL, 0);
+            break;
+        }
+
+        if (MP_STATE_PORT(filetransfer_inflate) != NULL)
+        {
+            int status = inflate_stream_finish(MP_STATE_PORT(filetransfer_inflate));
+            if (status < 0)
+            {
+                close_file();
+                check_inflate(status);
+            }
+        }
+
+        close_file();
+
+        uint32_t crc = file_crc ^ 0xFFFFFFFF;
+        uint8_t status = STATUS_OK;
+
+        if (ring_overflowed)
+        {
+            status = STATUS_OVERFLOW;
+        }
+        else if (len >= sizeof(crc) && memcmp(payload, &crc, sizeof(crc)))
+        {
+            status = STATUS_CRC_MISMATCH;
+        }
+
+        reply(opcode, status, &crc, sizeof(crc));
+        break;
+    }
+
+    case OPCODE_LIST:
+    {
+        mp_obj_t path = mp_obj_new_str((const char *)payload, len);
+        mp_obj_t list = mp_vfs_listdir(len ? 1 : 0, &path);
+
+        size_t entries_len;
+        mp_obj_t *entries;
+        mp_obj_list_get(list, &entries_len, &entries);
+
+        for (size_t i = 0; i < entries_len; i++)
+        {
+            size_t name_len;
+            const char *name = mp_obj_str_get_data(entries[i], &name_len);
+            reply(opcode, STATUS_MORE, name, name_len);
+        }
+
+        reply(opcode, STATUS_OK, NULL, 0);
+        break;
+    }
+
+    case OPCODE_DELETE:
+    {
+        mp_vfs_remove(mp_obj_new_str((const char *)payload, len));
+        reply(opcode, STATUS_OK, NULL, 0);
+        break;
+    }
+
+    default:
+        reply(opcode, STATUS_ERROR, NULL, 0);
+        break;
+    }
+}
+
+STATIC mp_obj_t filetransfer_process(mp_obj_t unused)
+{
+    (void)unused;
+
+    // Clear first so that packets arriving while we work schedule again
+    process_scheduled = false;
+
+    while (ring_used() > 0)
+    {
+        uint8_t header[2];
+        size_t tail = ring.tail;
+        ring_copy_out(&tail, header, sizeof(header));
+
+        uint16_t len = header[0] | (header[1] << 8);
+        uint8_t packet[len];
+        ring_copy_out(&tail, packet, len);
+        ring.tail = tail;
+
+        if (len == 0)
+        {
+            continue;
+        }
+
+        // Filesystem errors are reported to the host rather than raised
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0)
+        {
+            handle_packet(packet[0], &packet[1], len - 1);
+            nlr_pop();
+        }
+        else
+        {
+            reply(packet[0], STATUS_ERROR, NULL, 0);
+        }
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(filetransfer_process_obj, filetransfer_process);
+
+void filetransfer_receive_handler(const uint8_t *bytes, size_t len)
+{
+    // One slot is kept empty to tell a full ring from an empty one
+    if (sizeof(ring.buffer) - 1 - ring_used() < len + 2)
+    {
+        ring_overflowed = true;
+        return;
+    }
+
+    uint8_t header[2] = {len & 0xFF, len >> 8};
+    size_t head = ring.head;
+    ring_copy_in(&head, header, sizeof(header));
+    ring_copy_in(&head, bytes, len);
+    ring.head = head;
+
+    if (!process_scheduled)
+    {
+        process_scheduled = mp_sched_schedule(MP_OBJ_FROM_PTR(&filetransfer_process_obj),
+                                              mp_const_none);
+    }
+}
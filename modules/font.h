@@ -105,6 +105,104 @@ uint8_t const font_50[] = {
 	/* ~ */ 20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x3F, 0xF0, 0xFC, 0x03, 0xFF, 0xFF, 0xF0, 0xFF, 0x0F, 0xFF, 0xF0, 0xFF, 0x0F, 0xFF, 0xFF, 0xC0, 0x3F, 0x0F, 0xFC, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 };
 
+uint16_t const font_50_index[] = {
+	/*   */ 1,
+	/* ! */ 77,
+	/* " */ 103,
+	/* # */ 179,
+	/* $ */ 305,
+	/* % */ 431,
+	/* & */ 557,
+	/* ' */ 683,
+	/* ( */ 709,
+	/* ) */ 785,
+	/* * */ 861,
+	/* + */ 987,
+	/* , */ 1113,
+	/* - */ 1164,
+	/* . */ 1290,
+	/* / */ 1341,
+	/* 0 */ 1467,
+	/* 1 */ 1593,
+	/* 2 */ 1669,
+	/* 3 */ 1795,
+	/* 4 */ 1921,
+	/* 5 */ 2047,
+	/* 6 */ 2173,
+	/* 7 */ 2299,
+	/* 8 */ 2425,
+	/* 9 */ 2551,
+	/* : */ 2677,
+	/* ; */ 2728,
+	/* < */ 2779,
+	/* = */ 2905,
+	/* > */ 3031,
+	/* ? */ 3157,
+	/* @ */ 3283,
+	/* A */ 3459,
+	/* B */ 3585,
+	/* C */ 3711,
+	/* D */ 3837,
+	/* E */ 3963,
+	/* F */ 4089,
+	/* G */ 4215,
+	/* H */ 4341,
+	/* I */ 4467,
+	/* J */ 4518,
+	/* K */ 4619,
+	/* L */ 4745,
+	/* M */ 4871,
+	/* N */ 5047,
+	/* O */ 5173,
+	/* P */ 5299,
+	/* Q */ 5425,
+	/* R */ 5551,
+	/* S */ 5677,
+	/* T */ 5803,
+	/* U */ 5929,
+	/* V */ 6055,
+	/* W */ 6181,
+	/* X */ 6357,
+	/* Y */ 6483,
+	/* Z */ 6609,
+	/* [ */ 6735,
+	/* \ */ 6811,
+	/* ] */ 6937,
+	/* ^ */ 7013,
+	/* _ */ 7139,
+	/* ` */ 7265,
+	/* a */ 7341,
+	/* b */ 7467,
+	/* c */ 7593,
+	/* d */ 7719,
+	/* e */ 7845,
+	/* f */ 7971,
+	/* g */ 8097,
+	/* h */ 8223,
+	/* i */ 8349,
+	/* j */ 8400,
+	/* k */ 8501,
+	/* l */ 8627,
+	/* m */ 8678,
+	/* n */ 8854,
+	/* o */ 8980,
+	/* p */ 9106,
+	/* q */ 9232,
+	/* r */ 9358,
+	/* s */ 9484,
+	/* t */ 9610,
+	/* u */ 9724,
+	/* v */ 9850,
+	/* w */ 9976,
+	/* x */ 10152,
+	/* y */ 10278,
+	/* z */ 10404,
+	/* { */ 10530,
+	/* | */ 10594,
+	/* } */ 10620,
+	/* ~ */ 10684,
+};
+
 uint8_t const font_26[] = {
 
 	/* height */ 26,
@@ -206,6 +304,104 @@ uint8_t const font_26[] = {
 	/* ~ */ 10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x78, 0xFC, 0xF3, 0xFC, 0xE3, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 };
 
+uint16_t const font_26_index[] = {
+	/*   */ 1,
+	/* ! */ 22,
+	/* " */ 30,
+	/* # */ 51,
+	/* $ */ 85,
+	/* % */ 119,
+	/* & */ 153,
+	/* ' */ 187,
+	/* ( */ 195,
+	/* ) */ 216,
+	/* * */ 237,
+	/* + */ 271,
+	/* , */ 305,
+	/* - */ 319,
+	/* . */ 353,
+	/* / */ 367,
+	/* 0 */ 401,
+	/* 1 */ 435,
+	/* 2 */ 456,
+	/* 3 */ 490,
+	/* 4 */ 524,
+	/* 5 */ 558,
+	/* 6 */ 592,
+	/* 7 */ 626,
+	/* 8 */ 660,
+	/* 9 */ 694,
+	/* : */ 728,
+	/* ; */ 742,
+	/* < */ 756,
+	/* = */ 790,
+	/* > */ 824,
+	/* ? */ 858,
+	/* @ */ 892,
+	/* A */ 939,
+	/* B */ 973,
+	/* C */ 1007,
+	/* D */ 1041,
+	/* E */ 1075,
+	/* F */ 1109,
+	/* G */ 1143,
+	/* H */ 1177,
+	/* I */ 1211,
+	/* J */ 1225,
+	/* K */ 1252,
+	/* L */ 1286,
+	/* M */ 1320,
+	/* N */ 1367,
+	/* O */ 1401,
+	/* P */ 1435,
+	/* Q */ 1469,
+	/* R */ 1503,
+	/* S */ 1537,
+	/* T */ 1571,
+	/* U */ 1605,
+	/* V */ 1639,
+	/* W */ 1673,
+	/* X */ 1720,
+	/* Y */ 1754,
+	/* Z */ 1788,
+	/* [ */ 1822,
+	/* \ */ 1843,
+	/* ] */ 1877,
+	/* ^ */ 1898,
+	/* _ */ 1932,
+	/* ` */ 1966,
+	/* a */ 1987,
+	/* b */ 2021,
+	/* c */ 2055,
+	/* d */ 2089,
+	/* e */ 2123,
+	/* f */ 2157,
+	/* g */ 2191,
+	/* h */ 2225,
+	/* i */ 2259,
+	/* j */ 2273,
+	/* k */ 2300,
+	/* l */ 2334,
+	/* m */ 2348,
+	/* n */ 2395,
+	/* o */ 2429,
+	/* p */ 2463,
+	/* q */ 2497,
+	/* r */ 2531,
+	/* s */ 2565,
+	/* t */ 2599,
+	/* u */ 2630,
+	/* v */ 2664,
+	/* w */ 2698,
+	/* x */ 2745,
+	/* y */ 2779,
+	/* z */ 2813,
+	/* { */ 2847,
+	/* | */ 2865,
+	/* } */ 2873,
+	/* ~ */ 2891,
+};
+
 uint8_t const font_13[] = {
 
 	/* height */ 13,
@@ -307,6 +503,104 @@ uint8_t const font_13[] = {
 	/* ~ */ 5, 0x00, 0x00, 0x20, 0x6B, 0x02, 0x00, 0x00, 0x00, 0x00,
 };
 
+uint16_t const font_13_index[] = {
+	/*   */ 1,
+	/* ! */ 7,
+	/* " */ 10,
+	/* # */ 16,
+	/* $ */ 26,
+	/* % */ 36,
+	/* & */ 46,
+	/* ' */ 56,
+	/* ( */ 59,
+	/* ) */ 65,
+	/* * */ 71,
+	/* + */ 81,
+	/* , */ 91,
+	/* - */ 96,
+	/* . */ 106,
+	/* / */ 111,
+	/* 0 */ 121,
+	/* 1 */ 131,
+	/* 2 */ 137,
+	/* 3 */ 147,
+	/* 4 */ 157,
+	/* 5 */ 167,
+	/* 6 */ 177,
+	/* 7 */ 187,
+	/* 8 */ 197,
+	/* 9 */ 207,
+	/* : */ 217,
+	/* ; */ 222,
+	/* < */ 227,
+	/* = */ 237,
+	/* > */ 247,
+	/* ? */ 257,
+	/* @ */ 267,
+	/* A */ 280,
+	/* B */ 290,
+	/* C */ 300,
+	/* D */ 310,
+	/* E */ 320,
+	/* F */ 330,
+	/* G */ 340,
+	/* H */ 350,
+	/* I */ 360,
+	/* J */ 366,
+	/* K */ 376,
+	/* L */ 386,
+	/* M */ 396,
+	/* N */ 409,
+	/* O */ 419,
+	/* P */ 429,
+	/* Q */ 439,
+	/* R */ 449,
+	/* S */ 459,
+	/* T */ 469,
+	/* U */ 479,
+	/* V */ 489,
+	/* W */ 499,
+	/* X */ 512,
+	/* Y */ 522,
+	/* Z */ 532,
+	/* [ */ 542,
+	/* \ */ 548,
+	/* ] */ 558,
+	/* ^ */ 564,
+	/* _ */ 574,
+	/* ` */ 584,
+	/* a */ 590,
+	/* b */ 600,
+	/* c */ 610,
+	/* d */ 620,
+	/* e */ 630,
+	/* f */ 640,
+	/* g */ 650,
+	/* h */ 660,
+	/* i */ 670,
+	/* j */ 676,
+	/* k */ 684,
+	/* l */ 694,
+	/* m */ 704,
+	/* n */ 717,
+	/* o */ 727,
+	/* p */ 737,
+	/* q */ 747,
+	/* r */ 757,
+	/* s */ 767,
+	/* t */ 777,
+	/* u */ 787,
+	/* v */ 797,
+	/* w */ 807,
+	/* x */ 820,
+	/* y */ 830,
+	/* z */ 840,
+	/* { */ 850,
+	/* | */ 858,
+	/* } */ 861,
+	/* ~ */ 869,
+};
+
 uint8_t const font_7[] = {
 
 	/* height */ 7,
@@ -408,6 +702,104 @@ uint8_t const font_7[] = {
 	/* ~ */ 4, 0x00, 0xC3, 0x00, 0x00,
 };
 
+uint16_t const font_7_index[] = {
+	/*   */ 1,
+	/* ! */ 3,
+	/* " */ 5,
+	/* # */ 9,
+	/* $ */ 15,
+	/* % */ 19,
+	/* & */ 23,
+	/* ' */ 27,
+	/* ( */ 29,
+	/* ) */ 32,
+	/* * */ 35,
+	/* + */ 38,
+	/* , */ 42,
+	/* - */ 44,
+	/* . */ 48,
+	/* / */ 50,
+	/* 0 */ 54,
+	/* 1 */ 58,
+	/* 2 */ 62,
+	/* 3 */ 66,
+	/* 4 */ 70,
+	/* 5 */ 74,
+	/* 6 */ 78,
+	/* 7 */ 82,
+	/* 8 */ 86,
+	/* 9 */ 90,
+	/* : */ 94,
+	/* ; */ 96,
+	/* < */ 98,
+	/* = */ 102,
+	/* > */ 106,
+	/* ? */ 110,
+	/* @ */ 114,
+	/* A */ 119,
+	/* B */ 123,
+	/* C */ 127,
+	/* D */ 131,
+	/* E */ 135,
+	/* F */ 139,
+	/* G */ 143,
+	/* H */ 147,
+	/* I */ 151,
+	/* J */ 155,
+	/* K */ 159,
+	/* L */ 163,
+	/* M */ 167,
+	/* N */ 173,
+	/* O */ 178,
+	/* P */ 182,
+	/* Q */ 186,
+	/* R */ 190,
+	/* S */ 194,
+	/* T */ 198,
+	/* U */ 202,
+	/* V */ 206,
+	/* W */ 210,
+	/* X */ 216,
+	/* Y */ 220,
+	/* Z */ 224,
+	/* [ */ 228,
+	/* \ */ 231,
+	/* ] */ 235,
+	/* ^ */ 238,
+	/* _ */ 242,
+	/* ` */ 246,
+	/* a */ 250,
+	/* b */ 254,
+	/* c */ 258,
+	/* d */ 262,
+	/* e */ 266,
+	/* f */ 270,
+	/* g */ 274,
+	/* h */ 278,
+	/* i */ 282,
+	/* j */ 284,
+	/* k */ 287,
+	/* l */ 291,
+	/* m */ 294,
+	/* n */ 300,
+	/* o */ 304,
+	/* p */ 308,
+	/* q */ 312,
+	/* r */ 316,
+	/* s */ 320,
+	/* t */ 324,
+	/* u */ 328,
+	/* v */ 332,
+	/* w */ 336,
+	/* x */ 342,
+	/* y */ 346,
+	/* z */ 350,
+	/* { */ 354,
+	/* | */ 358,
+	/* } */ 360,
+	/* ~ */ 364,
+};
+
 uint8_t const font_8[] = {
 
 	/* height */ 8,
@@ -508,3 +900,101 @@ uint8_t const font_8[] = {
 	/* } */ 3, 0x93, 0xAD, 0x01,
 	/* ~ */ 5, 0x40, 0x54, 0x04, 0x00, 0x00,
 };
+
+uint16_t const font_8_index[] = {
+	/*   */ 1,
+	/* ! */ 3,
+	/* " */ 5,
+	/* # */ 9,
+	/* $ */ 15,
+	/* % */ 21,
+	/* & */ 26,
+	/* ' */ 31,
+	/* ( */ 33,
+	/* ) */ 36,
+	/* * */ 39,
+	/* + */ 45,
+	/* , */ 51,
+	/* - */ 54,
+	/* . */ 59,
+	/* / */ 61,
+	/* 0 */ 65,
+	/* 1 */ 70,
+	/* 2 */ 74,
+	/* 3 */ 79,
+	/* 4 */ 84,
+	/* 5 */ 89,
+	/* 6 */ 94,
+	/* 7 */ 99,
+	/* 8 */ 104,
+	/* 9 */ 109,
+	/* : */ 114,
+	/* ; */ 116,
+	/* < */ 119,
+	/* = */ 123,
+	/* > */ 128,
+	/* ? */ 132,
+	/* @ */ 136,
+	/* A */ 142,
+	/* B */ 147,
+	/* C */ 152,
+	/* D */ 157,
+	/* E */ 162,
+	/* F */ 167,
+	/* G */ 172,
+	/* H */ 177,
+	/* I */ 182,
+	/* J */ 186,
+	/* K */ 191,
+	/* L */ 196,
+	/* M */ 201,
+	/* N */ 207,
+	/* O */ 212,
+	/* P */ 217,
+	/* Q */ 222,
+	/* R */ 227,
+	/* S */ 232,
+	/* T */ 237,
+	/* U */ 243,
+	/* V */ 248,
+	/* W */ 254,
+	/* X */ 260,
+	/* Y */ 265,
+	/* Z */ 270,
+	/* [ */ 275,
+	/* \ */ 278,
+	/* ] */ 282,
+	/* ^ */ 285,
+	/* _ */ 289,
+	/* ` */ 293,
+	/* a */ 296,
+	/* b */ 301,
+	/* c */ 306,
+	/* d */ 311,
+	/* e */ 316,
+	/* f */ 321,
+	/* g */ 325,
+	/* h */ 330,
+	/* i */ 335,
+	/* j */ 339,
+	/* k */ 343,
+	/* l */ 348,
+	/* m */ 352,
+	/* n */ 358,
+	/* o */ 363,
+	/* p */ 368,
+	/* q */ 373,
+	/* r */ 378,
+	/* s */ 383,
+	/* t */ 388,
+	/* u */ 392,
+	/* v */ 397,
+	/* w */ 403,
+	/* x */ 409,
+	/* y */ 414,
+	/* z */ 419,
+	/* { */ 424,
+	/* | */ 428,
+	/* } */ 430,
+	/* ~ */ 434,
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <stdint.h>
+
+/* generated by ./txt2cfont */
+
+uint8_t const span_font_50[] = {
+
+	/* height */ 50,
+
+	/*   */ 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* ! */ 4, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 24, 24, 24, 24, 24, 24, 25, 26, 27, 28, 29, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4,
+	/* " */ 12, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4,
+	/* # */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 17, 18, 19, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 45, 46, 47, 48, 50, 52, 54, 56, 58, 60, 62, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 0, 20, 0, 20, 0, 20, 0, 20, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 0, 20, 0, 20, 0, 20, 0, 20, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4,
+	/* $ */ 20, 0, 1, 2, 3, 4, 5, 6, 7, 10, 13, 16, 19, 21, 23, 25, 27, 29, 31, 33, 35, 36, 37, 38, 39, 41, 43, 45, 47, 49, 51, 53, 55, 58, 61, 64, 67, 68, 69, 70, 71, 72, 73, 74, 75, 75, 75, 75, 75, 75, 75, 75, 8, 4, 8, 4, 8, 4, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 8, 4, 14, 6, 0, 6, 8, 4, 14, 6, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 8, 4, 16, 4, 8, 4, 16, 4, 8, 4, 16, 4, 8, 4, 16, 4, 8, 4, 16, 4, 8, 4, 16, 4, 8, 4, 14, 6, 8, 4, 14, 6, 4, 14, 4, 14, 2, 14, 2, 14, 0, 6, 8, 4, 0, 6, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 6, 8, 4, 14, 6, 0, 6, 8, 4, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12, 8, 4, 8, 4, 8, 4, 8, 4,
+	/* % */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 38, 40, 42, 44, 46, 48, 50, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 0, 4, 14, 4, 0, 4, 14, 4, 0, 6, 12, 8, 0, 6, 12, 8, 0, 6, 12, 8, 0, 6, 12, 8, 2, 6, 14, 4, 2, 6, 14, 4, 2, 6, 2, 6, 4, 6, 4, 6, 4, 6, 4, 6, 6, 6, 6, 6, 6, 6, 6, 6, 8, 6, 8, 6, 8, 6, 8, 6, 10, 6, 10, 6, 10, 6, 10, 6, 12, 6, 12, 6, 2, 4, 12, 6, 2, 4, 12, 6, 0, 8, 14, 6, 0, 8, 14, 6, 0, 8, 14, 6, 0, 8, 14, 6, 2, 4, 16, 4, 2, 4, 16, 4,
+	/* & */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 21, 22, 23, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 8, 6, 8, 6, 6, 10, 6, 10, 4, 6, 12, 6, 4, 6, 12, 6, 4, 4, 14, 4, 4, 4, 14, 4, 4, 4, 14, 4, 4, 4, 14, 4, 4, 6, 12, 6, 4, 6, 12, 6, 6, 10, 6, 10, 8, 6, 8, 6, 0, 4, 6, 10, 0, 4, 6, 10, 0, 4, 6, 12, 0, 4, 6, 12, 0, 10, 14, 6, 0, 10, 14, 6, 2, 8, 16, 4, 2, 8, 16, 4, 2, 6, 16, 4, 2, 6, 16, 4, 2, 6, 16, 4, 2, 6, 16, 4, 0, 10, 16, 4, 0, 10, 16, 4, 0, 10, 14, 6, 0, 10, 14, 6, 0, 4, 6, 12, 0, 4, 6, 12, 0, 4, 8, 8, 0, 4, 8, 8,
+	/* ' */ 4, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4,
+	/* ( */ 12, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 4, 0, 4, 0, 6, 0, 6, 2, 6, 2, 6, 4, 6, 4, 6, 6, 4, 6, 4, 6, 6, 6, 6, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 6, 4, 6, 4, 4, 6, 4, 6, 2, 6, 2, 6, 0, 6, 0, 6, 0, 4, 0, 4,
+	/* ) */ 12, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 8, 4, 8, 4, 6, 6, 6, 6, 4, 6, 4, 6, 2, 6, 2, 6, 0, 6, 0, 6, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 6, 0, 6, 2, 6, 2, 6, 4, 6, 4, 6, 6, 6, 6, 6, 8, 4, 8, 4,
+	/* * */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 7, 10, 13, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 31, 34, 37, 40, 41, 42, 43, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 8, 4, 8, 4, 8, 4, 8, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 6, 8, 4, 14, 6, 0, 6, 8, 4, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12, 6, 8, 6, 8, 6, 8, 6, 8, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 8, 4, 14, 6, 0, 6, 8, 4, 14, 6, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 8, 4, 8, 4, 8, 4, 8, 4,
+	/* + */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 0, 20, 0, 20, 0, 20, 0, 20, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4,
+	/* , */ 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 16, 16, 16, 2, 4, 2, 4, 0, 8, 0, 8, 0, 8, 0, 8, 0, 6, 0, 6, 0, 4, 0, 4, 0, 4, 0, 4, 2, 4, 2, 4, 4, 4, 4, 4,
+	/* - */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 0, 20, 0, 20, 0, 20, 0, 20,
+	/* . */ 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 2, 4, 2, 4, 0, 8, 0, 8, 0, 8, 0, 8, 2, 4, 2, 4,
+	/* / */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 4, 0, 4, 0, 4, 0, 4, 0, 6, 0, 6, 2, 4, 2, 4, 2, 6, 2, 6, 4, 4, 4, 4, 4, 6, 4, 6, 6, 4, 6, 4, 8, 4, 8, 4, 8, 4, 8, 4, 10, 4, 10, 4, 10, 6, 10, 6, 12, 4, 12, 4, 12, 6, 12, 6, 14, 4, 14, 4, 14, 6, 14, 6, 16, 4, 16, 4, 16, 4, 16, 4,
+	/* 0 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 31, 34, 37, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 65, 66, 67, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 4, 12, 4, 12, 2, 16, 2, 16, 2, 4, 14, 4, 2, 4, 14, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 4, 14, 4, 2, 4, 14, 4, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* 1 */ 12, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 4, 4, 4, 4, 4, 4, 4, 4, 4, 6, 4, 6, 4, 6, 4, 6, 4, 8, 4, 8, 4, 8, 4, 8, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 0, 12, 0, 12, 0, 12, 0, 12,
+	/* 2 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 0, 4, 0, 6, 0, 6, 2, 6, 2, 6, 4, 6, 4, 6, 6, 6, 6, 6, 8, 6, 8, 6, 10, 6, 10, 6, 12, 6, 12, 6, 14, 6, 14, 6, 16, 4, 16, 4, 0, 20, 0, 20, 0, 20, 0, 20,
+	/* 3 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 34, 36, 38, 40, 41, 42, 43, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 6, 0, 6, 2, 14, 2, 14, 2, 14, 2, 14, 0, 6, 0, 6, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* 4 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 0, 4, 0, 4, 0, 6, 0, 6, 0, 8, 0, 8, 0, 10, 0, 10, 0, 4, 6, 6, 0, 4, 6, 6, 0, 4, 8, 6, 0, 4, 8, 6, 0, 4, 10, 6, 0, 4, 10, 6, 0, 4, 12, 6, 0, 4, 12, 6, 0, 4, 14, 6, 0, 4, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 20, 0, 20, 0, 20, 0, 20, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4,
+	/* 5 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 30, 32, 34, 36, 37, 38, 39, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 0, 20, 0, 20, 0, 20, 0, 20, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 4, 16, 4, 16, 2, 18, 2, 18, 0, 6, 0, 6, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* 6 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 49, 50, 51, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 4, 16, 4, 16, 2, 18, 2, 18, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* 7 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 20, 0, 20, 0, 20, 0, 20, 0, 4, 0, 4, 0, 4, 0, 4, 0, 6, 0, 6, 2, 4, 2, 4, 2, 6, 2, 6, 4, 4, 4, 4, 4, 6, 4, 6, 6, 4, 6, 4, 6, 6, 6, 6, 8, 4, 8, 4, 8, 6, 8, 6, 10, 4, 10, 4, 10, 6, 10, 6, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4,
+	/* 8 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 29, 30, 31, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 57, 58, 59, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* 9 */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 42, 44, 46, 48, 49, 50, 51, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 14, 6, 0, 4, 14, 6, 0, 18, 0, 18, 0, 16, 0, 16, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* : */ 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 9, 10, 11, 12, 13, 14, 15, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 2, 4, 2, 4, 0, 8, 0, 8, 0, 8, 0, 8, 2, 4, 2, 4, 2, 4, 2, 4, 0, 8, 0, 8, 0, 8, 0, 8, 2, 4, 2, 4,
+	/* ; */ 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 24, 24, 24, 2, 4, 2, 4, 0, 8, 0, 8, 0, 8, 0, 8, 2, 4, 2, 4, 2, 4, 2, 4, 0, 8, 0, 8, 0, 8, 0, 8, 0, 6, 0, 6, 0, 4, 0, 4, 0, 4, 0, 4, 2, 4, 2, 4, 4, 4, 4, 4,
+	/* < */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 4, 0, 4, 0, 6, 0, 6, 2, 6, 2, 6, 4, 6, 4, 6, 6, 6, 6, 6, 8, 6, 8, 6, 10, 6, 10, 6, 12, 6, 12, 6, 14, 6, 14, 6, 14, 6, 14, 6, 12, 6, 12, 6, 10, 6, 10, 6, 8, 6, 8, 6, 6, 6, 6, 6, 4, 6, 4, 6, 2, 6, 2, 6, 0, 6, 0, 6, 0, 4, 0, 4,
+	/* = */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 6, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 0, 20, 0, 20, 0, 20, 0, 20, 0, 20, 0, 20, 0, 20, 0, 20,
+	/* > */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 16, 4, 16, 4, 14, 6, 14, 6, 12, 6, 12, 6, 10, 6, 10, 6, 8, 6, 8, 6, 6, 6, 6, 6, 4, 6, 4, 6, 2, 6, 2, 6, 0, 6, 0, 6, 0, 6, 0, 6, 2, 6, 2, 6, 4, 6, 4, 6, 6, 6, 6, 6, 8, 6, 8, 6, 10, 6, 10, 6, 12, 6, 12, 6, 14, 6, 14, 6, 16, 4, 16, 4,
+	/* ? */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 34, 34, 34, 34, 35, 36, 37, 38, 39, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 0, 4, 0, 6, 0, 6, 2, 6, 2, 6, 4, 6, 4, 6, 6, 6, 6, 6, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4,
+	/* @ */ 28, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 15, 18, 21, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60, 64, 68, 72, 74, 76, 78, 80, 81, 82, 83, 84, 85, 86, 87, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 4, 20, 4, 20, 2, 24, 2, 24, 0, 6, 22, 6, 0, 6, 22, 6, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 8, 10, 24, 4, 0, 4, 8, 10, 24, 4, 0, 4, 8, 12, 24, 4, 0, 4, 8, 12, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 6, 8, 4, 16, 4, 24, 4, 0, 6, 8, 4, 16, 4, 24, 4, 2, 18, 24, 4, 2, 18, 24, 4, 4, 14, 24, 4, 4, 14, 24, 4, 24, 4, 24, 4, 22, 6, 22, 6, 4, 22, 4, 22, 4, 20, 4, 20,
+	/* A */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 37, 38, 39, 40, 42, 44, 46, 48, 50, 52, 54, 56, 56, 56, 56, 56, 56, 56, 56, 56, 56, 56, 56, 8, 4, 8, 4, 8, 4, 8, 4, 6, 8, 6, 8, 6, 8, 6, 8, 6, 8, 6, 8, 4, 12, 4, 12, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 2, 6, 12, 6, 2, 6, 12, 6, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 16, 2, 16, 0, 20, 0, 20, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* B */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 29, 30, 31, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 57, 58, 59, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 4, 16, 4, 16, 2, 18, 2, 18, 0, 6, 16, 4, 0, 6, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 18, 2, 18, 2, 18, 2, 18, 0, 6, 16, 4, 0, 6, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 18, 2, 18, 4, 16, 4, 16,
+	/* C */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 34, 36, 38, 40, 41, 42, 43, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* D */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 61, 62, 63, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 4, 16, 4, 16, 2, 18, 2, 18, 0, 6, 16, 4, 0, 6, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 18, 2, 18, 4, 16, 4, 16,
+	/* E */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 20, 0, 20, 0, 20, 0, 20, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 4, 16, 4, 16, 4, 16, 4, 16, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 0, 20, 0, 20, 0, 20, 0, 20,
+	/* F */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 20, 0, 20, 0, 20, 0, 20, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 4, 16, 4, 16, 4, 16, 4, 16, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4,
+	/* G */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 49, 50, 51, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 0, 12, 16, 4, 0, 12, 16, 4, 0, 12, 16, 4, 0, 12, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* H */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 33, 34, 35, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 20, 0, 20, 0, 20, 0, 20, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* I */ 8, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 8, 0, 8, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 0, 8, 0, 8,
+	/* J */ 16, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 30, 32, 34, 36, 37, 38, 39, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 0, 8, 0, 8, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 14, 2, 2, 4, 14, 2, 2, 6, 12, 4, 2, 6, 12, 4, 4, 12, 4, 12, 6, 8, 6, 8,
+	/* K */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 29, 30, 31, 32, 33, 34, 35, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 6, 16, 4, 2, 6, 16, 4, 4, 6, 16, 4, 4, 6, 16, 4, 6, 6, 16, 4, 6, 6, 16, 4, 8, 6, 16, 4, 8, 6, 16, 4, 10, 10, 10, 10, 12, 8, 12, 8, 12, 8, 12, 8, 10, 10, 10, 10, 8, 6, 16, 4, 8, 6, 16, 4, 6, 6, 16, 4, 6, 6, 16, 4, 4, 6, 16, 4, 4, 6, 16, 4, 2, 6, 16, 4, 2, 6, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* L */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 0, 20, 0, 20, 0, 20, 0, 20,
+	/* M */ 28, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 24, 28, 32, 36, 40, 44, 47, 50, 53, 56, 59, 62, 65, 68, 71, 74, 76, 78, 80, 82, 84, 86, 88, 90, 92, 94, 94, 94, 94, 94, 94, 94, 94, 94, 94, 94, 94, 0, 4, 24, 4, 0, 4, 24, 4, 0, 6, 22, 6, 0, 6, 22, 6, 0, 8, 20, 8, 0, 8, 20, 8, 0, 8, 20, 8, 0, 8, 20, 8, 0, 10, 18, 10, 0, 10, 18, 10, 0, 4, 6, 4, 18, 4, 24, 4, 0, 4, 6, 4, 18, 4, 24, 4, 0, 4, 6, 6, 16, 6, 24, 4, 0, 4, 6, 6, 16, 6, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 12, 24, 4, 0, 4, 8, 12, 24, 4, 0, 4, 10, 8, 24, 4, 0, 4, 10, 8, 24, 4, 0, 4, 10, 8, 24, 4, 0, 4, 10, 8, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4,
+	/* N */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46, 49, 52, 55, 58, 61, 64, 67, 70, 73, 76, 78, 80, 82, 84, 86, 88, 90, 92, 92, 92, 92, 92, 92, 92, 92, 92, 92, 92, 92, 0, 4, 14, 6, 0, 4, 14, 6, 0, 4, 14, 6, 0, 4, 14, 6, 0, 4, 12, 8, 0, 4, 12, 8, 0, 4, 12, 8, 0, 4, 12, 8, 0, 4, 10, 4, 16, 4, 0, 4, 10, 4, 16, 4, 0, 4, 10, 4, 16, 4, 0, 4, 10, 4, 16, 4, 0, 4, 10, 4, 16, 4, 0, 4, 10, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 6, 4, 16, 4, 0, 4, 6, 4, 16, 4, 0, 4, 6, 4, 16, 4, 0, 4, 6, 4, 16, 4, 0, 4, 6, 4, 16, 4, 0, 4, 6, 4, 16, 4, 0, 8, 16, 4, 0, 8, 16, 4, 0, 8, 16, 4, 0, 8, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4,
+	/* O */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 61, 62, 63, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* P */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 52, 4, 16, 4, 16, 2, 18, 2, 18, 0, 6, 16, 4, 0, 6, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 18, 2, 18, 4, 16, 4, 16, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4,
+	/* Q */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 55, 58, 60, 62, 63, 64, 65, 66, 67, 68, 69, 70, 70, 70, 70, 70, 70, 70, 70, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 4, 8, 4, 16, 4, 0, 12, 14, 6, 0, 12, 14, 6, 2, 16, 2, 16, 2, 14, 2, 14, 0, 6, 0, 6, 0, 4, 0, 4,
+	/* R */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 37, 38, 39, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 4, 16, 4, 16, 2, 18, 2, 18, 0, 6, 16, 4, 0, 6, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 18, 2, 18, 4, 16, 4, 16, 8, 6, 16, 4, 8, 6, 16, 4, 6, 6, 16, 4, 6, 6, 16, 4, 4, 6, 16, 4, 4, 6, 16, 4, 2, 6, 16, 4, 2, 6, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* S */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 34, 36, 38, 40, 41, 42, 43, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 14, 6, 14, 6, 4, 14, 4, 14, 2, 14, 2, 14, 0, 6, 0, 6, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* T */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 20, 0, 20, 0, 20, 0, 20, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4,
+	/* U */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 65, 66, 67, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 68, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* V */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 62, 62, 62, 62, 62, 62, 62, 62, 62, 62, 62, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 6, 12, 6, 2, 6, 12, 6, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 12, 4, 12, 6, 8, 6, 8, 6, 8, 6, 8, 6, 8, 6, 8, 8, 4, 8, 4,
+	/* W */ 28, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 23, 26, 29, 32, 35, 38, 41, 44, 47, 50, 54, 58, 62, 66, 70, 74, 76, 78, 80, 82, 84, 86, 88, 90, 92, 94, 94, 94, 94, 94, 94, 94, 94, 94, 94, 94, 94, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 10, 8, 24, 4, 0, 4, 10, 8, 24, 4, 0, 4, 10, 8, 24, 4, 0, 4, 10, 8, 24, 4, 0, 4, 8, 12, 24, 4, 0, 4, 8, 12, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 8, 4, 16, 4, 24, 4, 0, 4, 6, 6, 16, 6, 24, 4, 0, 4, 6, 6, 16, 6, 24, 4, 0, 4, 6, 4, 18, 4, 24, 4, 0, 4, 6, 4, 18, 4, 24, 4, 0, 10, 18, 10, 0, 10, 18, 10, 0, 8, 20, 8, 0, 8, 20, 8, 0, 8, 20, 8, 0, 8, 20, 8, 0, 6, 22, 6, 0, 6, 22, 6, 0, 4, 24, 4, 0, 4, 24, 4,
+	/* X */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 29, 30, 31, 32, 33, 34, 35, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 4, 14, 4, 2, 4, 14, 4, 2, 6, 12, 6, 2, 6, 12, 6, 4, 4, 12, 4, 4, 4, 12, 4, 4, 12, 4, 12, 6, 8, 6, 8, 6, 8, 6, 8, 4, 12, 4, 12, 4, 4, 12, 4, 4, 4, 12, 4, 2, 6, 12, 6, 2, 6, 12, 6, 2, 4, 14, 4, 2, 4, 14, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* Y */ 20, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 4, 14, 4, 2, 4, 14, 4, 2, 6, 12, 6, 2, 6, 12, 6, 4, 4, 12, 4, 4, 4, 12, 4, 4, 12, 4, 12, 6, 8, 6, 8, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4,
+	/* Z */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 20, 0, 20, 0, 20, 0, 20, 0, 6, 0, 6, 2, 4, 2, 4, 2, 6, 2, 6, 4, 4, 4, 4, 4, 6, 4, 6, 6, 4, 6, 4, 8, 4, 8, 4, 8, 4, 8, 4, 10, 4, 10, 4, 10, 6, 10, 6, 12, 4, 12, 4, 12, 6, 12, 6, 14, 4, 14, 4, 14, 6, 14, 6, 0, 20, 0, 20, 0, 20, 0, 20,
+	/* [ */ 12, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 12, 0, 12, 0, 12, 0, 12, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 8, 4, 0, 12, 0, 12, 0, 12, 0, 12,
+	/* \ */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 16, 4, 16, 4, 16, 4, 16, 4, 14, 6, 14, 6, 14, 4, 14, 4, 12, 6, 12, 6, 12, 4, 12, 4, 10, 6, 10, 6, 10, 4, 10, 4, 8, 4, 8, 4, 8, 4, 8, 4, 6, 4, 6, 4, 4, 6, 4, 6, 4, 4, 4, 4, 2, 6, 2, 6, 2, 4, 2, 4, 0, 6, 0, 6, 0, 4, 0, 4, 0, 4, 0, 4,
+	/* ] */ 12, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 12, 0, 12, 0, 12, 0, 12, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 12, 0, 12, 0, 12, 0, 12,
+	/* ^ */ 20, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 8, 10, 12, 14, 16, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 8, 4, 8, 4, 6, 8, 6, 8, 4, 12, 4, 12, 2, 6, 12, 6, 2, 6, 12, 6, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* _ */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 4, 4, 4, 4, 4, 4, 4, 0, 20, 0, 20, 0, 20, 0, 20,
+	/* ` */ 12, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 8, 4, 8, 4, 6, 6, 6, 6, 4, 6, 4, 6, 2, 6, 2, 6, 0, 6, 0, 6, 0, 4, 0, 4,
+	/* a */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 22, 24, 26, 28, 30, 32, 34, 36, 37, 38, 40, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 16, 0, 16, 0, 18, 0, 18, 0, 4, 14, 6, 0, 4, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 18, 0, 18, 0, 4, 6, 10, 0, 4, 6, 10,
+	/* b */ 20, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 16, 17, 19, 21, 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 58, 59, 61, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 4, 10, 16, 4, 4, 10, 16, 4, 2, 18, 2, 18, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 18, 2, 18, 4, 10, 16, 4, 4, 10, 16, 4,
+	/* c */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 26, 28, 30, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* d */ 20, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 16, 17, 19, 21, 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 58, 59, 61, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 6, 10, 0, 4, 6, 10, 0, 18, 0, 18, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 18, 0, 18, 0, 2, 4, 12, 0, 2, 4, 12,
+	/* e */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 20, 0, 20, 0, 20, 0, 20, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 14, 6, 14, 6, 4, 14, 4, 14, 4, 12, 4, 12,
+	/* f */ 20, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 39, 39, 39, 39, 39, 39, 39, 39, 39, 39, 39, 0, 12, 0, 14, 0, 14, 10, 6, 10, 6, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 4, 16, 4, 16, 4, 16, 4, 16, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4, 12, 4,
+	/* g */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 5, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 47, 48, 50, 52, 53, 54, 55, 56, 57, 58, 60, 62, 63, 64, 65, 0, 4, 6, 10, 0, 4, 6, 10, 0, 18, 0, 18, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 18, 0, 18, 0, 4, 6, 10, 0, 4, 6, 10, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 16, 2, 16, 4, 12,
+	/* h */ 20, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 16, 17, 19, 21, 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 4, 10, 16, 4, 4, 10, 16, 4, 2, 18, 2, 18, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* i */ 8, 0, 1, 2, 3, 4, 5, 6, 7, 7, 7, 7, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 35, 2, 4, 0, 8, 0, 8, 0, 8, 0, 8, 2, 4, 2, 4, 2, 6, 2, 6, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 0, 8, 0, 8,
+	/* j */ 16, 0, 1, 2, 3, 4, 5, 6, 7, 7, 7, 7, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 41, 43, 45, 47, 48, 49, 50, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 0, 8, 0, 8, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 14, 2, 2, 4, 14, 2, 2, 6, 12, 4, 2, 6, 12, 4, 4, 12, 4, 12, 6, 8,
+	/* k */ 20, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31, 33, 35, 36, 37, 38, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 6, 16, 4, 2, 6, 16, 4, 4, 6, 16, 4, 4, 6, 16, 4, 6, 6, 16, 4, 6, 6, 16, 4, 8, 6, 16, 4, 8, 6, 16, 4, 10, 10, 10, 10, 10, 10, 10, 10, 8, 6, 16, 4, 8, 6, 16, 4, 6, 6, 16, 4, 6, 6, 16, 4, 4, 6, 16, 4, 4, 6, 16, 4, 2, 6, 16, 4, 2, 6, 16, 4, 0, 6, 16, 4, 0, 6, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* l */ 8, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 39, 39, 39, 39, 39, 39, 39, 39, 39, 39, 39, 2, 6, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 0, 8, 0, 8,
+	/* m */ 28, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 6, 7, 8, 11, 14, 17, 20, 23, 26, 29, 32, 35, 38, 41, 44, 47, 50, 53, 56, 59, 62, 65, 68, 71, 74, 77, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 4, 8, 16, 6, 24, 4, 4, 8, 16, 6, 24, 4, 2, 26, 2, 26, 0, 6, 10, 8, 22, 6, 0, 6, 10, 8, 22, 6, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4,
+	/* n */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 5, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 4, 10, 16, 4, 4, 10, 16, 4, 2, 18, 2, 18, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* o */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 45, 46, 47, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* p */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 5, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 47, 48, 50, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 4, 10, 16, 4, 4, 10, 16, 4, 2, 18, 2, 18, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 18, 2, 18, 4, 10, 16, 4, 4, 10, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4,
+	/* q */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 5, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 47, 48, 50, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 0, 4, 6, 10, 0, 4, 6, 10, 0, 18, 0, 18, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 18, 0, 18, 0, 4, 6, 10, 0, 4, 6, 10, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4,
+	/* r */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 0, 14, 16, 4, 0, 14, 16, 4, 0, 20, 0, 20, 12, 8, 12, 8, 14, 6, 14, 6, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4, 16, 4,
+	/* s */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 8, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 26, 28, 30, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 4, 12, 4, 12, 2, 16, 2, 16, 0, 6, 14, 6, 0, 6, 14, 6, 2, 2, 16, 4, 2, 2, 16, 4, 16, 4, 16, 4, 14, 6, 14, 6, 4, 14, 4, 14, 2, 14, 2, 14, 0, 6, 0, 6, 0, 4, 0, 4, 0, 4, 16, 2, 0, 4, 16, 2, 0, 6, 14, 6, 0, 6, 14, 6, 2, 16, 2, 16, 4, 12, 4, 12,
+	/* t */ 18, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 35, 37, 38, 39, 40, 41, 41, 41, 41, 41, 41, 41, 41, 41, 41, 41, 41, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 2, 16, 2, 16, 2, 16, 2, 16, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 10, 4, 0, 2, 8, 6, 0, 2, 8, 6, 0, 12, 0, 12, 2, 8, 2, 8,
+	/* u */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 49, 50, 52, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 54, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 18, 0, 18, 0, 4, 6, 10, 0, 4, 6, 10,
+	/* v */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 41, 42, 43, 44, 45, 46, 47, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 2, 4, 14, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 4, 4, 12, 4, 6, 8, 6, 8, 6, 8, 6, 8, 8, 4, 8, 4, 8, 4, 8, 4,
+	/* w */ 28, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45, 48, 51, 54, 57, 60, 61, 62, 64, 66, 68, 70, 72, 74, 74, 74, 74, 74, 74, 74, 74, 74, 74, 74, 74, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 4, 12, 4, 24, 4, 0, 6, 10, 8, 22, 6, 0, 6, 10, 8, 22, 6, 0, 6, 10, 8, 22, 6, 0, 6, 10, 8, 22, 6, 2, 4, 10, 8, 22, 4, 2, 4, 10, 8, 22, 4, 2, 4, 10, 8, 22, 4, 2, 4, 10, 8, 22, 4, 2, 4, 10, 8, 22, 4, 2, 4, 10, 8, 22, 4, 2, 4, 10, 8, 22, 4, 2, 4, 10, 8, 22, 4, 2, 24, 2, 24, 4, 8, 16, 8, 4, 8, 16, 8, 4, 6, 18, 6, 4, 6, 18, 6, 6, 4, 18, 4, 6, 4, 18, 4,
+	/* x */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 21, 22, 23, 24, 25, 26, 27, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 2, 4, 14, 4, 2, 4, 14, 4, 2, 6, 12, 6, 2, 6, 12, 6, 4, 4, 12, 4, 4, 4, 12, 4, 4, 12, 4, 12, 6, 8, 6, 8, 6, 8, 6, 8, 4, 12, 4, 12, 4, 4, 12, 4, 4, 4, 12, 4, 2, 6, 12, 6, 2, 6, 12, 6, 2, 4, 14, 4, 2, 4, 14, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 4, 16, 4, 0, 4, 16, 4,
+	/* y */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 49, 50, 52, 54, 55, 56, 57, 58, 59, 60, 62, 64, 65, 66, 67, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 4, 16, 4, 0, 6, 14, 6, 0, 6, 14, 6, 0, 18, 0, 18, 0, 4, 6, 10, 0, 4, 6, 10, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 6, 16, 4, 0, 6, 16, 4, 2, 16, 2, 16, 4, 12,
+	/* z */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 0, 20, 0, 20, 0, 20, 0, 20, 0, 4, 0, 4, 0, 6, 0, 6, 2, 6, 2, 6, 4, 6, 4, 6, 6, 6, 6, 6, 8, 6, 8, 6, 10, 6, 10, 6, 12, 6, 12, 6, 14, 6, 14, 6, 16, 4, 16, 4, 0, 20, 0, 20, 0, 20, 0, 20,
+	/* { */ 10, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 6, 0, 6, 0, 8, 0, 8, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 6, 4, 6, 4, 6, 4, 6, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 0, 8, 0, 8, 0, 6, 0, 6,
+	/* | */ 4, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4,
+	/* } */ 10, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 4, 6, 4, 6, 2, 8, 2, 8, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 0, 4, 0, 4, 0, 4, 0, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 4, 2, 8, 2, 8, 4, 6, 4, 6,
+	/* ~ */ 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 6, 8, 10, 12, 14, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 0, 4, 10, 8, 0, 4, 10, 8, 0, 4, 8, 12, 0, 4, 8, 12, 0, 12, 16, 4, 0, 12, 16, 4, 2, 8, 16, 4, 2, 8, 16, 4,
+};
+
+uint16_t const span_font_50_index[] = {
+	/*   */ 1,
+	/* ! */ 53,
+	/* " */ 165,
+	/* # */ 265,
+	/* $ */ 445,
+	/* % */ 647,
+	/* & */ 803,
+	/* ' */ 983,
+	/* ( */ 1059,
+	/* ) */ 1183,
+	/* * */ 1307,
+	/* + */ 1447,
+	/* , */ 1555,
+	/* - */ 1639,
+	/* . */ 1699,
+	/* / */ 1767,
+	/* 0 */ 1891,
+	/* 1 */ 2079,
+	/* 2 */ 2203,
+	/* 3 */ 2343,
+	/* 4 */ 2483,
+	/* 5 */ 2631,
+	/* 6 */ 2763,
+	/* 7 */ 2919,
+	/* 8 */ 3043,
+	/* 9 */ 3215,
+	/* : */ 3371,
+	/* ; */ 3455,
+	/* < */ 3555,
+	/* = */ 3679,
+	/* > */ 3747,
+	/* ? */ 3871,
+	/* @ */ 4003,
+	/* A */ 4231,
+	/* B */ 4395,
+	/* C */ 4567,
+	/* D */ 4707,
+	/* E */ 4887,
+	/* F */ 5011,
+	/* G */ 5135,
+	/* H */ 5291,
+	/* I */ 5479,
+	/* J */ 5603,
+	/* K */ 5735,
+	/* L */ 5915,
+	/* M */ 6039,
+	/* N */ 6279,
+	/* O */ 6515,
+	/* P */ 6695,
+	/* Q */ 6851,
+	/* R */ 7043,
+	/* S */ 7223,
+	/* T */ 7363,
+	/* U */ 7487,
+	/* V */ 7675,
+	/* W */ 7851,
+	/* X */ 8091,
+	/* Y */ 8271,
+	/* Z */ 8423,
+	/* [ */ 8547,
+	/* \ */ 8671,
+	/* ] */ 8795,
+	/* ^ */ 8919,
+	/* _ */ 9007,
+	/* ` */ 9067,
+	/* a */ 9143,
+	/* b */ 9279,
+	/* c */ 9457,
+	/* d */ 9581,
+	/* e */ 9759,
+	/* f */ 9883,
+	/* g */ 10013,
+	/* h */ 10195,
+	/* i */ 10377,
+	/* j */ 10499,
+	/* k */ 10651,
+	/* l */ 10829,
+	/* m */ 10959,
+	/* n */ 11171,
+	/* o */ 11331,
+	/* p */ 11479,
+	/* q */ 11657,
+	/* r */ 11835,
+	/* s */ 11947,
+	/* t */ 12071,
+	/* u */ 12205,
+	/* v */ 12365,
+	/* w */ 12513,
+	/* x */ 12713,
+	/* y */ 12861,
+	/* z */ 13047,
+	/* { */ 13155,
+	/* | */ 13279,
+	/* } */ 13403,
+	/* ~ */ 13527,
+};
@@ -0,0 +1,215 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include "fontstore.h"
+#include "monocle.h"
+#include "py/runtime.h"
+
+// "MFNT" read as a little endian word
+#define FONTSTORE_MAGIC 0x544E464D
+#define FONTSTORE_MAX_FONTS 16
+
+// Glyph encodings, from mkfontstore.py without and with -s
+#define FONTSTORE_FORMAT_BITMAP 0
+#define FONTSTORE_FORMAT_SPANS 1
+
+// Glyphs are copied to the heap as text gets laid out, so rendering never
+// touches the flash. Text objects point at the copies, which keeps them
+// alive after they are evicted from here
+#define FONTSTORE_CACHE_SIZE 64
+
+typedef struct fontstore_header_t
+{
+    uint32_t magic;
+    uint16_t font_num;
+    uint16_t reserved;
+} fontstore_header_t;
+
+typedef struct fontstore_entry_t
+{
+    uint8_t height;
+    uint8_t format;
+    uint16_t first;
+    uint16_t last;
+    uint16_t reserved2;
+    uint32_t index;
+} fontstore_entry_t;
+
+MP_REGISTER_ROOT_POINTER(uint8_t *fontstore_cache[FONTSTORE_CACHE_SIZE]);
+
+static struct fontstore_cache_key_t
+{
+    uint32_t index;
+    unichar c;
+    uint32_t last_used;
+} cache_keys[FONTSTORE_CACHE_SIZE];
+
+static uint32_t cache_tick = 0;
+
+static size_t read_entries(fontstore_entry_t *entries)
+{
+    fontstore_header_t header;
+    monocle_flash_read((uint8_t *)&header, FONTSTORE_START, sizeof(header));
+
+    if (header.magic != FONTSTORE_MAGIC || header.font_num > FONTSTORE_MAX_FONTS)
+    {
+        return 0;
+    }
+
+    monocle_flash_read((uint8_t *)entries,
+                       FONTSTORE_START + sizeof(header),
+                       header.font_num * sizeof(*entries));
+
+    return header.font_num;
+}
+
+bool fontstore_find(uint8_t height, fontstore_font_t *font)
+{
+    fontstore_entry_t entries[FONTSTORE_MAX_FONTS];
+    size_t font_num = read_entries(entries);
+
+    for (size_t i = 0; i < font_num; i++)
+    {
+        if (entries[i].height != height)
+        {
+            continue;
+        }
+
+        uint32_t index_len = (entries[i].last - entries[i].first + 1) * 4;
+
+        if (entries[i].last < entries[i].first ||
+            entries[i].index + index_len > FONTSTORE_LENGTH)
+        {
+            mp_raise_ValueError(MP_ERROR_TEXT("font store is corrupted"));
+        }
+
+        font->height = entries[i].height;
+        font->first = entries[i].first;
+        font->last = entries[i].last;
+        font->index = entries[i].index;
+        font->spans = entries[i].format == FONTSTORE_FORMAT_SPANS;
+        return true;
+    }
+
+    return false;
+}
+
+mp_obj_t fontstore_list(void)
+{
+    fontstore_entry_t entries[FONTSTORE_MAX_FONTS];
+    size_t font_num = read_entries(entries);
+
+    mp_obj_t heights[FONTSTORE_MAX_FONTS];
+    for (size_t i = 0; i < font_num; i++)
+    {
+        heights[i] = MP_OBJ_NEW_SMALL_INT(entries[i].height);
+    }
+
+    return mp_obj_new_tuple(font_num, heights);
+}
+
+static uint8_t *load_glyph(fontstore_font_t const *font, unichar c)
+{
+    uint32_t address;
+    monocle_flash_read((uint8_t *)&address,
+                       FONTSTORE_START + font->index + (c - font->first) * 4,
+                       sizeof(address));
+
+    uint8_t width;
+    if (address >= FONTSTORE_LENGTH)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("font store is corrupted"));
+    }
+    monocle_flash_read(&width, FONTSTORE_START + address, sizeof(width));
+
+    size_t size = 1 + (width * font->height + 7) / 8;
+
+    if (font->spans)
+    {
+        // The last entry of the row table is the number of spans
+        uint8_t span_num;
+        monocle_flash_read(&span_num,
+                           FONTSTORE_START + address + 1 + font->height,
+                           sizeof(span_num));
+        size = 1 + font->height + 1 + span_num * 2;
+    }
+    if (address + size > FONTSTORE_LENGTH)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("font store is corrupted"));
+    }
+
+    uint8_t *glyph = m_new(uint8_t, size);
+    monocle_flash_read(glyph, FONTSTORE_START + address, size);
+    return glyph;
+}
+
+uint8_t const *fontstore_glyph(fontstore_font_t const *font, unichar c)
+{
+    // Codepoints the font doesn't have are drawn as a space, like ASCII
+    if (c < font->first || c > font->last)
+    {
+        c = ' ' < font->first ? font->first : ' ';
+    }
+
+    size_t victim = 0;
+
+    for (size_t i = 0; i < FONTSTORE_CACHE_SIZE; i++)
+    {
+        struct fontstore_cache_key_t *key = &cache_keys[i];
+
+        if (MP_STATE_PORT(fontstore_cache)[i] != NULL &&
+            key->index == font->index &&
+            key->c == c)
+        {
+            key->last_used = ++cache_tick;
+            return MP_STATE_PORT(fontstore_cache)[i];
+        }
+
+        // Prefer a free slot, or else the least recently used one
+        if (MP_STATE_PORT(fontstore_cache)[victim] != NULL &&
+            (MP_STATE_PORT(fontstore_cache)[i] == NULL ||
+             key->last_used < cache_keys[victim].last_used))
+        {
+            victim = i;
+        }
+    }
+
+    uint8_t *glyph = load_glyph(font, c);
+
+    MP_STATE_PORT(fontstore_cache)[victim] = glyph;
+    cache_keys[victim].index = font->index;
+    cache_keys[victim].c = c;
+    cache_keys[victim].last_used = ++cache_tick;
+    return glyph;
+}
+
+void fontstore_reset(void)
+{
+    // Text already laid out keeps its own copies of the old glyphs
+    for (size_t i = 0; i < FONTSTORE_CACHE_SIZE; i++)
+    {
+        MP_STATE_PORT(fontstore_cache)[i] = NULL;
+    }
+}
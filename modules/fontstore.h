@@ -0,0 +1,60 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "py/obj.h"
+
+/**
+ * Fonts kept in a reserved region of the external flash, so that more sizes
+ * and non-ASCII glyphs don't take internal flash. tools/fontgen/mkfontstore.py
+ * builds the image and update.Assets writes it.
+ *
+ * The region starts with a header listing the fonts, and each font has an
+ * index of glyph addresses for its range of codepoints. Glyphs use the same
+ * encodings as txt2cfont: a width byte followed by the bitmap, or with spans
+ * set, by the rows of spans.
+ */
+
+#define FONTSTORE_START 0xF0000
+#define FONTSTORE_LENGTH 0x10000
+
+typedef struct fontstore_font_t
+{
+    uint8_t height;
+    uint16_t first;
+    uint16_t last;
+    uint32_t index;
+    bool spans;
+} fontstore_font_t;
+
+bool fontstore_find(uint8_t height, fontstore_font_t *font);
+
+uint8_t const *fontstore_glyph(fontstore_font_t const *font, unichar c);
+
+mp_obj_t fontstore_list(void);
+
+void fontstore_reset(void);
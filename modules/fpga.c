@@ -22,50 +22,70 @@
  * PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <string.h>
 #include "monocle.h"
 #include "nrf_gpio.h"
+#include "py/mphal.h"
 #include "py/runtime.h"
 
 static bool fpga_running_flag = true;
 
 STATIC mp_obj_t fpga_read(mp_obj_t addr_16bit, mp_obj_t n)
 {
-    if (mp_obj_get_int(n) < 1 || mp_obj_get_int(n) > 255)
+    if (mp_obj_get_int(n) < 1)
     {
         mp_raise_ValueError(
-            MP_ERROR_TEXT("n must be between 1 and 255"));
+            MP_ERROR_TEXT("n must be at least 1"));
     }
 
     uint16_t addr = mp_obj_get_int(addr_16bit);
     uint8_t addr_bytes[2] = {(uint8_t)(addr >> 8), (uint8_t)addr};
 
-    uint8_t *buffer = m_malloc(mp_obj_get_int(n));
+    // Read straight into the bytes object, the SPI driver chains DMA chunks
+    vstr_t vstr;
+    vstr_init_len(&vstr, mp_obj_get_int(n));
 
     monocle_spi_write(FPGA, addr_bytes, 2, true);
-    monocle_spi_read(FPGA, buffer, mp_obj_get_int(n), false);
+    monocle_spi_read(FPGA, (uint8_t *)vstr.buf, vstr.len, false);
 
-    mp_obj_t bytes = mp_obj_new_bytes(buffer, mp_obj_get_int(n));
-
-    m_free(buffer);
-
-    return bytes;
+    return mp_obj_new_bytes_from_vstr(&vstr);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(fpga_read_obj, fpga_read);
 
-STATIC mp_obj_t fpga_write(mp_obj_t addr_16bit, mp_obj_t bytes)
+STATIC mp_obj_t fpga_read_into(mp_obj_t addr_16bit, mp_obj_t buf)
 {
-    size_t n;
-    const char *buffer = mp_obj_str_get_data(bytes, &n);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf, &bufinfo, MP_BUFFER_WRITE);
 
-    if (n > 255)
+    if (bufinfo.len < 1)
     {
         mp_raise_ValueError(
-            MP_ERROR_TEXT("input buffer size must be less than 255 bytes"));
+            MP_ERROR_TEXT("buffer must be at least 1 byte"));
     }
 
     uint16_t addr = mp_obj_get_int(addr_16bit);
     uint8_t addr_bytes[2] = {(uint8_t)(addr >> 8), (uint8_t)addr};
 
+    // Same transfer as fpga.read() but into a buffer the caller reuses
+    monocle_spi_write(FPGA, addr_bytes, 2, true);
+    monocle_spi_read(FPGA, bufinfo.buf, bufinfo.len, false);
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(fpga_read_into_obj, fpga_read_into);
+
+STATIC mp_obj_t fpga_write(mp_obj_t addr_16bit, mp_obj_t bytes)
+{
+    size_t n;
+    const char *buffer = mp_obj_str_get_data(bytes, &n);
+    monocle_spi_check_buffer(buffer, n);
+
+    uint16_t addr = mp_obj_get_int(addr_16bit);
+    uint8_t addr_bytes[2] = {(uint8_t)(addr >> 8), (uint8_t)addr};
+
+    // fpga.wait() reports completion of the latest write only
+    monocle_fpga_irq_clear();
+
     if (n == 0)
     {
         monocle_spi_write(FPGA, addr_bytes, 2, false);
@@ -80,6 +100,34 @@ STATIC mp_obj_t fpga_write(mp_obj_t addr_16bit, mp_obj_t bytes)
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(fpga_write_obj, fpga_write);
 
+STATIC mp_obj_t fpga_wait(size_t n_args, const mp_obj_t *args)
+{
+    mp_int_t timeout = n_args > 0 ? mp_obj_get_int(args[0]) : 100;
+
+    if (timeout < 0)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("timeout must be positive"));
+    }
+
+    // A timeout of 0 only polls, which lets uasyncio tasks wait in a loop
+    uint32_t start_time = mp_hal_ticks_ms();
+
+    while (!monocle_fpga_irq_pending())
+    {
+        mp_uint_t elapsed = mp_hal_ticks_ms() - start_time;
+
+        if (elapsed >= (mp_uint_t)timeout)
+        {
+            return mp_const_false;
+        }
+
+        mp_hal_poll_hook_ms(timeout - elapsed);
+    }
+
+    return mp_const_true;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(fpga_wait_obj, 0, 1, fpga_wait);
+
 STATIC mp_obj_t fpga_run(size_t n_args, const mp_obj_t *args)
 {
     if (n_args == 0)
@@ -102,11 +150,148 @@ STATIC mp_obj_t fpga_run(size_t n_args, const mp_obj_t *args)
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(fpga_run_obj, 0, 1, fpga_run);
 
+// Each compiled command is the address, payload length and wait timeout,
+// all 16-bit, followed by the payload
+#define BATCH_HEADER_LENGTH 6
+
+typedef struct fpga_batch_obj_t
+{
+    mp_obj_base_t base;
+    size_t len;
+    uint8_t *commands;
+} fpga_batch_obj_t;
+
+const mp_obj_type_t fpga_batch_type;
+
+STATIC mp_obj_t fpga_batch_make_new(const mp_obj_type_t *type, size_t n_args,
+                                    size_t n_kw, const mp_obj_t *args)
+{
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+
+    size_t entry_num;
+    mp_obj_t *entries;
+    mp_obj_get_array(args[0], &entry_num, &entries);
+
+    // Sized first, so the buffer is allocated once
+    size_t len = 0;
+    for (size_t i = 0; i < entry_num; i++)
+    {
+        size_t item_num;
+        mp_obj_t *items;
+        mp_obj_get_array(entries[i], &item_num, &items);
+
+        if (item_num < 2 || item_num > 3)
+        {
+            mp_raise_ValueError(
+                MP_ERROR_TEXT("entries must be (address, payload) or (address, payload, wait)"));
+        }
+
+        size_t n;
+        mp_obj_str_get_data(items[1], &n);
+
+        if (n > 0xFFFF)
+        {
+            mp_raise_ValueError(MP_ERROR_TEXT("payload is too long"));
+        }
+
+        len += BATCH_HEADER_LENGTH + n;
+    }
+
+    fpga_batch_obj_t *self = mp_obj_malloc(fpga_batch_obj_t, &fpga_batch_type);
+    self->len = len;
+    self->commands = m_new(uint8_t, len);
+
+    uint8_t *command = self->commands;
+    for (size_t i = 0; i < entry_num; i++)
+    {
+        size_t item_num;
+        mp_obj_t *items;
+        mp_obj_get_array(entries[i], &item_num, &items);
+
+        uint16_t addr = mp_obj_get_int(items[0]);
+        mp_int_t wait = item_num == 3 ? mp_obj_get_int(items[2]) : 0;
+
+        if (wait < 0 || wait > 0xFFFF)
+        {
+            mp_raise_ValueError(MP_ERROR_TEXT("wait must be between 0 and 65535"));
+        }
+
+        size_t n;
+        const char *payload = mp_obj_str_get_data(items[1], &n);
+
+        command[0] = addr >> 8;
+        command[1] = addr;
+        command[2] = n;
+        command[3] = n >> 8;
+        command[4] = wait;
+        command[5] = wait >> 8;
+        memcpy(&command[BATCH_HEADER_LENGTH], payload, n);
+        command += BATCH_HEADER_LENGTH + n;
+    }
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+STATIC mp_obj_t fpga_batch_run(mp_obj_t self_in)
+{
+    fpga_batch_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    uint8_t *command = self->commands;
+    uint8_t *end = self->commands + self->len;
+    bool completed = true;
+
+    // Commands are queued back to back, and only waited on for a timeout.
+    // Like fpga.wait(), a timeout doesn't stop the following commands.
+    while (command < end)
+    {
+        size_t n = command[2] | command[3] << 8;
+        uint16_t wait = command[4] | command[5] << 8;
+
+        if (wait > 0)
+        {
+            monocle_spi_wait();
+            monocle_fpga_irq_clear();
+        }
+
+        monocle_spi_write_async(FPGA, command, 2, n > 0);
+        if (n > 0)
+        {
+            monocle_spi_write_async(FPGA, &command[BATCH_HEADER_LENGTH], n, false);
+        }
+
+        if (wait > 0)
+        {
+            monocle_spi_wait();
+            completed &= monocle_fpga_irq_wait(wait);
+        }
+
+        command += BATCH_HEADER_LENGTH + n;
+    }
+
+    monocle_spi_wait();
+    return mp_obj_new_bool(completed);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(fpga_batch_run_obj, fpga_batch_run);
+
+STATIC const mp_rom_map_elem_t fpga_batch_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_run), MP_ROM_PTR(&fpga_batch_run_obj)},
+};
+STATIC MP_DEFINE_CONST_DICT(fpga_batch_locals_dict, fpga_batch_locals_dict_table);
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    fpga_batch_type,
+    MP_QSTR_Batch,
+    MP_TYPE_FLAG_NONE,
+    make_new, fpga_batch_make_new,
+    locals_dict, &fpga_batch_locals_dict);
+
 STATIC const mp_rom_map_elem_t fpga_module_globals_table[] = {
 
     {MP_ROM_QSTR(MP_QSTR_read), MP_ROM_PTR(&fpga_read_obj)},
+    {MP_ROM_QSTR(MP_QSTR_read_into), MP_ROM_PTR(&fpga_read_into_obj)},
     {MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&fpga_write_obj)},
+    {MP_ROM_QSTR(MP_QSTR_wait), MP_ROM_PTR(&fpga_wait_obj)},
     {MP_ROM_QSTR(MP_QSTR_run), MP_ROM_PTR(&fpga_run_obj)},
+    {MP_ROM_QSTR(MP_QSTR_Batch), MP_ROM_PTR(&fpga_batch_type)},
 };
 STATIC MP_DEFINE_CONST_DICT(fpga_module_globals, fpga_module_globals_table);
 
@@ -23,6 +23,8 @@
 #
 
 module("_mountfs.py")
+module("_mpycache.py")
+module("benchmark.py")
 module("camera.py")
 module("display.py")
 module("microphone.py")
@@ -0,0 +1,172 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Streaming inflate built on uzlib. Chunks of deflate or zlib data are
+ * pushed in as they arrive, and the output is handed over in small pieces.
+ *
+ * uzlib can't pause in the middle of a symbol, so the decoder only runs
+ * while more than INFLATE_INPUT_MARGIN bytes are buffered. The rest is
+ * decoded by inflate_stream_finish() once the input has ended.
+ */
+
+#include <string.h>
+#include "inflate.h"
+#include "py/misc.h"
+
+void inflate_stream_init(inflate_stream_t *stream,
+                         bool zlib_header,
+                         inflate_output_t output_handler,
+                         void *context)
+{
+    memset(&stream->decomp, 0, sizeof(stream->decomp));
+    uzlib_uncompress_init(&stream->decomp,
+                          stream->window,
+                          sizeof(stream->window));
+
+    stream->decomp.source = stream->input;
+    stream->decomp.source_limit = stream->input;
+    stream->decomp.dest_start = stream->output;
+    stream->decomp.dest = stream->output;
+
+    stream->zlib_header = zlib_header;
+    stream->started = !zlib_header;
+    stream->done = false;
+    stream->output_handler = output_handler;
+    stream->context = context;
+}
+
+static size_t input_remaining(inflate_stream_t *stream)
+{
+    return stream->decomp.source_limit - stream->decomp.source;
+}
+
+static void flush_output(inflate_stream_t *stream)
+{
+    size_t len = stream->decomp.dest - stream->output;
+
+    if (len > 0)
+    {
+        stream->output_handler(stream->context, stream->output, len);
+        stream->decomp.dest = stream->output;
+    }
+}
+
+static int run(inflate_stream_t *stream, size_t reserve, bool final)
+{
+    if (!stream->started)
+    {
+        if (input_remaining(stream) < 2 && !final)
+        {
+            return TINF_OK;
+        }
+
+        // Returns the log2 of the window size, less 8
+        int window_bits = uzlib_zlib_parse_header(&stream->decomp);
+
+        if (window_bits < 0 || (1 << (window_bits + 8)) > INFLATE_WINDOW_SIZE)
+        {
+            return TINF_DICT_ERROR;
+        }
+
+        stream->started = true;
+    }
+
+    while (!stream->done && (final || input_remaining(stream) > reserve))
+    {
+        // A single byte at a time so that we never run far past the margin
+        stream->decomp.dest_limit = stream->decomp.dest + 1;
+
+        int status = uzlib_uncompress_chksum(&stream->decomp);
+
+        if (stream->decomp.dest == stream->output + sizeof(stream->output))
+        {
+            flush_output(stream);
+        }
+
+        if (status == TINF_DONE)
+        {
+            stream->done = true;
+            break;
+        }
+
+        if (status < 0)
+        {
+            return status;
+        }
+
+        // Running out of data before the end means the stream was truncated
+        if (final && stream->decomp.eof)
+        {
+            return TINF_DATA_ERROR;
+        }
+    }
+
+    flush_output(stream);
+
+    // Move what's left to the front, ready for the next chunk
+    size_t remaining = input_remaining(stream);
+    memmove(stream->input, stream->decomp.source, remaining);
+    stream->decomp.source = stream->input;
+    stream->decomp.source_limit = stream->input + remaining;
+
+    return stream->done ? TINF_DONE : TINF_OK;
+}
+
+int inflate_stream_write(inflate_stream_t *stream,
+                         const uint8_t *bytes,
+                         size_t len)
+{
+    int status = TINF_OK;
+
+    while (len > 0 && !stream->done)
+    {
+        size_t space = sizeof(stream->input) - input_remaining(stream);
+        size_t chunk = MIN(len, space);
+
+        memcpy((uint8_t *)stream->decomp.source_limit, bytes, chunk);
+        stream->decomp.source_limit += chunk;
+        bytes += chunk;
+        len -= chunk;
+
+        status = run(stream, INFLATE_INPUT_MARGIN, false);
+
+        if (status < 0)
+        {
+            return status;
+        }
+    }
+
+    return status;
+}
+
+int inflate_stream_finish(inflate_stream_t *stream)
+{
+    if (stream->done)
+    {
+        return TINF_DONE;
+    }
+
+    return run(stream, 0, true);
+}
@@ -0,0 +1,62 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lib/uzlib/uzlib.h"
+
+// Largest deflate window supported. Compress with wbits of 12 or less
+#define INFLATE_WINDOW_SIZE 4096
+
+// Compressed bytes held back until more arrive, enough for any block header
+#define INFLATE_INPUT_MARGIN 320
+
+typedef void (*inflate_output_t)(void *context, const uint8_t *bytes, size_t len);
+
+typedef struct inflate_stream_t
+{
+    TINF_DATA decomp;
+    uint8_t window[INFLATE_WINDOW_SIZE];
+    uint8_t input[1024];
+    uint8_t output[256];
+    bool zlib_header;
+    bool started;
+    bool done;
+    inflate_output_t output_handler;
+    void *context;
+} inflate_stream_t;
+
+void inflate_stream_init(inflate_stream_t *stream,
+                         bool zlib_header,
+                         inflate_output_t output_handler,
+                         void *context);
+
+int inflate_stream_write(inflate_stream_t *stream,
+                         const uint8_t *bytes,
+                         size_t len);
+
+int inflate_stream_finish(inflate_stream_t *stream);
@@ -0,0 +1,547 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include "bluetooth.h"
+#include "monocle.h"
+#include "mphalport.h"
+#include "nrf_sdm.h"
+#include "nrf_soc.h"
+#include "nrfx_glue.h"
+#include "py/mphal.h"
+#include "py/runtime.h"
+
+// FPGA commands for the microphone FIFO, which holds 16-bit signed little
+// endian samples at 16kHz
+#define FPGA_MIC_STOP 0x0801
+#define FPGA_MIC_START 0x0802
+#define FPGA_MIC_DATA 0x0803
+#define MIC_SAMPLE_RATE 16000
+
+// TIMER1 schedules a burst read every block, well within the FIFO depth
+#define MIC_BLOCK_SAMPLES (256)
+#define MIC_BLOCK_US (MIC_BLOCK_SAMPLES * 1000000 / MIC_SAMPLE_RATE)
+
+// Encoded audio waiting for read_into() or Bluetooth
+#define MIC_RING_SIZE (4096)
+
+typedef enum mic_encoding_t
+{
+    MIC_PCM,
+    MIC_ULAW,
+    MIC_ADPCM,
+} mic_encoding_t;
+
+static struct mic_state_t
+{
+    bool running;
+    bool bluetooth;
+    mic_encoding_t encoding;
+    uint8_t decimate;
+    uint8_t dma_next;
+    uint8_t dma_done;
+    volatile uint8_t dma_pending;
+    volatile uint8_t dma_ready;
+    uint8_t sequence;
+    int16_t predictor;
+    uint8_t step_index;
+} mic;
+
+static struct mic_stats_t
+{
+    uint32_t samples;
+    uint32_t bytes;
+    uint32_t overruns;
+    uint32_t dropped;
+} mic_stats;
+
+static int16_t mic_dma[2][MIC_BLOCK_SAMPLES];
+
+// Outside of mic, as a scheduled call may still be due across a restart
+static volatile bool mic_process_scheduled = false;
+
+static uint8_t mic_ring[MIC_RING_SIZE];
+static volatile size_t mic_ring_head = 0;
+static volatile size_t mic_ring_tail = 0;
+
+static size_t mic_ring_available(void)
+{
+    return (mic_ring_head + MIC_RING_SIZE - mic_ring_tail) % MIC_RING_SIZE;
+}
+
+static void mic_ring_push(uint8_t const *bytes, size_t len)
+{
+    size_t space = MIC_RING_SIZE - 1 - mic_ring_available();
+
+    if (len > space)
+    {
+        mic_stats.dropped += len - space;
+        len = space;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        mic_ring[mic_ring_head] = bytes[i];
+        mic_ring_head = (mic_ring_head + 1) % MIC_RING_SIZE;
+    }
+
+    mic_stats.bytes += len;
+}
+
+static size_t mic_ring_peek(uint8_t *bytes, size_t len)
+{
+    len = MIN(len, mic_ring_available());
+
+    for (size_t i = 0, tail = mic_ring_tail; i < len; i++)
+    {
+        bytes[i] = mic_ring[tail];
+        tail = (tail + 1) % MIC_RING_SIZE;
+    }
+
+    return len;
+}
+
+static void mic_ring_drop(size_t len)
+{
+    mic_ring_tail = (mic_ring_tail + len) % MIC_RING_SIZE;
+}
+
+static uint8_t mic_ulaw_encode(int16_t sample)
+{
+    int32_t magnitude = sample;
+    uint8_t sign = 0;
+
+    if (magnitude < 0)
+    {
+        magnitude = -magnitude;
+        sign = 0x80;
+    }
+
+    // G.711, with the bias that puts each segment on a power of two
+    magnitude = MIN(magnitude, 32635) + 0x84;
+
+    uint8_t exponent = 7;
+    for (int32_t mask = 0x4000; (magnitude & mask) == 0 && exponent > 0; mask >>= 1)
+    {
+        exponent--;
+    }
+
+    uint8_t mantissa = (magnitude >> (exponent + 3)) & 0x0F;
+    return ~(sign | exponent << 4 | mantissa);
+}
+
+static const int16_t adpcm_steps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+    230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+    963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+    3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+    9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385,
+    24623, 27086, 29794, 32767};
+
+static const int8_t adpcm_index_steps[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+static uint8_t mic_adpcm_encode(int16_t sample)
+{
+    int32_t step = adpcm_steps[mic.step_index];
+    int32_t diff = sample - mic.predictor;
+    int32_t delta = step >> 3;
+    uint8_t code = 0;
+
+    if (diff < 0)
+    {
+        code = 8;
+        diff = -diff;
+    }
+
+    // IMA-ADPCM, quantising the difference from the prediction to 3 bits
+    for (uint8_t bit = 4; bit > 0; bit >>= 1)
+    {
+        if (diff >= step)
+        {
+            code |= bit;
+            diff -= step;
+            delta += step;
+        }
+        step >>= 1;
+    }
+
+    int32_t predictor = mic.predictor + (code & 8 ? -delta : delta);
+    mic.predictor = MAX(-32768, MIN(32767, predictor));
+
+    int32_t index = mic.step_index + adpcm_index_steps[code & 7];
+    mic.step_index = MAX(0, MIN(88, index));
+
+    return code;
+}
+
+static void mic_forward(void)
+{
+    size_t max_payload = ble_get_max_payload_size();
+    uint8_t fragment[max_payload];
+
+    // Whatever doesn't fit in the notification queue waits for the next block
+    while (mic_ring_available() >= max_payload - 1)
+    {
+        size_t len = mic_ring_peek(&fragment[1], max_payload - 1);
+        fragment[0] = mic.sequence & STREAM_HEADER_SEQUENCE;
+
+        if (ble_send_raw_data(fragment, len + 1))
+        {
+            break;
+        }
+
+        mic.sequence++;
+        mic_ring_drop(len);
+    }
+}
+
+static void mic_encode(int16_t const *samples)
+{
+    uint8_t encoded[MIC_BLOCK_SAMPLES * 2];
+    size_t len = 0;
+
+    for (size_t i = 0; i < MIC_BLOCK_SAMPLES; i += mic.decimate)
+    {
+        // Averaging each group is a crude low pass before the decimation
+        int32_t sum = 0;
+        for (size_t j = 0; j < mic.decimate; j++)
+        {
+            sum += samples[i + j];
+        }
+        int16_t sample = sum / mic.decimate;
+        size_t n = i / mic.decimate;
+
+        switch (mic.encoding)
+        {
+        case MIC_PCM:
+            encoded[len++] = sample;
+            encoded[len++] = sample >> 8;
+            break;
+
+        case MIC_ULAW:
+            encoded[len++] = mic_ulaw_encode(sample);
+            break;
+
+        case MIC_ADPCM:
+            // Two samples per byte, the first one in the low nibble
+            if (n % 2 == 0)
+            {
+                encoded[len] = mic_adpcm_encode(sample);
+            }
+            else
+            {
+                encoded[len++] |= mic_adpcm_encode(sample) << 4;
+            }
+            break;
+        }
+    }
+
+    mic_stats.samples += MIC_BLOCK_SAMPLES / mic.decimate;
+    mic_ring_push(encoded, len);
+}
+
+// Encodes the blocks that are in, in order, then frees their buffers for
+// the timer to fill again
+static void mic_drain(void)
+{
+    while (mic.dma_ready > 0)
+    {
+        mic_encode(mic_dma[mic.dma_done]);
+        mic.dma_done ^= 1;
+
+        NRFX_CRITICAL_SECTION_ENTER();
+        mic.dma_ready--;
+        mic.dma_pending--;
+        NRFX_CRITICAL_SECTION_EXIT();
+    }
+
+    if (mic.bluetooth)
+    {
+        mic_forward();
+    }
+}
+
+STATIC mp_obj_t mic_process(mp_obj_t unused)
+{
+    (void)unused;
+
+    // Clear first so that blocks arriving while we work schedule again
+    mic_process_scheduled = false;
+    mic_drain();
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mic_process_obj, mic_process);
+
+static void mic_schedule(void)
+{
+    if (!mic_process_scheduled)
+    {
+        mic_process_scheduled = mp_sched_schedule(MP_OBJ_FROM_PTR(&mic_process_obj),
+                                                  mp_const_none);
+    }
+}
+
+// Runs from the SPIM interrupt once a block is in. Encoding and sending it
+// is left to the bottom half, off the interrupt stack
+static void mic_block_done(void *context)
+{
+    (void)context;
+
+    mic.dma_ready++;
+    mic_schedule();
+}
+
+void TIMER1_IRQHandler(void)
+{
+    NRF_TIMER1->EVENTS_COMPARE[0] = 0;
+    (void)NRF_TIMER1->EVENTS_COMPARE[0];
+
+    // Both buffers are still in flight, or the bus is in the middle of a
+    // transaction, so this block is left for the FIFO to absorb
+    if (mic.dma_pending == 2 || !monocle_spi_can_submit(2))
+    {
+        mic_stats.overruns++;
+
+        // In case the scheduler queue was full when the blocks came in
+        if (mic.dma_ready > 0)
+        {
+            mic_schedule();
+        }
+        return;
+    }
+
+    int16_t *buffer = mic_dma[mic.dma_next];
+    mic.dma_next ^= 1;
+    mic.dma_pending++;
+
+    uint8_t addr_bytes[2] = {FPGA_MIC_DATA >> 8, FPGA_MIC_DATA & 0xFF};
+    monocle_spi_write_async(FPGA, addr_bytes, 2, true);
+
+    spi_transaction_t transaction = {
+        .device = FPGA,
+        .rx = (uint8_t *)buffer,
+        .length = sizeof(mic_dma[0]),
+        .callback = mic_block_done,
+        .context = buffer,
+    };
+    monocle_spi_submit(&transaction);
+}
+
+STATIC void mic_timer_stop(void)
+{
+    NRF_TIMER1->TASKS_STOP = 1;
+    NRF_TIMER1->INTENCLR = TIMER_INTENCLR_COMPARE0_Msk;
+    app_err(sd_nvic_DisableIRQ(TIMER1_IRQn));
+}
+
+STATIC mp_obj_t microphone_start(size_t n_args, const mp_obj_t *pos_args,
+                                 mp_map_t *kw_args)
+{
+    enum
+    {
+        ARG_sample_rate,
+        ARG_encoding,
+        ARG_bluetooth,
+    };
+
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_sample_rate, MP_ARG_INT, {.u_int = MIC_SAMPLE_RATE}},
+        {MP_QSTR_encoding, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_QSTR(MP_QSTR_PCM)}},
+        {MP_QSTR_bluetooth, MP_ARG_BOOL, {.u_bool = false}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args,
+                     MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_int_t rate = args[ARG_sample_rate].u_int;
+    if (rate != 16000 && rate != 8000 && rate != 4000)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("sample_rate must be 16000, 8000 or 4000"));
+    }
+
+    qstr encoding = mp_obj_str_get_qstr(args[ARG_encoding].u_obj);
+    if (encoding != MP_QSTR_PCM && encoding != MP_QSTR_ULAW && encoding != MP_QSTR_ADPCM)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("encoding must be PCM, ULAW or ADPCM"));
+    }
+
+    bool bluetooth = args[ARG_bluetooth].u_bool;
+    if (bluetooth && !ble_are_tx_notifications_enabled(DATA_TX))
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT(
+                         "notifications are not enabled on the data service"));
+    }
+
+    if (bluetooth && ble_get_max_payload_size() < 2)
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("MTU is too small for streaming"));
+    }
+
+    mic_timer_stop();
+    monocle_spi_wait();
+
+    memset(&mic, 0, sizeof(mic));
+    memset(&mic_stats, 0, sizeof(mic_stats));
+    mic_ring_head = mic_ring_tail = 0;
+
+    mic.decimate = MIC_SAMPLE_RATE / rate;
+    mic.encoding = encoding == MP_QSTR_ULAW    ? MIC_ULAW
+                   : encoding == MP_QSTR_ADPCM ? MIC_ADPCM
+                                               : MIC_PCM;
+    mic.bluetooth = bluetooth;
+    mic.running = true;
+
+    uint8_t start_command[2] = {FPGA_MIC_START >> 8, FPGA_MIC_START & 0xFF};
+    monocle_spi_write(FPGA, start_command, 2, false);
+
+    NRF_TIMER1->TASKS_CLEAR = 1;
+    NRF_TIMER1->MODE = TIMER_MODE_MODE_Timer;
+    NRF_TIMER1->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER1->PRESCALER = 4; // 16MHz / 2^4 = 1MHz
+    NRF_TIMER1->CC[0] = MIC_BLOCK_US;
+    NRF_TIMER1->SHORTS = TIMER_SHORTS_COMPARE0_CLEAR_Msk;
+    NRF_TIMER1->EVENTS_COMPARE[0] = 0;
+    NRF_TIMER1->INTENSET = TIMER_INTENSET_COMPARE0_Msk;
+
+    app_err(sd_nvic_SetPriority(TIMER1_IRQn, NRFX_TIMER_DEFAULT_CONFIG_IRQ_PRIORITY));
+    app_err(sd_nvic_ClearPendingIRQ(TIMER1_IRQn));
+    app_err(sd_nvic_EnableIRQ(TIMER1_IRQn));
+
+    NRF_TIMER1->TASKS_START = 1;
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(microphone_start_obj, 0, microphone_start);
+
+STATIC mp_obj_t microphone_stop(void)
+{
+    if (!mic.running)
+    {
+        return mp_const_none;
+    }
+
+    mic_timer_stop();
+    monocle_spi_wait();
+    mic_drain();
+    mic.running = false;
+
+    uint8_t stop_command[2] = {FPGA_MIC_STOP >> 8, FPGA_MIC_STOP & 0xFF};
+    monocle_spi_write(FPGA, stop_command, 2, false);
+
+    if (!mic.bluetooth)
+    {
+        return mp_const_none;
+    }
+
+    // Send what is left, the last fragment marking the end of the stream
+    size_t max_payload = ble_get_max_payload_size();
+    uint8_t fragment[max_payload];
+
+    do
+    {
+        size_t len = mic_ring_peek(&fragment[1], max_payload - 1);
+        fragment[0] = mic.sequence & STREAM_HEADER_SEQUENCE;
+        if (len == mic_ring_available())
+        {
+            fragment[0] |= STREAM_HEADER_LAST;
+        }
+
+        while (ble_send_raw_data(fragment, len + 1))
+        {
+            if (!ble_are_tx_notifications_enabled(DATA_TX))
+            {
+                mic_ring_head = mic_ring_tail = 0;
+                return mp_const_none;
+            }
+            MICROPY_EVENT_POLL_HOOK;
+        }
+
+        mic.sequence++;
+        mic_ring_drop(len);
+    } while (mic_ring_available() > 0);
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(microphone_stop_obj, microphone_stop);
+
+STATIC mp_obj_t microphone_read_into(mp_obj_t buffer_in)
+{
+    if (mic.bluetooth)
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("microphone is streaming to bluetooth"));
+    }
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer_in, &bufinfo, MP_BUFFER_WRITE);
+
+    mic_drain();
+    size_t len = mic_ring_peek(bufinfo.buf, bufinfo.len);
+    mic_ring_drop(len);
+
+    return MP_OBJ_NEW_SMALL_INT(len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(microphone_read_into_obj, microphone_read_into);
+
+STATIC mp_obj_t microphone_any(void)
+{
+    return MP_OBJ_NEW_SMALL_INT(mic_ring_available());
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(microphone_any_obj, microphone_any);
+
+STATIC mp_obj_t microphone_stats(void)
+{
+    mp_obj_t dict = mp_obj_new_dict(4);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_samples),
+                      mp_obj_new_int_from_uint(mic_stats.samples));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes),
+                      mp_obj_new_int_from_uint(mic_stats.bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_overruns),
+                      mp_obj_new_int_from_uint(mic_stats.overruns));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_dropped),
+                      mp_obj_new_int_from_uint(mic_stats.dropped));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(microphone_stats_obj, microphone_stats);
+
+STATIC const mp_rom_map_elem_t microphone_module_globals_table[] = {
+
+    {MP_ROM_QSTR(MP_QSTR_start), MP_ROM_PTR(&microphone_start_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stop), MP_ROM_PTR(&microphone_stop_obj)},
+    {MP_ROM_QSTR(MP_QSTR_read_into), MP_ROM_PTR(&microphone_read_into_obj)},
+    {MP_ROM_QSTR(MP_QSTR_any), MP_ROM_PTR(&microphone_any_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&microphone_stats_obj)},
+};
+STATIC MP_DEFINE_CONST_DICT(microphone_module_globals, microphone_module_globals_table);
+
+const mp_obj_module_t microphone_module = {
+    .base = {&mp_type_module},
+    .globals = (mp_obj_dict_t *)&microphone_module_globals,
+};
+MP_REGISTER_MODULE(MP_QSTR___microphone, microphone_module);
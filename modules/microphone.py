@@ -20,4 +20,25 @@
 # LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
 # OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
 # PERFORMANCE OF THIS SOFTWARE.
-#
\ No newline at end of file
+#
+
+import __microphone
+
+PCM = 'PCM'
+ULAW = 'ULAW'
+ADPCM = 'ADPCM'
+
+def start(sample_rate=16000, encoding=PCM, bluetooth=False):
+  __microphone.start(sample_rate=sample_rate, encoding=encoding, bluetooth=bluetooth)
+
+def stop():
+  __microphone.stop()
+
+def read_into(buffer):
+  return __microphone.read_into(buffer)
+
+def any():
+  return __microphone.any()
+
+def stats():
+  return __microphone.stats()
@@ -22,6 +22,7 @@
  * PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include "display.h"
 #include "monocle.h"
 
 uint8_t fpga_graphics_dev()
@@ -32,4 +33,28 @@ uint8_t fpga_graphics_dev()
 void fpga_write_internal(uint8_t *buf, unsigned int len, bool hold)
 {
     monocle_spi_write(FPGA, buf, len, hold);
-}
\ No newline at end of file
+}
+// None of the FPGA images released so far include the vector engine, and
+// there is no capability register to probe it yet. Until there is, the
+// display keeps rasterizing on the CPU.
+static bool fpga_graphics_available(void)
+{
+    return false;
+}
+
+static bool fpga_graphics_accepts(display_primitive_t const *primitive)
+{
+    (void)primitive;
+    return false;
+}
+
+static void fpga_graphics_draw(display_primitive_t const *primitive)
+{
+    (void)primitive;
+}
+
+const display_backend_t display_fpga_backend = {
+    .available = fpga_graphics_available,
+    .accepts = fpga_graphics_accepts,
+    .draw = fpga_graphics_draw,
+};
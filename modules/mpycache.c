@@ -0,0 +1,154 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include "extmod/vfs.h"
+#include "mpycache.h"
+#include "py/builtin.h"
+#include "py/compile.h"
+#include "py/mphal.h"
+#include "py/persistentcode.h"
+#include "py/runtime.h"
+#include "py/stream.h"
+#include "shared/readline/readline.h"
+
+// Cached modules live here rather than beside their source, because import
+// tries foo.py before foo.mpy within the same directory
+#define MPYCACHE_MAIN "/.mpy/main.mpy"
+
+// Appended after the bytecode, which the loader never reads that far
+#define MPYCACHE_MAGIC "MPYC"
+
+typedef struct mpycache_writer_t
+{
+    mp_obj_t file;
+    int errcode;
+} mpycache_writer_t;
+
+STATIC void mpycache_write(void *data, const char *str, size_t len)
+{
+    mpycache_writer_t *writer = data;
+
+    if (writer->errcode == 0)
+    {
+        mp_stream_rw(writer->file, (void *)str, len, &writer->errcode,
+                     MP_STREAM_RW_WRITE);
+    }
+}
+
+STATIC mp_obj_t mpycache_compile(mp_obj_t source, mp_obj_t cached, mp_obj_t hash)
+{
+    mp_uint_t crc = mp_obj_get_int_truncated(hash);
+
+    // Compile everything before opening the output, so errors leave no file
+    mp_lexer_t *lex = mp_lexer_new_from_file(qstr_from_str(mp_obj_str_get_str(source)));
+    qstr source_name = lex->source_name;
+    mp_parse_tree_t parse_tree = mp_parse(lex, MP_PARSE_FILE_INPUT);
+    mp_module_context_t *context = m_new_obj(mp_module_context_t);
+    mp_compiled_module_t cm = mp_compile_to_raw_code(&parse_tree,
+                                                     source_name,
+                                                     false,
+                                                     context);
+
+    mp_obj_t open_args[2] = {cached, MP_OBJ_NEW_QSTR(MP_QSTR_wb)};
+    mpycache_writer_t writer = {
+        .file = mp_vfs_open(2, open_args, (mp_map_t *)&mp_const_empty_map),
+        .errcode = 0,
+    };
+    mp_print_t print = {&writer, mpycache_write};
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0)
+    {
+        mp_raw_code_save(&cm, &print);
+
+        uint8_t footer[8] = {crc, crc >> 8, crc >> 16, crc >> 24};
+        memcpy(&footer[4], MPYCACHE_MAGIC, 4);
+        mpycache_write(&writer, (const char *)footer, sizeof(footer));
+
+        nlr_pop();
+    }
+    else
+    {
+        mp_stream_close(writer.file);
+        nlr_jump(nlr.ret_val);
+    }
+
+    mp_stream_close(writer.file);
+
+    if (writer.errcode != 0)
+    {
+        mp_raise_OSError(writer.errcode);
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(mpycache_compile_obj, mpycache_compile);
+
+bool mpycache_exec_main(void)
+{
+    if (mp_import_stat(MPYCACHE_MAIN) != MP_IMPORT_STAT_FILE)
+    {
+        return false;
+    }
+
+    // Runs like pyexec_file() would, in the globals of __main__
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0)
+    {
+        mp_module_context_t *context = m_new_obj(mp_module_context_t);
+        context->module.globals = mp_globals_get();
+        mp_compiled_module_t cm;
+        cm.context = context;
+        mp_raw_code_load_file(qstr_from_str(MPYCACHE_MAIN), &cm);
+        mp_obj_t main = mp_make_function_from_raw_code(cm.rc, context, NULL);
+
+        mp_hal_set_interrupt_char(CHAR_CTRL_C);
+        mp_call_function_0(main);
+        mp_hal_set_interrupt_char(-1);
+        mp_handle_pending(true);
+
+        nlr_pop();
+    }
+    else
+    {
+        mp_hal_set_interrupt_char(-1);
+        mp_handle_pending(false);
+        mp_obj_print_exception(&mp_plat_print, MP_OBJ_FROM_PTR(nlr.ret_val));
+    }
+
+    return true;
+}
+
+STATIC const mp_rom_map_elem_t mpycache_module_globals_table[] = {
+
+    {MP_ROM_QSTR(MP_QSTR_compile), MP_ROM_PTR(&mpycache_compile_obj)},
+};
+STATIC MP_DEFINE_CONST_DICT(mpycache_module_globals, mpycache_module_globals_table);
+
+const mp_obj_module_t mpycache_module = {
+    .base = {&mp_type_module},
+    .globals = (mp_obj_dict_t *)&mpycache_module_globals,
+};
+MP_REGISTER_MODULE(MP_QSTR___mpycache, mpycache_module);
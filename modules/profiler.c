@@ -0,0 +1,236 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include "monocle.h"
+#include "nrf_sdm.h"
+#include "nrf_soc.h"
+#include "py/runtime.h"
+
+// Sampling interrupts everything at the default priority of 7, including the
+// SPI and GPIOTE handlers, but not the SoftDevice
+#define PROFILER_IRQ_PRIORITY (6)
+
+// Samples give up on a full table after probing this many slots
+#define PROFILER_MAX_PROBES (8)
+
+typedef struct profiler_slot_t
+{
+    uint32_t pc;
+    uint32_t count;
+} profiler_slot_t;
+
+MP_REGISTER_ROOT_POINTER(void *profiler_slots);
+
+static size_t profiler_slot_num = 0;
+static uint32_t profiler_rate_hz = 0;
+static volatile uint32_t profiler_samples = 0;
+static volatile uint32_t profiler_dropped = 0;
+
+// Called from the assembly below, so it must keep its name with LTO
+__attribute__((used)) void profiler_sample(const uint32_t *frame)
+{
+    NRF_TIMER2->EVENTS_COMPARE[0] = 0;
+    (void)NRF_TIMER2->EVENTS_COMPARE[0];
+
+    // The exception frame holds r0-r3, r12, lr, pc and xpsr
+    uint32_t pc = frame[6];
+    profiler_slot_t *slots = MP_STATE_PORT(profiler_slots);
+
+    profiler_samples++;
+
+    size_t i = (pc >> 1) % profiler_slot_num;
+    for (size_t probe = 0; probe < PROFILER_MAX_PROBES; probe++)
+    {
+        if (slots[i].pc == pc || slots[i].pc == 0)
+        {
+            slots[i].pc = pc;
+            slots[i].count++;
+            return;
+        }
+        i = (i + 1) % profiler_slot_num;
+    }
+
+    profiler_dropped++;
+}
+
+// Finds the stack that the interrupted code was using, and passes its frame
+__attribute__((naked)) void TIMER2_IRQHandler(void)
+{
+    __asm volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "b profiler_sample\n");
+}
+
+STATIC void profiler_timer_stop(void)
+{
+    NRF_TIMER2->TASKS_STOP = 1;
+    NRF_TIMER2->INTENCLR = TIMER_INTENCLR_COMPARE0_Msk;
+    app_err(sd_nvic_DisableIRQ(TIMER2_IRQn));
+}
+
+STATIC mp_obj_t profiler_start(size_t n_args, const mp_obj_t *pos_args,
+                               mp_map_t *kw_args)
+{
+    enum
+    {
+        ARG_hz,
+        ARG_slots,
+    };
+
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_hz, MP_ARG_INT, {.u_int = 1000}},
+        {MP_QSTR_slots, MP_ARG_INT, {.u_int = 256}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args,
+                     MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    if (args[ARG_hz].u_int < 1 || args[ARG_hz].u_int > 10000)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("hz must be between 1 and 10000"));
+    }
+
+    if (args[ARG_slots].u_int < PROFILER_MAX_PROBES)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("slots must be at least 8"));
+    }
+
+    profiler_timer_stop();
+
+    // The table is allocated once here, so the interrupt never allocates
+    m_del(profiler_slot_t, (profiler_slot_t *)MP_STATE_PORT(profiler_slots), profiler_slot_num);
+    MP_STATE_PORT(profiler_slots) = NULL;
+    profiler_slot_num = 0;
+
+    MP_STATE_PORT(profiler_slots) = m_new0(profiler_slot_t, args[ARG_slots].u_int);
+    profiler_slot_num = args[ARG_slots].u_int;
+    profiler_rate_hz = args[ARG_hz].u_int;
+    profiler_samples = 0;
+    profiler_dropped = 0;
+
+    NRF_TIMER2->TASKS_CLEAR = 1;
+    NRF_TIMER2->MODE = TIMER_MODE_MODE_Timer;
+    NRF_TIMER2->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER2->PRESCALER = 4; // 16MHz / 2^4 = 1MHz
+    NRF_TIMER2->CC[0] = 1000000 / profiler_rate_hz;
+    NRF_TIMER2->SHORTS = TIMER_SHORTS_COMPARE0_CLEAR_Msk;
+    NRF_TIMER2->EVENTS_COMPARE[0] = 0;
+    NRF_TIMER2->INTENSET = TIMER_INTENSET_COMPARE0_Msk;
+
+    app_err(sd_nvic_SetPriority(TIMER2_IRQn, PROFILER_IRQ_PRIORITY));
+    app_err(sd_nvic_ClearPendingIRQ(TIMER2_IRQn));
+    app_err(sd_nvic_EnableIRQ(TIMER2_IRQn));
+
+    NRF_TIMER2->TASKS_START = 1;
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(profiler_start_obj, 0, profiler_start);
+
+STATIC mp_obj_t profiler_stop(void)
+{
+    profiler_timer_stop();
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(profiler_stop_obj, profiler_stop);
+
+STATIC void profiler_put_u32(uint8_t *buf, uint32_t value)
+{
+    buf[0] = value;
+    buf[1] = value >> 8;
+    buf[2] = value >> 16;
+    buf[3] = value >> 24;
+}
+
+STATIC mp_obj_t profiler_dump(void)
+{
+    profiler_slot_t *slots = MP_STATE_PORT(profiler_slots);
+
+    if (slots == NULL)
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("profiler was not started"));
+    }
+
+    // Stop sampling so the table is consistent while it is copied
+    profiler_timer_stop();
+
+    size_t used = 0;
+    for (size_t i = 0; i < profiler_slot_num; i++)
+    {
+        used += slots[i].pc != 0;
+    }
+
+    // "PROF", rate, samples, dropped, then (pc, count) pairs. All little
+    // endian, for tools/profiler.py to symbolise against the firmware
+    vstr_t vstr;
+    vstr_init_len(&vstr, 16 + used * 8);
+    uint8_t *buf = (uint8_t *)vstr.buf;
+
+    memcpy(buf, "PROF", 4);
+    profiler_put_u32(&buf[4], profiler_rate_hz);
+    profiler_put_u32(&buf[8], profiler_samples);
+    profiler_put_u32(&buf[12], profiler_dropped);
+    buf += 16;
+
+    for (size_t i = 0; i < profiler_slot_num; i++)
+    {
+        if (slots[i].pc != 0)
+        {
+            profiler_put_u32(&buf[0], slots[i].pc);
+            profiler_put_u32(&buf[4], slots[i].count);
+            buf += 8;
+        }
+    }
+
+    return mp_obj_new_bytes_from_vstr(&vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(profiler_dump_obj, profiler_dump);
+
+STATIC mp_obj_t profiler_samples_get(void)
+{
+    return mp_obj_new_int_from_uint(profiler_samples);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(profiler_samples_obj, profiler_samples_get);
+
+STATIC const mp_rom_map_elem_t profiler_module_globals_table[] = {
+
+    {MP_ROM_QSTR(MP_QSTR_start), MP_ROM_PTR(&profiler_start_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stop), MP_ROM_PTR(&profiler_stop_obj)},
+    {MP_ROM_QSTR(MP_QSTR_dump), MP_ROM_PTR(&profiler_dump_obj)},
+    {MP_ROM_QSTR(MP_QSTR_samples), MP_ROM_PTR(&profiler_samples_obj)},
+};
+STATIC MP_DEFINE_CONST_DICT(profiler_module_globals, profiler_module_globals_table);
+
+const mp_obj_module_t profiler_module = {
+    .base = {&mp_type_module},
+    .globals = (mp_obj_dict_t *)&profiler_module_globals,
+};
+MP_REGISTER_MODULE(MP_QSTR_profiler, profiler_module);
@@ -25,20 +25,391 @@
 #include <string.h>
 #include <math.h>
 #include "monocle.h"
+#include "bootloader/staged_update.h"
+#include "storage.h"
 #include "extmod/vfs.h"
 #include "py/mperrno.h"
 #include "py/mphal.h"
+#include "py/objlist.h"
 #include "py/runtime.h"
 
+#define STORAGE_BLOCK_SIZE 4096
+#define STORAGE_PAGE_SIZE 256
+
+// Only small reads pull a whole block into the cache. This catches the
+// filesystem metadata without letting long file reads thrash the cache
+#define STORAGE_CACHE_FILL_MAX 256
+
 const struct _mp_obj_type_t device_storage_type;
 
+typedef struct _storage_line_t
+{
+    uint32_t address;
+    uint32_t last_used;
+    bool valid;
+    // Only an erase, or a whole block write, makes the write-back erase.
+    // Otherwise it programs the dirty pages over what is already there.
+    bool needs_erase;
+    uint16_t dirty_pages;
+    uint8_t data[STORAGE_BLOCK_SIZE];
+} storage_line_t;
+
 typedef struct _storage_obj_t
 {
     mp_obj_base_t base;
     uint32_t start;
     uint32_t len;
+    size_t cache_len;
+    uint32_t cache_tick;
+    storage_line_t *cache;
 } storage_obj_t;
 
+// Storage objects with a cache, so they can be flushed before sleeping
+MP_REGISTER_ROOT_POINTER(mp_obj_t storage_cached);
+
+static volatile bool flush_scheduled = false;
+
+static bool is_blank(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] != 0xFF)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool line_is_dirty(storage_line_t *line)
+{
+    return line->needs_erase || line->dirty_pages != 0;
+}
+
+static void line_mark_dirty(storage_line_t *line, size_t offset, size_t length)
+{
+    for (size_t page = offset / STORAGE_PAGE_SIZE;
+         page * STORAGE_PAGE_SIZE < offset + length;
+         page++)
+    {
+        line->dirty_pages |= 1 << page;
+    }
+}
+
+static void cache_write_back(storage_line_t *line)
+{
+    if (!line_is_dirty(line))
+    {
+        return;
+    }
+
+    // Without an erase, flash still holds all that the filesystem committed,
+    // and programming only clears the bits the cached copy has cleared
+    if (line->needs_erase)
+    {
+        monocle_flash_page_erase(line->address);
+    }
+
+    for (size_t page = 0; page < STORAGE_BLOCK_SIZE / STORAGE_PAGE_SIZE; page++)
+    {
+        uint8_t *data = &line->data[page * STORAGE_PAGE_SIZE];
+        bool dirty = line->dirty_pages & (1 << page);
+
+        // Programming 0xFF doesn't change an erased page, so skip those
+        if ((dirty || line->needs_erase) && !is_blank(data, STORAGE_PAGE_SIZE))
+        {
+            monocle_flash_write(data, line->address + page * STORAGE_PAGE_SIZE,
+                                STORAGE_PAGE_SIZE);
+        }
+    }
+
+    line->needs_erase = false;
+    line->dirty_pages = 0;
+}
+
+static storage_line_t *cache_lookup(storage_obj_t *self, uint32_t block_address)
+{
+    for (size_t i = 0; i < self->cache_len; i++)
+    {
+        storage_line_t *line = &self->cache[i];
+
+        if (line->valid && line->address == block_address)
+        {
+            line->last_used = ++self->cache_tick;
+            return line;
+        }
+    }
+
+    return NULL;
+}
+
+static storage_line_t *cache_allocate(storage_obj_t *self, uint32_t block_address)
+{
+    storage_line_t *victim = &self->cache[0];
+
+    for (size_t i = 0; i < self->cache_len; i++)
+    {
+        storage_line_t *line = &self->cache[i];
+
+        if (!line->valid)
+        {
+            victim = line;
+            break;
+        }
+
+        if (line->last_used < victim->last_used)
+        {
+            victim = line;
+        }
+    }
+
+    cache_write_back(victim);
+
+    victim->address = block_address;
+    victim->last_used = ++self->cache_tick;
+    victim->valid = true;
+    victim->needs_erase = false;
+    victim->dirty_pages = 0;
+    return victim;
+}
+
+static void cache_flush(storage_obj_t *self)
+{
+    for (size_t i = 0; i < self->cache_len; i++)
+    {
+        cache_write_back(&self->cache[i]);
+    }
+}
+
+static bool cache_is_dirty(storage_obj_t *self)
+{
+    for (size_t i = 0; i < self->cache_len; i++)
+    {
+        if (line_is_dirty(&self->cache[i]))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void storage_read(storage_obj_t *self, uint8_t *buffer,
+                         uint32_t address, size_t length)
+{
+    while (length > 0)
+    {
+        size_t offset = (address - self->start) % STORAGE_BLOCK_SIZE;
+        size_t chunk = MIN(length, STORAGE_BLOCK_SIZE - offset);
+        uint32_t block_address = address - offset;
+
+        storage_line_t *line = cache_lookup(self, block_address);
+
+        if (line == NULL &&
+            self->cache_len > 0 &&
+            chunk <= STORAGE_CACHE_FILL_MAX)
+        {
+            line = cache_allocate(self, block_address);
+            monocle_flash_read(line->data, block_address, STORAGE_BLOCK_SIZE);
+        }
+
+        if (line != NULL)
+        {
+            memcpy(buffer, &line->data[offset], chunk);
+        }
+        else
+        {
+            monocle_flash_read(buffer, address, chunk);
+        }
+
+        buffer += chunk;
+        address += chunk;
+        length -= chunk;
+    }
+}
+
+static void storage_write(storage_obj_t *self, uint8_t *buffer,
+                          uint32_t address, size_t length, bool erase)
+{
+    while (length > 0)
+    {
+        size_t offset = (address - self->start) % STORAGE_BLOCK_SIZE;
+        size_t chunk = MIN(length, STORAGE_BLOCK_SIZE - offset);
+        uint32_t block_address = address - offset;
+
+        storage_line_t *line = cache_lookup(self, block_address);
+
+        if (line != NULL)
+        {
+            if (erase)
+            {
+                memset(line->data, 0xFF, sizeof(line->data));
+                line->needs_erase = true;
+            }
+
+            // Programming flash can only clear bits, so do the same here
+            for (size_t i = 0; i < chunk; i++)
+            {
+                line->data[offset + i] &= buffer[i];
+            }
+
+            line_mark_dirty(line, offset, chunk);
+        }
+        else
+        {
+            if (erase)
+            {
+                monocle_flash_page_erase(block_address);
+            }
+
+            monocle_flash_write(buffer, address, chunk);
+        }
+
+        buffer += chunk;
+        address += chunk;
+        length -= chunk;
+    }
+}
+
+static void storage_erase(storage_obj_t *self, uint32_t block_address)
+{
+    if (self->cache_len == 0)
+    {
+        monocle_flash_page_erase(block_address);
+        return;
+    }
+
+    // Defer the erase, so the partial writes that follow get coalesced
+    storage_line_t *line = cache_lookup(self, block_address);
+
+    if (line == NULL)
+    {
+        line = cache_allocate(self, block_address);
+    }
+
+    memset(line->data, 0xFF, sizeof(line->data));
+    line->needs_erase = true;
+    line->dirty_pages = 0;
+}
+
+// Write back and free the cache, and stop tracking the object
+static void cache_release(storage_obj_t *self)
+{
+    if (self->cache_len == 0)
+    {
+        return;
+    }
+
+    cache_flush(self);
+    m_del(storage_line_t, self->cache, self->cache_len);
+    self->cache = NULL;
+    self->cache_len = 0;
+
+    mp_obj_list_t *list = MP_OBJ_TO_PTR(MP_STATE_PORT(storage_cached));
+
+    for (size_t i = 0; i < list->len; i++)
+    {
+        if (list->items[i] == MP_OBJ_FROM_PTR(self))
+        {
+            list->len--;
+            memmove(&list->items[i], &list->items[i + 1],
+                    (list->len - i) * sizeof(mp_obj_t));
+            list->items[list->len] = MP_OBJ_NULL;
+            break;
+        }
+    }
+}
+
+void storage_flush_all(void)
+{
+    if (MP_STATE_PORT(storage_cached) == MP_OBJ_NULL)
+    {
+        return;
+    }
+
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_list_get(MP_STATE_PORT(storage_cached), &len, &items);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        cache_flush(MP_OBJ_TO_PTR(items[i]));
+    }
+}
+
+bool storage_overlaps(uint32_t address, size_t length)
+{
+    // The mounted filesystem has a cache, so it's always in this list
+    if (MP_STATE_PORT(storage_cached) == MP_OBJ_NULL)
+    {
+        return false;
+    }
+
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_list_get(MP_STATE_PORT(storage_cached), &len, &items);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        storage_obj_t *self = MP_OBJ_TO_PTR(items[i]);
+
+        if (address < self->start + self->len && self->start < address + length)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+STATIC mp_obj_t storage_flush_scheduled(mp_obj_t unused)
+{
+    (void)unused;
+
+    flush_scheduled = false;
+    storage_flush_all();
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(storage_flush_scheduled_obj, storage_flush_scheduled);
+
+bool storage_flush_before_sleep(void)
+{
+    // Don't hold off sleep forever if the VM never gets to run the flush
+    static uint8_t deferrals = 0;
+
+    bool dirty = false;
+
+    if (MP_STATE_PORT(storage_cached) != MP_OBJ_NULL)
+    {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_list_get(MP_STATE_PORT(storage_cached), &len, &items);
+
+        for (size_t i = 0; i < len && !dirty; i++)
+        {
+            dirty = cache_is_dirty(MP_OBJ_TO_PTR(items[i]));
+        }
+    }
+
+    if (!dirty || deferrals >= 4)
+    {
+        deferrals = 0;
+        return false;
+    }
+
+    deferrals++;
+
+    if (!flush_scheduled)
+    {
+        flush_scheduled = mp_sched_schedule(MP_OBJ_FROM_PTR(&storage_flush_scheduled_obj),
+                                            mp_const_none);
+    }
+
+    return true;
+}
+
 mp_obj_t storage_readblocks(size_t n_args, const mp_obj_t *args)
 {
     storage_obj_t *self = MP_OBJ_TO_PTR(args[0]);
@@ -48,7 +419,7 @@ mp_obj_t storage_readblocks(size_t n_args, const mp_obj_t *args)
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_WRITE);
 
-    mp_int_t address = self->start + (block_num * 4096);
+    mp_int_t address = self->start + (block_num * STORAGE_BLOCK_SIZE);
 
     if (n_args == 4)
     {
@@ -56,7 +427,11 @@ mp_obj_t storage_readblocks(size_t n_args, const mp_obj_t *args)
         address += offset;
     }
 
-    monocle_flash_read(bufinfo.buf, address, bufinfo.len);
+    // Flash waits run the poll hook, where a scheduled callback could
+    // otherwise go into littlefs while it's in the middle of this access
+    mp_sched_lock();
+    storage_read(self, bufinfo.buf, address, bufinfo.len);
+    mp_sched_unlock();
 
     return mp_const_none;
 }
@@ -71,19 +446,21 @@ mp_obj_t storage_writeblocks(size_t n_args, const mp_obj_t *args)
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_WRITE);
 
-    mp_int_t address = self->start + (block_num * 4096);
+    mp_int_t address = self->start + (block_num * STORAGE_BLOCK_SIZE);
+
+    // Without an offset, whole blocks are erased before writing
+    bool erase = true;
 
     if (n_args == 4)
     {
         uint32_t offset = mp_obj_get_int(args[3]);
         address += offset;
-    }
-    else
-    {
-        monocle_flash_page_erase(address);
+        erase = false;
     }
 
-    monocle_flash_write(bufinfo.buf, address, bufinfo.len);
+    mp_sched_lock();
+    storage_write(self, bufinfo.buf, address, bufinfo.len, erase);
+    mp_sched_unlock();
 
     return mp_const_none;
 }
@@ -103,35 +480,43 @@ mp_obj_t storage_ioctl(mp_obj_t self_in, mp_obj_t op_in, mp_obj_t arg_in)
 
     case MP_BLOCKDEV_IOCTL_DEINIT:
     {
+        mp_sched_lock();
+        cache_release(self);
+        mp_sched_unlock();
         return MP_OBJ_NEW_SMALL_INT(0);
     }
 
     case MP_BLOCKDEV_IOCTL_SYNC:
     {
+        mp_sched_lock();
+        cache_flush(self);
+        mp_sched_unlock();
         return MP_OBJ_NEW_SMALL_INT(0);
     }
 
     case MP_BLOCKDEV_IOCTL_BLOCK_COUNT:
     {
-        return MP_OBJ_NEW_SMALL_INT(self->len / 4096);
+        return MP_OBJ_NEW_SMALL_INT(self->len / STORAGE_BLOCK_SIZE);
     }
 
     case MP_BLOCKDEV_IOCTL_BLOCK_SIZE:
     {
-        return MP_OBJ_NEW_SMALL_INT(4096);
+        return MP_OBJ_NEW_SMALL_INT(STORAGE_BLOCK_SIZE);
     }
 
     case MP_BLOCKDEV_IOCTL_BLOCK_ERASE:
     {
         mp_int_t block_num = mp_obj_get_int(arg_in);
-        mp_int_t address = self->start + (block_num * 4096);
+        mp_int_t address = self->start + (block_num * STORAGE_BLOCK_SIZE);
 
-        if ((address & 0x3) || (address % 4096 != 0))
+        if ((address & 0x3) || (address % STORAGE_BLOCK_SIZE != 0))
         {
             return MP_OBJ_NEW_SMALL_INT(-MP_EIO);
         }
 
-        monocle_flash_page_erase(address);
+        mp_sched_lock();
+        storage_erase(self, address);
+        mp_sched_unlock();
         return MP_OBJ_NEW_SMALL_INT(0);
     }
 
@@ -141,11 +526,59 @@ mp_obj_t storage_ioctl(mp_obj_t self_in, mp_obj_t op_in, mp_obj_t arg_in)
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_3(storage_ioctl_obj, storage_ioctl);
 
+static mp_obj_t stats_to_dict(flash_stats_t const *stats)
+{
+    static const qstr keys[] = {
+        MP_QSTR_bytes_read,
+        MP_QSTR_bytes_programmed,
+        MP_QSTR_sectors_erased,
+        MP_QSTR_erases_skipped,
+        MP_QSTR_busy_us,
+    };
+    const uint32_t values[] = {
+        stats->bytes_read,
+        stats->bytes_programmed,
+        stats->sectors_erased,
+        stats->erases_skipped,
+        stats->busy_us,
+    };
+
+    mp_obj_t dict = mp_obj_new_dict(MP_ARRAY_SIZE(keys));
+    for (size_t i = 0; i < MP_ARRAY_SIZE(keys); i++)
+    {
+        mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(keys[i]),
+                          mp_obj_new_int_from_uint(values[i]));
+    }
+    return dict;
+}
+
+STATIC mp_obj_t storage_stats(size_t n_args, const mp_obj_t *args)
+{
+    flash_stats_t *app = monocle_flash_stats(FLASH_REGION_FPGA_APP);
+    flash_stats_t *storage = monocle_flash_stats(FLASH_REGION_STORAGE);
+
+    // Flash counters are shared by every Storage, so this is a static method
+    mp_obj_t dict = mp_obj_new_dict(2);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_fpga_app), stats_to_dict(app));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_storage), stats_to_dict(storage));
+
+    if (n_args == 1 && mp_obj_is_true(args[0]))
+    {
+        memset(app, 0, sizeof(*app));
+        memset(storage, 0, sizeof(*storage));
+    }
+
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(storage_stats_fun_obj, 0, 1, storage_stats);
+STATIC MP_DEFINE_CONST_STATICMETHOD_OBJ(storage_stats_obj, MP_ROM_PTR(&storage_stats_fun_obj));
+
 STATIC const mp_rom_map_elem_t storage_locals_dict_table[] = {
 
     {MP_ROM_QSTR(MP_QSTR_readblocks), MP_ROM_PTR(&storage_readblocks_obj)},
     {MP_ROM_QSTR(MP_QSTR_writeblocks), MP_ROM_PTR(&storage_writeblocks_obj)},
     {MP_ROM_QSTR(MP_QSTR_ioctl), MP_ROM_PTR(&storage_ioctl_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&storage_stats_obj)},
 };
 STATIC MP_DEFINE_CONST_DICT(storage_locals_dict, storage_locals_dict_table);
 
@@ -159,13 +592,15 @@ STATIC mp_obj_t storage_make_new(const mp_obj_type_t *type, size_t n_args, size_
 {
     static const mp_arg_t allowed_args[] = {
         {MP_QSTR_start, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0x6D000}},
-        {MP_QSTR_length, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0x93000}},
+        {MP_QSTR_length, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = STAGED_UPDATE_START - 0x6D000}},
+        {MP_QSTR_cache, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0}},
     };
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
     mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
     mp_int_t start = args[0].u_int;
     mp_int_t length = args[1].u_int;
+    mp_int_t cache = args[2].u_int;
 
     if (start < 0x6D000)
     {
@@ -183,9 +618,30 @@ STATIC mp_obj_t storage_make_new(const mp_obj_type_t *type, size_t n_args, size_
         mp_raise_ValueError(MP_ERROR_TEXT("start + length must be less than 0x100000"));
     }
 
+    if (cache < 0)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("cache cannot be less than zero"));
+    }
+
     storage_obj_t *self = mp_obj_malloc(storage_obj_t, &device_storage_type);
     self->start = start;
     self->len = length;
+    self->cache_len = cache;
+    self->cache_tick = 0;
+    self->cache = NULL;
+
+    if (cache > 0)
+    {
+        self->cache = m_new0(storage_line_t, cache);
+
+        if (MP_STATE_PORT(storage_cached) == MP_OBJ_NULL)
+        {
+            MP_STATE_PORT(storage_cached) = mp_obj_new_list(0, NULL);
+        }
+
+        mp_obj_list_append(MP_STATE_PORT(storage_cached), MP_OBJ_FROM_PTR(self));
+    }
+
     return MP_OBJ_FROM_PTR(self);
 }
 
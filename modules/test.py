@@ -32,6 +32,7 @@ import fpga as __fpga
 import bluetooth as __bluetooth
 import time as __time
 import update as __update_py
+import benchmark as __benchmark
 
 def __test(evaluate, expected):
     try:
@@ -53,9 +54,45 @@ def device_module():
     __test("len(__device.GIT_TAG)", 9)
     __test("__device.GIT_REPO", 'https://github.com/brilliantlabsAR/monocle-micropython')
     __test("isinstance(__device.battery_level(), int)", True)
+    __test("3.0 < __device.battery_voltage() < 4.5", True)
+    __test("__device.battery_callback()", None)
+    __test("__device.charging_callback(1)", ValueError)
+    __test("__device.prevent_sleep()", False)
     __test("__device.prevent_sleep(True)", None)
     __test("__device.prevent_sleep(False)", None)
-    __test("str(__device.Storage())", 'Storage(start=0x0006d000, len=602112)')
+    __test("str(__device.Storage())", 'Storage(start=0x0006d000, len=196608)')
+    __test("str(__device.Storage(cache=0))", 'Storage(start=0x0006d000, len=196608)')
+    __test("__device.Storage(cache=-1)", ValueError)
+    __test("__device.flash_info()['size']", 1048576)
+    __test("__device.allocations(__device.battery_level)", 0)
+    __test("__device.allocations(lambda: bytearray(64)) >= 64", True)
+
+    # Ensure that the boot steps are recorded in order
+    __test("[s for s, t in __device.boot_timeline()][:3]", ['pmic', 'touch', 'gpio'])
+    __test("[s for s, t in __device.boot_timeline()][3:6]", ['fpga', 'display', 'camera'])
+    __test("sorted(t for s, t in __device.boot_timeline()) == [t for s, t in __device.boot_timeline()]", True)
+    __test("type(__device.events())", list)
+    __test("__device.events()", [])
+    __test("sorted(__device.event_stats().keys())", ['callbacks_lost', 'coalesced', 'dropped', 'queued'])
+
+    # Ensure that the profiler samples the CPU, and dumps its table
+    __test("__import__('profiler').start(hz=0)", ValueError)
+    __test("__import__('profiler').start(hz=2000, slots=64)", None)
+    __test("__time.sleep_ms(50)", None)
+    __test("__import__('profiler').samples() > 50", True)
+    __test("__import__('profiler').dump()[:4]", b'PROF')
+
+    # Ensure that compiled copies of the user's files are imported first
+    __test("__import__('sys').path[0]", '/.mpy')
+    __test("open('/.mpy/__t.mpy', 'w').close() or open('/__t.py', 'w').close() or '__t.mpy' in __import__('os').listdir('/.mpy')", False)
+    __test("__import__('os').remove('/__t.py')", None)
+
+    # Ensure that the native and viper emitters are built in
+    __test("(lambda g: exec('@micropython.native\\ndef f(x):\\n return x + 1', g) or g['f'](1))({})", 2)
+    __test("(lambda g: exec('@micropython.viper\\ndef f(x: int) -> int:\\n return x << 2', g) or g['f'](3))({})", 12)
+    __test("sorted(__device.Storage.stats())", ['fpga_app', 'storage'])
+    __test("__device.Storage.stats(True)['storage']['bytes_read'] >= 0", True)
+    __test("__device.Storage.stats()['fpga_app']['sectors_erased']", 0)
 
 def display_module():
 
@@ -101,17 +138,106 @@ def display_module():
     __display.line(600,0, 300,400, 0xFFFFFF); __display.show()
     __display.line(640,0, 300,400, 0xFFFFFF); __display.show()
 
+    # Retained mode only redraws what changed between frames
+    __test("__display.retained(True)", None)
+    for i in range(3):
+        __display.text(str(i), 100, 100, 0xFFFFFF); __display.show()
+    __test("__display.retained(False)", None)
+
+    # Native shapes
+    __display.pixel(320, 200, 0xFFFFFF)
+    __display.rect(10, 10, 100, 50, 0xFF0000)
+    __display.rect(120, 10, 100, 50, 0x00FF00, True)
+    __display.ellipse(320, 200, 100, 50, 0x0000FF)
+    __display.ellipse(320, 200, 40, 40, 0xFFFF00, True)
+    __display.poly(400, 300, [0, 0, 100, 20, 40, 80], 0xFF00FF)
+    __test("__display.show()", None)
+    __test("__display.poly(0, 0, [0, 0, 1, 1], 0xFFFFFF)", ValueError)
+    __test("[__display.rect(i, 0, 1, 1, i) for i in range(__display.PALETTE_SIZE + 8)] and __display.show()", None)
+
+    # Bitmaps are read in place from their buffer
+    __test("__display.bitmap(0, 0, 16, 2, b'\\xF0\\x0F' * 2, __display.MONO)", None)
+    __test("__display.bitmap(0, 0, 4, 1, b'\\x01\\x23', __display.INDEXED4, [0, 0xFF, 0xFF00, 0xFF0000])", None)
+    __test("__display.bitmap(0, 0, 2, 1, b'\\x80\\xFF\\x80\\xFF', __display.YUV422)", None)
+    __test("__display.show()", None)
+    __test("__display.bitmap(0, 0, 16, 2, b'\\x00', __display.MONO)", ValueError)
+
+    # Ensure that a frame can be awaited from a uasyncio task
+    __display.text("async", 0, 0, 0xFFFFFF)
+    __test("(lambda g: exec('async def f():\\n return await d.show_async()', g) or __import__('uasyncio').run(g['f']()))({'d': __display})", None)
+    __test("__display.ellipse(0, 0, -1, 1, 0xFFFFFF)", ValueError)
+
+    # Text is laid out once, and can be queued again on later frames
+    __test("__display.Text('one', 0, 0, 0xFFFFFF).height == __display.Text('two\\nlines', 0, 0, 0xFFFFFF).height", False)
+    __test("__display.Text('a wrapped label', 0, 0, 0xFFFFFF, 60).height > __display.Text('a wrapped label', 0, 0, 0xFFFFFF).height", True)
+    label = __display.Text('label', 100, 100, 0xFFFFFF)
+    for i in range(2):
+        __display.text(label); __display.show()
+    # Glyphs drawn from spans, clipped at both edges of the screen
+    __display.text('spans', -20, 0, 0xFFFFFF); __display.text('spans', 600, 0, 0xFFFFFF); __display.show()
+    __test("__display.text(__display.Text('x', 0, 0, 0), 0, 0, 0)", TypeError)
+    __test("__display.fonts()[0]", 50)
+    __test("__display.Text('x', 0, 0, 0xFFFFFF, font=50).height", 50)
+    __test("__display.Text('x', 0, 0, 0xFFFFFF, font=3)", ValueError)
+    __test("__display.Text('\u00e9', 0, 0, 0xFFFFFF).width == __display.Text(' ', 0, 0, 0xFFFFFF).width", True)
+
+    # The render arena is static, and empty again after show()
+    __test("len(__display.memory())", 3)
+    __test("__display.memory()[1] <= __display.memory()[2]", True)
+
     # Test constants
     __test("__display.WIDTH", 640)
     __test("__display.HEIGHT", 400)
+    __test("__display.PALETTE_SIZE", 64)
+
+def display_benchmark():
+
+    # Standard scenes, to compare frame rates between firmware versions
+    def scene(name, draw, frames=5):
+        start = __time.ticks_ms()
+        for i in range(frames):
+            draw()
+            __display.show()
+        elapsed = __time.ticks_diff(__time.ticks_ms(), start)
+        print(f"Benchmark - {name}: {frames * 1000 / max(elapsed, 1):.1f} fps, {__display.stats()}")
+
+    def fill():
+        __display.fill(0xFFFFFF)
+
+    def labels():
+        for i in range(400):
+            __display.text("label", (i % 20) * 32, (i // 20) * 20, 0xFFFFFF)
+
+    def lines():
+        for i in range(0, 640, 4):
+            __display.line(i, 0, 640 - i, 400, 0xFFFFFF)
+
+    scene("full fill", fill)
+    scene("400 text labels", labels)
+    scene("dense lines", lines)
+
+    __test("sorted(__display.stats().keys())", ['bytes_sent', 'clear_us', 'flush_us', 'objects', 'render_us', 'rows_flushed', 'show_us'])
 
 def camera_module():
 
-    print("TODO camera module")
+    __test("sorted(__camera.stats().keys())", ['ble_wait_us', 'bytes', 'first_byte_us', 'fpga_wait_us', 'fragments', 'total_us'])
+    __test("__camera.stats()['bytes']", 0)
+    __test("__camera.output(160, 120, 'BMP')", ValueError)
+    __test("__camera.output(641, 120, __camera.JPEG)", ValueError)
+    __test("__camera.output(161, 120, __camera.RGB)", ValueError)
+    __test("__camera.output(160, 120, __camera.RGB)", None)
+    __test("__camera.output(640, 400, __camera.JPEG)", None)
 
 def microphone_module():
 
-    print("TODO microphone module")
+    __test("__microphone.start(sample_rate=44100)", ValueError)
+    __test("__microphone.start(encoding='MP3')", ValueError)
+    __test("__microphone.start(encoding=__microphone.ADPCM, sample_rate=8000)", None)
+    __test("__time.sleep_ms(100)", None)
+    __test("__microphone.stats()['samples'] > 0", True)
+    __test("__microphone.read_into(bytearray(64)) <= 64", True)
+    __test("__microphone.stop()", None)
+    __test("sorted(__microphone.stats().keys())", ['bytes', 'dropped', 'overruns', 'samples'])
 
 def touch_module():
 
@@ -123,6 +249,16 @@ def touch_module():
     __test("__touch.state(__touch.BOTH)", False)
     __test("__touch.state('B')", False)
     __test("callable(__touch.callback)", True)
+    __test("type(__touch.wait()).__name__", 'awaitable')
+    __test("__touch.gesture()", None)
+    __test("__touch.gesture(1)", ValueError)
+    __test("__touch.DOUBLE_TAP", 'DOUBLE_TAP')
+    __test("__touch.timing()", {'double': 250, 'long': 600, 'hold': 200, 'slide': 300})
+    __test("__touch.timing(double=0)['double']", 0)
+    __test("__touch.timing(double=250, long=-1)", ValueError)
+    __test("__touch.timing()['double']", 0)
+    __test("__touch.timing(double=250)['double']", 250)
+    __test("(lambda u, g: exec('async def f():\\n return await t.wait()', g) or u.run(u.wait_for_ms(g['f'](), 10)))(__import__('uasyncio'), {'t': __touch})", __import__('uasyncio').TimeoutError)
 
 def led_module():
 
@@ -148,21 +284,57 @@ def fpga_module():
     # Ensure that ROM strings can't be sent on the SPI
     __test("__fpga.write(0x0000, 'done')", TypeError)
 
-    # Ensure that the min and max transfer sizes are respected
-    __test("__fpga.read(0x0000, 256), ", ValueError)
+    # Batches compile once and run back to back
+    __test("__fpga.Batch([(0x0000, b'')]).run()", True)
+    __test("__fpga.Batch([(0x0000,)])", ValueError)
+    __test("__fpga.Batch([(0x0000, b'', -1)])", ValueError)
+    __test("__fpga.Batch([(0x0000, b'done'), (0x0000, 'a' * 255)]).run()", True)
+    exec("__batch = __fpga.Batch([(0x0000, b'done')]); __batch.run()")
+    __test("__device.allocations(__batch.run)", 0)
+
+    # Test waiting on the completion interrupt
+    __test("type(__fpga.wait(0))", bool)
+    __test("__fpga.wait(-1)", ValueError)
+
+    # Ensure that the min transfer size is respected, and that long
+    # transfers are chained past the 255 byte DMA limit
+    __test("len(__fpga.read(0x0000, 4096))", 4096)
     __test("__fpga.read(0x0000, 0), ", ValueError)
     __test("__fpga.read(0x0000, -1), ", ValueError)
-    __test("__fpga.write(0x0000, b'a' * 256)", ValueError)
+    __test("__fpga.write(0x0000, b'a' * 4096)", None)
+    __test("__fpga.read_into(0x0001, bytearray(3))", None)
+    __test("__fpga.read_into(0x0000, bytearray(0))", ValueError)
+    __test("__fpga.read_into(0x0000, b'abc')", TypeError)
+    __test("__device.allocations(__fpga.read_into, 0x0000, bytearray(4096))", 0)
 
 def bluetooth_module():
 
     __test("__bluetooth.connected()", True)
+    __test("type(__bluetooth.recv()).__name__", 'awaitable')
     __test("isinstance(__bluetooth.max_length(), int)", True)
     max_length = __bluetooth.max_length()
     __test("__bluetooth.send(b'')", None)
     __test(f"__bluetooth.send(b'a' * {max_length})", None)
     __test(f"__bluetooth.send(b'a' * ({max_length} + 1))", ValueError)
+    __test("__bluetooth.send_stream(b'')", 1)
+    __test(f"__bluetooth.send_stream(b'a' * ({max_length} * 3))", 4)
     __test("callable(__bluetooth.receive_callback)", True)
+    __test("__bluetooth.receive_callback(None, 0)", ValueError)
+    __test("__bluetooth.any()", 0)
+    __test("__bluetooth.read_into(bytearray(16))", 0)
+    if hasattr(__bluetooth, 'l2cap_open'):
+        __test("__bluetooth.l2cap_open(0x10)", ValueError)
+        __test("__bluetooth.l2cap_open()", None)
+        __test("__bluetooth.l2cap_any()", 0)
+        __test("__bluetooth.l2cap_close()", None)
+    __test("__bluetooth.profile('fast')", ValueError)
+    __test("len(__bluetooth.profile('balanced'))", 3)
+    __test("__bluetooth.reset_stats()", None)
+    __test("__bluetooth.stats()['repl_rx_dropped']", 0)
+    __test("__bluetooth.stats()['mtu'] == __bluetooth.max_length()", True)
+    __test("27 <= __bluetooth.stats()['max_tx_octets'] <= 251", True)
+    __test("sorted(__benchmark.link())", ['connection_interval_us', 'mtu', 'rx_phy', 'slave_latency', 'supervision_timeout_ms', 'tx_phy'])
+    __test("__benchmark.receive(1, timeout_ms=10)['bytes']", 0)
 
 def time_module():
 
@@ -180,6 +352,18 @@ def time_module():
     __test("__time.now()", {'timezone': '05:30', 'weekday': 'saturday', 'minute': 32, 'day': 21, 'yearday': 21, 'month': 1, 'second': 51, 'hour': 3, 'year': 2023})
     __test("__time.zone('-12:00')", None)
     __test("__time.now()", {'timezone': '-12:00', 'weekday': 'friday', 'minute': 2, 'day': 20, 'yearday': 20, 'month': 1, 'second': 51, 'hour': 10, 'year': 2023})
+    __test("__time.now(1674253104, {})['hour']", 10)
+    __test("__time.now(None, [])", TypeError)
+    __test("__device.allocations(__time.now, None, __time.now())", 0)
+    __test("__time.localtime(1674253104)", (2023, 1, 20, 10, 18, 24, 4, 20))
+    __test("__time.localtime(1674253104, [0] * 8)", [2023, 1, 20, 10, 18, 24, 4, 20])
+    __test("__time.localtime(None, [])", ValueError)
+    __test("__device.allocations(__time.localtime, None, [0] * 8)", 0)
+    __test("__time.clock(bytearray(5), 1674253104)", bytearray(b'10:18'))
+    __test("__time.clock(bytearray(8), 1674253104)", bytearray(b'10:18:24'))
+    __test("__time.clock(bytearray(6))", ValueError)
+    __test("__device.allocations(__time.clock, bytearray(8))", 0)
+    __test("__display.Text(__time.clock(bytearray(5)), 0, 0, 0xFFFFFF).height", 50)
 
     # Test getting epochs from time dict
     __test("__time.mktime({'minute': 18, 'day': 20, 'month': 1, 'second': 24, 'hour': 22, 'year': 2023})", 1674253104)
@@ -191,6 +375,12 @@ def time_module():
     __test("__time.time()", 1674252173)
     __test("__time.sleep(0.25)", None)
     __test("__time.time()", 1674252173)
+    __test("(lambda t: __time.sleep_ms(30) or 30 <= __time.ticks_diff(__time.ticks_ms(), t) <= 32)(__time.ticks_ms())", True)
+    __test("(lambda t: __time.sleep_ms(10) or 9000 <= __time.ticks_diff(__time.ticks_us(), t) <= 12000)(__time.ticks_us())", True)
+    __test("(lambda u, t: u.run(u.sleep_ms(50)) or 50 <= __time.ticks_diff(__time.ticks_ms(), t) <= 55)(__import__('uasyncio'), __time.ticks_ms())", True)
+    __test("(lambda t: __time.ticks_diff(__time.ticks_cpu(), t) > 0)(__time.ticks_cpu())", True)
+    __test("(lambda t: __time.time_ns() > t)(__time.time_ns())", True)
+    __test("__time.time_ns() // 1000000000 - __time.time() in (0, 1, -1)", True)
 
     # Test invalid values
     __test("__time.time(-1)", ValueError)
@@ -210,14 +400,38 @@ def update_module():
     # Write and read back value
     __test("__update_py.Fpga.write(b'done')", None)
     __test("__update_py.Fpga.read(0x0000, 4)", b'done')
+    __test("__update_py.Fpga.crc()", 0x102de0ab)
+    __test("__update_py.Fpga.readinto(0x0000, bytearray(4))", 4)
+    __test("__update_py.Fpga.readinto(444430, bytearray(8))", ValueError)
+
+    # Digests are computed on the device
+    __test("__update_py.crc32(0x0000, 4)", 0x102de0ab)
+    __test("__update_py.sha256(0x0000, 4)", b'\xa4\xc3\xed\x04\xa9Z=\xa1J\x9d#\\\x83\xd8h\xbe\xd7\xc0\xf4\\\xf7\xf3\xfa\xa7Q\xee\x8fPY\x8d"\x11')
+    __test("__update_py.crc32(0x0000, 0x100001)", ValueError)
+
+    # Sessions check the CRC, and resume from their last checkpoint
+    __test("__update_py.Fpga.start(0, 0)", ValueError)
+    __test("__update_py.Fpga.start(4, 0x102de0ab)", 0)
+    __test("__update_py.Fpga.write(b'done')", None)
+    __test("__update_py.Fpga.finish()", 4)
+    __test("__update_py.Fpga.start(4, 0x102de0ab)", 4)
+    __test("__update_py.Fpga.finish()", 4)
 
     # Check that limits of the FPGA app region are respected
     __test("__update_py.Fpga.read(444430, 4)", b'\xff\xff\xff\xff')
     __test("__update_py.Fpga.read(444430, 8)", ValueError)
 
+    # Staged images need a signed init packet, and a session to write into
+    __test("callable(__update_py.Nrf52.apply)", True)
+    __test("__update_py.Nrf52.start(b'')", ValueError)
+    __test("__update_py.Nrf52.start(b'\\x12\\x00')", ValueError)
+    __test("__update_py.Nrf52.write(b'done')", ValueError)
+    __test("__update_py.Nrf52.finish()", ValueError)
+
 def all():
     device_module()
     display_module()
+    display_benchmark()
     camera_module()
     microphone_module()
     touch_module()
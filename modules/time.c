@@ -24,6 +24,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "py/runtime.h"
 #include "shared/timeutils/timeutils.h"
@@ -34,23 +35,36 @@ uint64_t time_at_boot_s;
 static int8_t time_zone_hour_offset;
 static uint8_t time_zone_minute_offset;
 
+// Formatted once each time the zone is set, as time.now() returns it each call
+static qstr time_zone_string = MP_QSTRnull;
+
 STATIC uint64_t _gettime(void)
 {
     return time_at_boot_s + mp_hal_ticks_ms() / 1000;
 }
 
-STATIC mp_obj_t time_zone(size_t n_args, const mp_obj_t *args)
+static qstr time_zone_qstr(void)
 {
-    if (n_args == 0)
+    if (time_zone_string == MP_QSTRnull)
     {
         char timezone_string[] = "+00:00";
         snprintf(timezone_string,
-                 sizeof timezone_string,
+                 sizeof(timezone_string),
                  "%02d:%02u",
                  time_zone_hour_offset,
                  time_zone_minute_offset);
 
-        return mp_obj_new_str(timezone_string, strlen(timezone_string));
+        time_zone_string = qstr_from_str(timezone_string);
+    }
+
+    return time_zone_string;
+}
+
+STATIC mp_obj_t time_zone(size_t n_args, const mp_obj_t *args)
+{
+    if (n_args == 0)
+    {
+        return MP_OBJ_NEW_QSTR(time_zone_qstr());
     }
 
     int hour = 0;
@@ -78,27 +92,28 @@ STATIC mp_obj_t time_zone(size_t n_args, const mp_obj_t *args)
 
     time_zone_hour_offset = hour;
     time_zone_minute_offset = minute;
+    time_zone_string = MP_QSTRnull;
 
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(time_zone_obj, 0, 1, time_zone);
 
-STATIC mp_obj_t time_now(size_t n_args, const mp_obj_t *args)
+// The local time at the epoch given, or now if it is missing or None
+static void time_local(mp_obj_t epoch, timeutils_struct_time_t *tm)
 {
-    timeutils_struct_time_t tm;
     mp_int_t now;
 
-    if (n_args == 0)
+    if (epoch == MP_OBJ_NULL || epoch == mp_const_none)
     {
         now = _gettime();
     }
-    else if (n_args == 1)
+    else
     {
-        if (mp_obj_get_int(args[0]) < 0)
+        if (mp_obj_get_int(epoch) < 0)
         {
             mp_raise_ValueError(MP_ERROR_TEXT("value given must be positive"));
         }
-        now = mp_obj_get_int(args[0]);
+        now = mp_obj_get_int(epoch);
     }
 
     now += time_zone_hour_offset * 3600;
@@ -111,13 +126,30 @@ STATIC mp_obj_t time_now(size_t n_args, const mp_obj_t *args)
         now -= time_zone_minute_offset * 60;
     }
 
-    timeutils_seconds_since_epoch_to_struct_time(now, &tm);
+    timeutils_seconds_since_epoch_to_struct_time(now, tm);
+}
+
+STATIC mp_obj_t time_now(size_t n_args, const mp_obj_t *args)
+{
+    timeutils_struct_time_t tm;
+    time_local(n_args > 0 ? args[0] : MP_OBJ_NULL, &tm);
 
-    mp_obj_dict_t *dict = mp_obj_new_dict(0);
+    // Refilling a dict given by the caller replaces the values in place, so
+    // a loop calling time.now(None, d) does not allocate once d is populated
+    mp_obj_t dict;
 
-    mp_obj_dict_store(dict,
-                      MP_ROM_QSTR(MP_QSTR_year),
-                      mp_obj_new_int(tm.tm_year));
+    if (n_args == 2)
+    {
+        if (!mp_obj_is_type(args[1], &mp_type_dict))
+        {
+            mp_raise_TypeError(MP_ERROR_TEXT("must be a dict"));
+        }
+        dict = args[1];
+    }
+    else
+    {
+        dict = mp_obj_new_dict(9);
+    }
 
     mp_obj_dict_store(dict,
                       MP_ROM_QSTR(MP_QSTR_year),
@@ -188,20 +220,94 @@ STATIC mp_obj_t time_now(size_t n_args, const mp_obj_t *args)
                       MP_ROM_QSTR(MP_QSTR_yearday),
                       mp_obj_new_int(tm.tm_yday));
 
-    char timezone_string[] = "+00:00";
-    snprintf(timezone_string,
-             sizeof(timezone_string),
-             "%02d:%02u",
-             time_zone_hour_offset,
-             time_zone_minute_offset);
-
     mp_obj_dict_store(dict,
                       MP_ROM_QSTR(MP_QSTR_timezone),
-                      mp_obj_new_str(timezone_string, strlen(timezone_string)));
+                      MP_OBJ_NEW_QSTR(time_zone_qstr()));
+
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(time_now_obj, 0, 2, time_now);
+
+STATIC mp_obj_t time_localtime(size_t n_args, const mp_obj_t *args)
+{
+    timeutils_struct_time_t tm;
+    time_local(n_args > 0 ? args[0] : MP_OBJ_NULL, &tm);
+
+    // Same order as the time.localtime() of MicroPython, weekday 0 is monday
+    mp_obj_t items[8] = {
+        MP_OBJ_NEW_SMALL_INT(tm.tm_year),
+        MP_OBJ_NEW_SMALL_INT(tm.tm_mon),
+        MP_OBJ_NEW_SMALL_INT(tm.tm_mday),
+        MP_OBJ_NEW_SMALL_INT(tm.tm_hour),
+        MP_OBJ_NEW_SMALL_INT(tm.tm_min),
+        MP_OBJ_NEW_SMALL_INT(tm.tm_sec),
+        MP_OBJ_NEW_SMALL_INT(tm.tm_wday),
+        MP_OBJ_NEW_SMALL_INT(tm.tm_yday),
+    };
+
+    if (n_args < 2)
+    {
+        return mp_obj_new_tuple(MP_ARRAY_SIZE(items), items);
+    }
+
+    // Small ints need no allocation, so refilling a list given by the caller
+    // doesn't allocate at all
+    size_t len;
+    mp_obj_t *list;
+
+    if (!mp_obj_is_type(args[1], &mp_type_list))
+    {
+        mp_raise_TypeError(MP_ERROR_TEXT("must be a list"));
+    }
+
+    mp_obj_list_get(args[1], &len, &list);
+
+    if (len != MP_ARRAY_SIZE(items))
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("list must have 8 items"));
+    }
+
+    memcpy(list, items, sizeof(items));
+
+    return args[1];
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(time_localtime_obj, 0, 2, time_localtime);
+
+static void time_put_2_digits(uint8_t *buf, int value)
+{
+    buf[0] = '0' + value / 10;
+    buf[1] = '0' + value % 10;
+}
+
+STATIC mp_obj_t time_clock(size_t n_args, const mp_obj_t *args)
+{
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_WRITE);
+
+    // The length of the buffer picks the format, so nothing is left over
+    if (bufinfo.len != 5 && bufinfo.len != 8)
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("buffer must be 5 bytes for hh:mm or 8 for hh:mm:ss"));
+    }
+
+    timeutils_struct_time_t tm;
+    time_local(n_args > 1 ? args[1] : MP_OBJ_NULL, &tm);
+
+    uint8_t *buf = bufinfo.buf;
+    time_put_2_digits(buf, tm.tm_hour);
+    buf[2] = ':';
+    time_put_2_digits(buf + 3, tm.tm_min);
+
+    if (bufinfo.len == 8)
+    {
+        buf[5] = ':';
+        time_put_2_digits(buf + 6, tm.tm_sec);
+    }
 
-    return MP_OBJ_FROM_PTR(dict);
+    return args[0];
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(time_now_obj, 0, 1, time_now);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(time_clock_obj, 1, 2, time_clock);
 
 STATIC mp_obj_t time_time(size_t n_args, const mp_obj_t *args)
 {
@@ -247,11 +353,16 @@ STATIC const mp_rom_map_elem_t time_module_globals_table[] = {
 
     {MP_ROM_QSTR(MP_QSTR_time), MP_ROM_PTR(&time_time_obj)},
     {MP_ROM_QSTR(MP_QSTR_now), MP_ROM_PTR(&time_now_obj)},
+    {MP_ROM_QSTR(MP_QSTR_localtime), MP_ROM_PTR(&time_localtime_obj)},
+    {MP_ROM_QSTR(MP_QSTR_clock), MP_ROM_PTR(&time_clock_obj)},
     {MP_ROM_QSTR(MP_QSTR_zone), MP_ROM_PTR(&time_zone_obj)},
     {MP_ROM_QSTR(MP_QSTR_mktime), MP_ROM_PTR(&time_mktime_obj)},
     {MP_ROM_QSTR(MP_QSTR_sleep), MP_ROM_PTR(&mp_utime_sleep_obj)},
     {MP_ROM_QSTR(MP_QSTR_sleep_ms), MP_ROM_PTR(&mp_utime_sleep_ms_obj)},
     {MP_ROM_QSTR(MP_QSTR_ticks_ms), MP_ROM_PTR(&mp_utime_ticks_ms_obj)},
+    {MP_ROM_QSTR(MP_QSTR_ticks_us), MP_ROM_PTR(&mp_utime_ticks_us_obj)},
+    {MP_ROM_QSTR(MP_QSTR_ticks_cpu), MP_ROM_PTR(&mp_utime_ticks_cpu_obj)},
+    {MP_ROM_QSTR(MP_QSTR_time_ns), MP_ROM_PTR(&mp_utime_time_ns_obj)},
     {MP_ROM_QSTR(MP_QSTR_ticks_add), MP_ROM_PTR(&mp_utime_ticks_add_obj)},
     {MP_ROM_QSTR(MP_QSTR_ticks_diff), MP_ROM_PTR(&mp_utime_ticks_diff_obj)},
 };
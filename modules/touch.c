@@ -22,6 +22,8 @@
  * PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include "awaitable.h"
+#include "events.h"
 #include "monocle.h"
 #include "touch.h"
 #include "py/runtime.h"
@@ -30,16 +32,376 @@
 static mp_obj_t touch_a_callback = mp_const_none;
 static mp_obj_t touch_b_callback = mp_const_none;
 
+// Latest touch since touch.wait() was called, for the task awaiting it
+static volatile touch_action_t touch_wait_action = TOUCH_NONE;
+
 void touch_event_handler(touch_action_t action)
 {
+    touch_wait_action = action;
+
+    if (action == TOUCH_A || action == TOUCH_B)
+    {
+        events_push(action == TOUCH_A ? EVENT_TOUCH_A : EVENT_TOUCH_B);
+    }
+
     if (action == TOUCH_A && touch_a_callback != mp_const_none)
     {
-        mp_sched_schedule(touch_a_callback, MP_ROM_QSTR(MP_QSTR_A));
+        if (!mp_sched_schedule(touch_a_callback, MP_ROM_QSTR(MP_QSTR_A)))
+        {
+            events_callback_lost();
+        }
     }
 
     if (action == TOUCH_B && touch_b_callback != mp_const_none)
     {
-        mp_sched_schedule(touch_b_callback, MP_ROM_QSTR(MP_QSTR_B));
+        if (!mp_sched_schedule(touch_b_callback, MP_ROM_QSTR(MP_QSTR_B)))
+        {
+            events_callback_lost();
+        }
+    }
+}
+
+typedef enum touch_gesture_t
+{
+    GESTURE_TAP,
+    GESTURE_DOUBLE_TAP,
+    GESTURE_LONG_PRESS,
+    GESTURE_HOLD,
+    GESTURE_SLIDE,
+} touch_gesture_t;
+
+STATIC const qstr gesture_names[] = {
+    MP_QSTR_TAP,
+    MP_QSTR_DOUBLE_TAP,
+    MP_QSTR_LONG_PRESS,
+    MP_QSTR_HOLD,
+    MP_QSTR_SLIDE,
+};
+
+// Recognized gestures wait here for the scheduled function handing them to
+// the Python callback
+#define GESTURE_QUEUE_SIZE 8
+
+static struct
+{
+    struct
+    {
+        uint8_t gesture;
+        uint8_t pad;
+        uint32_t ms;
+    } entries[GESTURE_QUEUE_SIZE];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+} gesture_queue;
+
+static volatile bool gesture_scheduled = false;
+
+MP_REGISTER_ROOT_POINTER(mp_obj_t touch_gesture_callback);
+
+// In milliseconds, set with touch.timing(). A double or slide window of 0
+// turns that gesture off, and so does a hold interval of 0
+static struct
+{
+    uint16_t double_ms;
+    uint16_t long_ms;
+    uint16_t hold_ms;
+    uint16_t slide_ms;
+} gesture_timing = {
+    .double_ms = 250,
+    .long_ms = 600,
+    .hold_ms = 200,
+    .slide_ms = 300,
+};
+
+// While a pad is held, its state is read again this often, in case the
+// release raises no interrupt
+#define GESTURE_POLL_MS 50
+
+typedef struct gesture_pad_t
+{
+    bool pressed;
+    bool long_sent;
+    bool consumed;      // used by a slide, so the release is ignored
+    bool tap_pending;   // waiting out the double tap window
+    bool short_release; // released before a long press, may start a slide
+    uint32_t press_ms;
+    uint32_t release_ms;
+    uint32_t tap_ms;
+    uint32_t next_hold_ms;
+} gesture_pad_t;
+
+static gesture_pad_t gesture_pads[2];
+
+STATIC mp_obj_t touch_gesture_process(mp_obj_t unused)
+{
+    (void)unused;
+
+    // Clear first so that gestures arriving meanwhile schedule again
+    gesture_scheduled = false;
+
+    while (gesture_queue.tail != gesture_queue.head)
+    {
+        uint8_t tail = gesture_queue.tail;
+        mp_obj_t args[] = {
+            MP_OBJ_NEW_QSTR(gesture_names[gesture_queue.entries[tail].gesture]),
+            MP_OBJ_NEW_QSTR(gesture_queue.entries[tail].pad ? MP_QSTR_B : MP_QSTR_A),
+            mp_obj_new_int_from_uint(gesture_queue.entries[tail].ms),
+        };
+        gesture_queue.tail = (tail + 1) % GESTURE_QUEUE_SIZE;
+
+        mp_obj_t callback = MP_STATE_PORT(touch_gesture_callback);
+
+        if (callback != MP_OBJ_NULL && callback != mp_const_none)
+        {
+            mp_call_function_n_kw(callback, MP_ARRAY_SIZE(args), 0, args);
+        }
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(touch_gesture_process_obj, touch_gesture_process);
+
+static void gesture_emit(touch_gesture_t gesture, uint8_t pad, uint32_t ms)
+{
+    mp_obj_t callback = MP_STATE_PORT(touch_gesture_callback);
+
+    if (callback == MP_OBJ_NULL || callback == mp_const_none)
+    {
+        return;
+    }
+
+    uint8_t head = gesture_queue.head;
+    uint8_t next = (head + 1) % GESTURE_QUEUE_SIZE;
+
+    if (next == gesture_queue.tail)
+    {
+        events_callback_lost();
+        return;
+    }
+
+    gesture_queue.entries[head].gesture = gesture;
+    gesture_queue.entries[head].pad = pad;
+    gesture_queue.entries[head].ms = ms;
+    gesture_queue.head = next;
+
+    if (!gesture_scheduled)
+    {
+        gesture_scheduled = mp_sched_schedule(MP_OBJ_FROM_PTR(&touch_gesture_process_obj),
+                                              mp_const_none);
+        if (!gesture_scheduled)
+        {
+            events_callback_lost();
+        }
+    }
+}
+
+static void gesture_pad_timeouts(uint8_t id, uint32_t now_ms)
+{
+    gesture_pad_t *pad = &gesture_pads[id];
+
+    if (pad->tap_pending && !pad->pressed &&
+        now_ms - pad->release_ms >= gesture_timing.double_ms)
+    {
+        pad->tap_pending = false;
+        gesture_emit(GESTURE_TAP, id, pad->tap_ms);
+    }
+
+    if (!pad->pressed || pad->consumed)
+    {
+        return;
+    }
+
+    if (!pad->long_sent && now_ms - pad->press_ms >= gesture_timing.long_ms)
+    {
+        // A tap that was waiting for a second one stands on its own
+        if (pad->tap_pending)
+        {
+            pad->tap_pending = false;
+            gesture_emit(GESTURE_TAP, id, pad->tap_ms);
+        }
+
+        pad->long_sent = true;
+        pad->next_hold_ms = pad->press_ms + gesture_timing.long_ms +
+                            gesture_timing.hold_ms;
+        gesture_emit(GESTURE_LONG_PRESS, id, pad->press_ms);
+    }
+
+    if (pad->long_sent && gesture_timing.hold_ms > 0 &&
+        (int32_t)(now_ms - pad->next_hold_ms) >= 0)
+    {
+        // Late updates give one hold event, rather than a burst of them
+        while ((int32_t)(now_ms - pad->next_hold_ms) >= 0)
+        {
+            pad->next_hold_ms += gesture_timing.hold_ms;
+        }
+        gesture_emit(GESTURE_HOLD, id, now_ms);
+    }
+}
+
+static void gesture_pad_press(uint8_t id, uint32_t now_ms)
+{
+    gesture_pad_t *pad = &gesture_pads[id];
+    gesture_pad_t *other = &gesture_pads[!id];
+
+    pad->pressed = true;
+    pad->long_sent = false;
+    pad->consumed = false;
+    pad->press_ms = now_ms;
+
+    if (gesture_timing.slide_ms == 0)
+    {
+        return;
+    }
+
+    bool slide = other->pressed
+                     ? !other->long_sent && !other->consumed
+                     : other->short_release &&
+                           now_ms - other->release_ms < gesture_timing.slide_ms;
+
+    if (!slide)
+    {
+        return;
+    }
+
+    // The slide replaces a tap of the first pad still in its double window
+    other->tap_pending = false;
+    other->short_release = false;
+    other->consumed = other->pressed;
+    pad->consumed = true;
+    gesture_emit(GESTURE_SLIDE, !id, now_ms);
+}
+
+static void gesture_pad_release(uint8_t id, uint32_t now_ms)
+{
+    gesture_pad_t *pad = &gesture_pads[id];
+
+    pad->pressed = false;
+    pad->release_ms = now_ms;
+    pad->short_release = false;
+
+    if (pad->consumed || pad->long_sent)
+    {
+        pad->consumed = false;
+        return;
+    }
+
+    pad->short_release = true;
+
+    if (pad->tap_pending)
+    {
+        pad->tap_pending = false;
+        gesture_emit(GESTURE_DOUBLE_TAP, id, pad->tap_ms);
+        return;
+    }
+
+    if (gesture_timing.double_ms == 0)
+    {
+        gesture_emit(GESTURE_TAP, id, pad->press_ms);
+        return;
+    }
+
+    pad->tap_pending = true;
+    pad->tap_ms = pad->press_ms;
+}
+
+static uint32_t gesture_delay(uint32_t delay, uint32_t at_ms, uint32_t now_ms)
+{
+    int32_t remaining = (int32_t)(at_ms - now_ms);
+    uint32_t candidate = remaining > 0 ? remaining : 1;
+
+    return (delay == 0 || candidate < delay) ? candidate : delay;
+}
+
+uint32_t touch_gesture_update(bool a, bool b, uint32_t now_ms)
+{
+    bool pressed[2] = {a, b};
+
+    // Timeouts first, so that an edge sees the gestures they completed
+    for (uint8_t id = 0; id < 2; id++)
+    {
+        gesture_pad_timeouts(id, now_ms);
+    }
+
+    if (pressed[0] && pressed[1] && !gesture_pads[0].pressed &&
+        !gesture_pads[1].pressed)
+    {
+        // Both pads at once are no slide, and neither is a tap
+        for (uint8_t id = 0; id < 2; id++)
+        {
+            gesture_pads[id].pressed = true;
+            gesture_pads[id].long_sent = false;
+            gesture_pads[id].consumed = true;
+            gesture_pads[id].press_ms = now_ms;
+        }
+    }
+    else
+    {
+        for (uint8_t id = 0; id < 2; id++)
+        {
+            if (pressed[id] && !gesture_pads[id].pressed)
+            {
+                gesture_pad_press(id, now_ms);
+            }
+            else if (!pressed[id] && gesture_pads[id].pressed)
+            {
+                gesture_pad_release(id, now_ms);
+            }
+        }
+    }
+
+    uint32_t delay = 0;
+
+    for (uint8_t id = 0; id < 2; id++)
+    {
+        gesture_pad_t *pad = &gesture_pads[id];
+
+        if (pad->tap_pending && !pad->pressed)
+        {
+            delay = gesture_delay(delay,
+                                  pad->release_ms + gesture_timing.double_ms,
+                                  now_ms);
+        }
+
+        if (!pad->pressed)
+        {
+            continue;
+        }
+
+        delay = gesture_delay(delay, now_ms + GESTURE_POLL_MS, now_ms);
+
+        if (pad->consumed)
+        {
+            continue;
+        }
+
+        if (!pad->long_sent)
+        {
+            delay = gesture_delay(delay,
+                                  pad->press_ms + gesture_timing.long_ms,
+                                  now_ms);
+        }
+        else if (gesture_timing.hold_ms > 0)
+        {
+            delay = gesture_delay(delay, pad->next_hold_ms, now_ms);
+        }
+    }
+
+    return delay;
+}
+
+// The names touch.state() and touch.wait() give each action
+static mp_obj_t touch_action_name(touch_action_t action)
+{
+    switch (action)
+    {
+    case TOUCH_A:
+        return MP_OBJ_NEW_QSTR(MP_QSTR_A);
+    case TOUCH_B:
+        return MP_OBJ_NEW_QSTR(MP_QSTR_B);
+    case TOUCH_BOTH:
+        return MP_OBJ_NEW_QSTR(MP_QSTR_BOTH);
+    default:
+        return mp_const_none;
     }
 }
 
@@ -49,17 +411,7 @@ STATIC mp_obj_t touch_state(size_t n_args, const mp_obj_t *args)
 
     if (n_args == 0)
     {
-        switch (action)
-        {
-        case TOUCH_A:
-            return MP_OBJ_NEW_QSTR(MP_QSTR_A);
-        case TOUCH_B:
-            return MP_OBJ_NEW_QSTR(MP_QSTR_B);
-        case TOUCH_BOTH:
-            return MP_OBJ_NEW_QSTR(MP_QSTR_BOTH);
-        default:
-            return mp_const_none;
-        }
+        return touch_action_name(action);
     }
 
     qstr button = mp_obj_str_get_qstr(args[0]);
@@ -148,14 +500,124 @@ STATIC mp_obj_t touch_callback(size_t n_args, const mp_obj_t *args)
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(touch_callback_obj, 1, 2, touch_callback);
 
+STATIC mp_obj_t touch_gesture(size_t n_args, const mp_obj_t *args)
+{
+    if (n_args == 0)
+    {
+        mp_obj_t callback = MP_STATE_PORT(touch_gesture_callback);
+        return callback == MP_OBJ_NULL ? mp_const_none : callback;
+    }
+
+    if (!mp_obj_is_callable(args[0]) && (args[0] != mp_const_none))
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("callback must be None or a callable object"));
+    }
+
+    MP_STATE_PORT(touch_gesture_callback) = args[0];
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(touch_gesture_obj, 0, 1, touch_gesture);
+
+STATIC mp_obj_t touch_timing(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
+{
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_double, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none}},
+        {MP_QSTR_long, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none}},
+        {MP_QSTR_hold, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none}},
+        {MP_QSTR_slide, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args,
+                     MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    uint16_t *values[] = {
+        &gesture_timing.double_ms,
+        &gesture_timing.long_ms,
+        &gesture_timing.hold_ms,
+        &gesture_timing.slide_ms,
+    };
+
+    // Check them all before changing any
+    for (size_t i = 0; i < MP_ARRAY_SIZE(allowed_args); i++)
+    {
+        if (args[i].u_obj != mp_const_none)
+        {
+            mp_int_t ms = mp_obj_get_int(args[i].u_obj);
+
+            if (ms < 0 || ms > 10000)
+            {
+                mp_raise_ValueError(
+                    MP_ERROR_TEXT("timings must be between 0 and 10000ms"));
+            }
+        }
+    }
+
+    mp_obj_t timing = mp_obj_new_dict(MP_ARRAY_SIZE(allowed_args));
+
+    for (size_t i = 0; i < MP_ARRAY_SIZE(allowed_args); i++)
+    {
+        if (args[i].u_obj != mp_const_none)
+        {
+            *values[i] = mp_obj_get_int(args[i].u_obj);
+        }
+
+        mp_obj_dict_store(timing,
+                          MP_OBJ_NEW_QSTR(allowed_args[i].qst),
+                          MP_OBJ_NEW_SMALL_INT(*values[i]));
+    }
+
+    return timing;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(touch_timing_obj, 0, touch_timing);
+
+STATIC bool touch_wait_ready(void)
+{
+    return touch_wait_action != TOUCH_NONE;
+}
+
+STATIC mp_obj_t touch_wait_result(void)
+{
+    touch_action_t action = touch_wait_action;
+    touch_wait_action = TOUCH_NONE;
+
+    return touch_action_name(action);
+}
+
+STATIC const awaitable_obj_t touch_wait_awaitable = {
+    {&awaitable_type},
+    touch_wait_ready,
+    touch_wait_result,
+};
+
+STATIC mp_obj_t touch_wait(void)
+{
+    // Only touches from now on complete the await
+    touch_wait_action = TOUCH_NONE;
+
+    return MP_OBJ_FROM_PTR(&touch_wait_awaitable);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(touch_wait_obj, touch_wait);
+
 STATIC const mp_rom_map_elem_t touch_module_globals_table[] = {
 
     {MP_ROM_QSTR(MP_QSTR_state), MP_ROM_PTR(&touch_state_obj)},
     {MP_ROM_QSTR(MP_QSTR_callback), MP_ROM_PTR(&touch_callback_obj)},
+    {MP_ROM_QSTR(MP_QSTR_wait), MP_ROM_PTR(&touch_wait_obj)},
+    {MP_ROM_QSTR(MP_QSTR_gesture), MP_ROM_PTR(&touch_gesture_obj)},
+    {MP_ROM_QSTR(MP_QSTR_timing), MP_ROM_PTR(&touch_timing_obj)},
 
     {MP_ROM_QSTR(MP_QSTR_A), MP_ROM_QSTR(MP_QSTR_A)},
     {MP_ROM_QSTR(MP_QSTR_B), MP_ROM_QSTR(MP_QSTR_B)},
     {MP_ROM_QSTR(MP_QSTR_BOTH), MP_ROM_QSTR(MP_QSTR_BOTH)},
+
+    {MP_ROM_QSTR(MP_QSTR_TAP), MP_ROM_QSTR(MP_QSTR_TAP)},
+    {MP_ROM_QSTR(MP_QSTR_DOUBLE_TAP), MP_ROM_QSTR(MP_QSTR_DOUBLE_TAP)},
+    {MP_ROM_QSTR(MP_QSTR_LONG_PRESS), MP_ROM_QSTR(MP_QSTR_LONG_PRESS)},
+    {MP_ROM_QSTR(MP_QSTR_HOLD), MP_ROM_QSTR(MP_QSTR_HOLD)},
+    {MP_ROM_QSTR(MP_QSTR_SLIDE), MP_ROM_QSTR(MP_QSTR_SLIDE)},
 };
 STATIC MP_DEFINE_CONST_DICT(touch_module_globals, touch_module_globals_table);
 
@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 typedef enum touch_action_t
 {
     TOUCH_NONE,
@@ -32,4 +35,12 @@ typedef enum touch_action_t
     TOUCH_BOTH
 } touch_action_t;
 
-void touch_event_handler(touch_action_t action);
\ No newline at end of file
+void touch_event_handler(touch_action_t action);
+
+/**
+ * @brief Gesture recognizer, fed with the pad states read by the touch bottom
+ *        half in main.c. Returns the delay in milliseconds until it needs to
+ *        be called again, for timeouts, or 0 if it doesn't.
+ */
+
+uint32_t touch_gesture_update(bool a, bool b, uint32_t now_ms);
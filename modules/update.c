@@ -22,8 +22,15 @@
  * PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <string.h>
+#include "bootloader/staged_update.h"
+#include "fontstore.h"
+#include "inflate.h"
+#include "lib/crypto-algorithms/sha256.h"
+#include "lib/uzlib/uzlib.h"
 #include "monocle.h"
 #include "py/runtime.h"
+#include "storage.h"
 
 STATIC mp_obj_t update_nrf52(void)
 {
@@ -35,43 +42,386 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_0(update_nrf52_obj, update_nrf52);
 
 const struct _mp_obj_type_t fpga_app_type;
 
+// The app ends with the "done" magic word at 0x6C80E
+#define FPGA_APP_LENGTH (0x6C80E + 4)
+
+// Upload sessions log a checkpoint each time a sector is complete, into the
+// unused end of the last sector, so that an interrupted upload can resume
+#define FPGA_APP_LOG_START 0x6C880
+#define FPGA_APP_LOG_SECTOR 0x6C000
+#define FPGA_APP_LOG_LEN ((0x6D000 - FPGA_APP_LOG_START) / sizeof(fpga_app_checkpoint_t))
+
+typedef struct fpga_app_checkpoint_t
+{
+    uint32_t image_length;
+    uint32_t image_crc;
+    uint32_t offset;
+    uint32_t crc;
+} fpga_app_checkpoint_t;
+
 static size_t fpga_app_programmed_bytes = 0;
+static uint32_t fpga_app_crc = 0xFFFFFFFF;
 
-STATIC mp_obj_t update_fpga_app_read(mp_obj_t address, mp_obj_t length)
+static struct fpga_app_session_t
+{
+    bool active;
+    uint32_t image_length;
+    uint32_t image_crc;
+    size_t erased_until;
+    size_t log_index;
+} session = {
+    .active = false,
+};
+
+// Kept as a root pointer so the GC doesn't free it between writes
+MP_REGISTER_ROOT_POINTER(void *update_inflate);
+
+static void fpga_app_check_range(mp_int_t address, mp_int_t length)
 {
-    if (mp_obj_get_int(address) + mp_obj_get_int(length) > 0x6C80E + 4)
+    if (address < 0 || length < 0 || address + length > FPGA_APP_LENGTH)
     {
         mp_raise_ValueError(
             MP_ERROR_TEXT("address + length cannot exceed 444434 bytes"));
     }
+}
+
+STATIC mp_obj_t update_fpga_app_read(mp_obj_t address, mp_obj_t length)
+{
+    fpga_app_check_range(mp_obj_get_int(address), mp_obj_get_int(length));
 
-    uint8_t buffer[mp_obj_get_int(length)];
+    vstr_t vstr;
+    vstr_init_len(&vstr, mp_obj_get_int(length));
 
-    monocle_flash_read(buffer, mp_obj_get_int(address), mp_obj_get_int(length));
+    monocle_flash_read((uint8_t *)vstr.buf, mp_obj_get_int(address), vstr.len);
 
-    return mp_obj_new_bytes(buffer, mp_obj_get_int(length));
+    return mp_obj_new_bytes_from_vstr(&vstr);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(update_read_fpga_app_obj, update_fpga_app_read);
 
-STATIC mp_obj_t update_fpga_app_write(mp_obj_t bytes)
+STATIC mp_obj_t update_fpga_app_readinto(mp_obj_t address, mp_obj_t buffer)
 {
-    size_t length;
-    const char *data = mp_obj_str_get_data(bytes, &length);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_WRITE);
 
-    if (fpga_app_programmed_bytes + length > 0x6C80E + 4)
+    fpga_app_check_range(mp_obj_get_int(address), bufinfo.len);
+
+    monocle_flash_read(bufinfo.buf, mp_obj_get_int(address), bufinfo.len);
+
+    return mp_obj_new_int(bufinfo.len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(update_readinto_fpga_app_obj, update_fpga_app_readinto);
+
+// Digests stream through the flash in chunks, so any length can be checked
+static void flash_check_range(mp_int_t address, mp_int_t length)
+{
+    if (address < 0 || length < 0 || address + length > 0x100000)
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("address + length cannot exceed 1048576 bytes"));
+    }
+}
+
+static uint32_t flash_crc32(size_t address, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    uint8_t buffer[256];
+
+    for (size_t i = 0; i < length; i += sizeof(buffer))
+    {
+        size_t chunk = MIN(sizeof(buffer), length - i);
+        monocle_flash_read(buffer, address + i, chunk);
+        crc = uzlib_crc32(buffer, chunk, crc);
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+STATIC mp_obj_t update_crc32(mp_obj_t address, mp_obj_t length)
+{
+    flash_check_range(mp_obj_get_int(address), mp_obj_get_int(length));
+
+    return mp_obj_new_int_from_uint(
+        flash_crc32(mp_obj_get_int(address), mp_obj_get_int(length)));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(update_crc32_obj, update_crc32);
+
+static void flash_sha256(size_t address, size_t length, uint8_t digest[32])
+{
+    CRYAL_SHA256_CTX context;
+    uint8_t buffer[256];
+    sha256_init(&context);
+
+    for (size_t i = 0; i < length; i += sizeof(buffer))
+    {
+        size_t chunk = MIN(sizeof(buffer), length - i);
+        monocle_flash_read(buffer, address + i, chunk);
+        sha256_update(&context, buffer, chunk);
+    }
+
+    sha256_final(&context, digest);
+}
+
+STATIC mp_obj_t update_sha256(mp_obj_t address_in, mp_obj_t length_in)
+{
+    mp_int_t address = mp_obj_get_int(address_in);
+    mp_int_t length = mp_obj_get_int(length_in);
+    flash_check_range(address, length);
+
+    uint8_t digest[32];
+    flash_sha256(address, length, digest);
+
+    return mp_obj_new_bytes(digest, sizeof(digest));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(update_sha256_obj, update_sha256);
+
+static void fpga_app_erase_next(void)
+{
+    // The log sector was erased when the session started, and is kept
+    if (session.erased_until != FPGA_APP_LOG_SECTOR)
+    {
+        monocle_flash_page_erase(session.erased_until);
+    }
+
+    session.erased_until += 0x1000;
+}
+
+static void fpga_app_checkpoint(void)
+{
+    if (session.log_index >= FPGA_APP_LOG_LEN)
+    {
+        return;
+    }
+
+    fpga_app_checkpoint_t checkpoint = {
+        .image_length = session.image_length,
+        .image_crc = session.image_crc,
+        .offset = fpga_app_programmed_bytes,
+        .crc = fpga_app_crc,
+    };
+
+    monocle_flash_write((uint8_t *)&checkpoint,
+                        FPGA_APP_LOG_START + session.log_index * sizeof(checkpoint),
+                        sizeof(checkpoint));
+    session.log_index++;
+}
+
+static void fpga_app_write(const uint8_t *data, size_t length)
+{
+    if (fpga_app_programmed_bytes + length > FPGA_APP_LENGTH)
     {
         mp_raise_ValueError(
             MP_ERROR_TEXT("data will overflow the space reserved for the app"));
     }
 
-    monocle_flash_write((uint8_t *)data, fpga_app_programmed_bytes, length);
+    while (session.active &&
+           session.erased_until < fpga_app_programmed_bytes + length)
+    {
+        fpga_app_erase_next();
+    }
+
+    // Sessions split the data at sector boundaries, and checkpoint exactly
+    // there, so resuming never erases bytes that the checkpoint covers
+    for (size_t i = 0; i < length;)
+    {
+        size_t chunk = length - i;
+        if (session.active)
+        {
+            chunk = MIN(chunk, 0x1000 - fpga_app_programmed_bytes % 0x1000);
+        }
+
+        monocle_flash_write((uint8_t *)data + i, fpga_app_programmed_bytes, chunk);
+        fpga_app_programmed_bytes += chunk;
+        fpga_app_crc = uzlib_crc32(data + i, chunk, fpga_app_crc);
+        i += chunk;
+
+        if (session.active && fpga_app_programmed_bytes % 0x1000 == 0)
+        {
+            fpga_app_checkpoint();
+        }
+    }
+
+    if (!session.active)
+    {
+        return;
+    }
 
-    fpga_app_programmed_bytes += length;
+    // Start erasing the next sector if the next chunk is likely to need it.
+    // That runs while the chunk is on its way over Bluetooth
+    if (session.erased_until < FPGA_APP_LENGTH &&
+        session.erased_until - fpga_app_programmed_bytes < length)
+    {
+        fpga_app_erase_next();
+    }
+}
+
+STATIC mp_obj_t update_fpga_app_write(mp_obj_t bytes)
+{
+    size_t length;
+    const char *data = mp_obj_str_get_data(bytes, &length);
+
+    fpga_app_write((const uint8_t *)data, length);
 
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(update_write_fpga_app_obj, update_fpga_app_write);
 
+static void fpga_app_inflate_output(void *context, const uint8_t *bytes, size_t len)
+{
+    (void)context;
+    fpga_app_write(bytes, len);
+}
+
+static void fpga_app_inflate_free(void)
+{
+    m_del_obj(inflate_stream_t, MP_STATE_PORT(update_inflate));
+    MP_STATE_PORT(update_inflate) = NULL;
+}
+
+static void fpga_app_inflate_check(int status)
+{
+    if (status < 0)
+    {
+        fpga_app_inflate_free();
+        mp_raise_ValueError(MP_ERROR_TEXT("compressed data is invalid"));
+    }
+}
+
+STATIC mp_obj_t update_fpga_app_write_compressed(mp_obj_t bytes)
+{
+    size_t length;
+    const char *data = mp_obj_str_get_data(bytes, &length);
+
+    // The decompressor is only allocated while an update is in progress
+    if (MP_STATE_PORT(update_inflate) == NULL)
+    {
+        MP_STATE_PORT(update_inflate) = m_new_obj(inflate_stream_t);
+        inflate_stream_init(MP_STATE_PORT(update_inflate),
+                            true,
+                            fpga_app_inflate_output,
+                            NULL);
+    }
+
+    fpga_app_inflate_check(
+        inflate_stream_write(MP_STATE_PORT(update_inflate),
+                             (const uint8_t *)data,
+                             length));
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(update_write_fpga_app_compressed_obj, update_fpga_app_write_compressed);
+
+STATIC mp_obj_t update_fpga_app_finish(void)
+{
+    if (MP_STATE_PORT(update_inflate) != NULL)
+    {
+        fpga_app_inflate_check(
+            inflate_stream_finish(MP_STATE_PORT(update_inflate)));
+        fpga_app_inflate_free();
+    }
+
+    if (session.active)
+    {
+        session.active = false;
+
+        if (fpga_app_programmed_bytes != session.image_length ||
+            (fpga_app_crc ^ 0xFFFFFFFF) != session.image_crc)
+        {
+            mp_raise_ValueError(MP_ERROR_TEXT("app does not match the CRC given"));
+        }
+
+        // The running CRC only covers what was sent, so read back the flash
+        if (flash_crc32(0, session.image_length) != session.image_crc)
+        {
+            mp_raise_ValueError(MP_ERROR_TEXT("app in flash does not match the CRC given"));
+        }
+
+        // The only checkpoint that isn't on a sector boundary, at the end
+        fpga_app_checkpoint();
+    }
+
+    return mp_obj_new_int(fpga_app_programmed_bytes);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(update_finish_fpga_app_obj, update_fpga_app_finish);
+
+static bool fpga_app_verify(size_t length, uint32_t crc)
+{
+    return (flash_crc32(0, length) ^ 0xFFFFFFFF) == crc;
+}
+
+STATIC mp_obj_t update_fpga_app_start(mp_obj_t length_in, mp_obj_t crc_in)
+{
+    mp_int_t length = mp_obj_get_int(length_in);
+    uint32_t crc = mp_obj_get_int_truncated(crc_in);
+
+    if (length <= 0 || length > FPGA_APP_LENGTH)
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("length must be between 1 and 444434 bytes"));
+    }
+
+    if (MP_STATE_PORT(update_inflate) != NULL)
+    {
+        fpga_app_inflate_free();
+    }
+
+    session.image_length = length;
+    session.image_crc = crc;
+    session.active = true;
+
+    // Find the latest checkpoint for the same image, and check it's intact
+    fpga_app_checkpoint_t latest = {.offset = 0};
+    size_t log_index = 0;
+
+    for (; log_index < FPGA_APP_LOG_LEN; log_index++)
+    {
+        fpga_app_checkpoint_t checkpoint;
+        monocle_flash_read((uint8_t *)&checkpoint,
+                           FPGA_APP_LOG_START + log_index * sizeof(checkpoint),
+                           sizeof(checkpoint));
+
+        if (checkpoint.offset == 0xFFFFFFFF)
+        {
+            break;
+        }
+
+        if (checkpoint.image_length == length &&
+            checkpoint.image_crc == crc &&
+            checkpoint.offset <= length)
+        {
+            latest = checkpoint;
+        }
+    }
+
+    if (latest.offset > 0 && fpga_app_verify(latest.offset, latest.crc))
+    {
+        // Checkpoints are on sector boundaries, or at the end of a finished
+        // image, so anything after is in sectors that are erased again
+        fpga_app_programmed_bytes = latest.offset;
+        fpga_app_crc = latest.crc;
+        session.erased_until = (latest.offset + 0xFFF) & ~0xFFF;
+        session.log_index = log_index;
+
+        return mp_obj_new_int(latest.offset);
+    }
+
+    // Otherwise start over, with an empty log and the first sector erased
+    monocle_flash_page_erase(FPGA_APP_LOG_SECTOR);
+    fpga_app_programmed_bytes = 0;
+    fpga_app_crc = 0xFFFFFFFF;
+    session.erased_until = 0;
+    session.log_index = 0;
+    fpga_app_erase_next();
+
+    return MP_OBJ_NEW_SMALL_INT(0);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(update_start_fpga_app_obj, update_fpga_app_start);
+
+STATIC mp_obj_t update_fpga_app_crc(void)
+{
+    return mp_obj_new_int_from_uint(fpga_app_crc ^ 0xFFFFFFFF);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(update_crc_fpga_app_obj, update_fpga_app_crc);
+
 STATIC mp_obj_t update_fpga_app_delete(void)
 {
     for (size_t i = 0; i < 0x6D; i++)
@@ -80,17 +430,244 @@ STATIC mp_obj_t update_fpga_app_delete(void)
     }
 
     fpga_app_programmed_bytes = 0;
+    fpga_app_crc = 0xFFFFFFFF;
+    session.active = false;
+
+    if (MP_STATE_PORT(update_inflate) != NULL)
+    {
+        fpga_app_inflate_free();
+    }
 
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(update_erase_fpga_app_obj, update_fpga_app_delete);
 
+static size_t assets_programmed_bytes = 0;
+
+static void assets_check_free(void)
+{
+    // Filesystems formatted before the asset store was reserved still cover it
+    if (storage_overlaps(FONTSTORE_START, FONTSTORE_LENGTH))
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("the filesystem overlaps the asset store, "
+                                   "see update.migrate_filesystem()"));
+    }
+}
+
+STATIC mp_obj_t update_assets_write(mp_obj_t bytes)
+{
+    size_t length;
+    const char *data = mp_obj_str_get_data(bytes, &length);
+
+    assets_check_free();
+
+    if (assets_programmed_bytes + length > FONTSTORE_LENGTH)
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("data will overflow the space reserved for assets"));
+    }
+
+    monocle_flash_write((uint8_t *)data,
+                        FONTSTORE_START + assets_programmed_bytes,
+                        length);
+
+    assets_programmed_bytes += length;
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(update_write_assets_obj, update_assets_write);
+
+STATIC mp_obj_t update_assets_erase(void)
+{
+    assets_check_free();
+
+    for (size_t i = 0; i < FONTSTORE_LENGTH; i += 0x1000)
+    {
+        monocle_flash_page_erase(FONTSTORE_START + i);
+    }
+
+    assets_programmed_bytes = 0;
+    fontstore_reset();
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(update_erase_assets_obj, update_assets_erase);
+
+// Application images are staged into external flash while the current one
+// keeps running, and the bootloader only copies them once complete
+static struct nrf52_session_t
+{
+    bool active;
+    uint32_t init_length;
+    uint32_t image_length;
+    uint8_t hash[32];
+    size_t programmed_bytes;
+    size_t erased_until;
+} nrf52_session = {
+    .active = false,
+};
+
+static void nrf52_check_free(void)
+{
+    // Filesystems formatted before the update slot was reserved still cover it
+    if (storage_overlaps(STAGED_UPDATE_START, STAGED_UPDATE_LENGTH))
+    {
+        mp_raise_msg(&mp_type_OSError,
+                     MP_ERROR_TEXT("the filesystem overlaps the update slot, "
+                                   "see update.migrate_filesystem()"));
+    }
+}
+
+static void nrf52_check_active(void)
+{
+    if (!nrf52_session.active)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("no update was started"));
+    }
+}
+
+STATIC mp_obj_t update_nrf52_start(mp_obj_t init_packet)
+{
+    size_t length;
+    const char *data = mp_obj_str_get_data(init_packet, &length);
+
+    const uint8_t *hash;
+    uint32_t image_length;
+
+    if (length > STAGED_UPDATE_INIT_MAX_LENGTH ||
+        !staged_update_parse((const uint8_t *)data, length, &hash, &image_length))
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("init packet is invalid"));
+    }
+
+    if (image_length == 0 || image_length > STAGED_UPDATE_IMAGE_MAX_LENGTH)
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("image length must be between 1 and 335872 bytes"));
+    }
+
+    nrf52_check_free();
+
+    memcpy(nrf52_session.hash, hash, sizeof(nrf52_session.hash));
+    nrf52_session.init_length = length;
+    nrf52_session.image_length = image_length;
+    nrf52_session.programmed_bytes = 0;
+    nrf52_session.erased_until = STAGED_UPDATE_IMAGE_START;
+    nrf52_session.active = true;
+
+    // The init packet goes in now, the rest of the header once the image is
+    // verified, which is what makes the slot valid
+    monocle_flash_page_erase(STAGED_UPDATE_START);
+    monocle_flash_write((uint8_t *)data,
+                        STAGED_UPDATE_START + offsetof(staged_update_header_t, init),
+                        length);
+
+    return mp_obj_new_int(image_length);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(update_start_nrf52_obj, update_nrf52_start);
+
+STATIC mp_obj_t update_nrf52_write(mp_obj_t bytes)
+{
+    size_t length;
+    const char *data = mp_obj_str_get_data(bytes, &length);
+
+    nrf52_check_active();
+
+    if (nrf52_session.programmed_bytes + length > nrf52_session.image_length)
+    {
+        mp_raise_ValueError(
+            MP_ERROR_TEXT("data is longer than the image in the init packet"));
+    }
+
+    size_t address = STAGED_UPDATE_IMAGE_START + nrf52_session.programmed_bytes;
+
+    while (nrf52_session.erased_until < address + length)
+    {
+        monocle_flash_page_erase(nrf52_session.erased_until);
+        nrf52_session.erased_until += 0x1000;
+    }
+
+    monocle_flash_write((uint8_t *)data, address, length);
+    nrf52_session.programmed_bytes += length;
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(update_write_nrf52_obj, update_nrf52_write);
+
+STATIC mp_obj_t update_nrf52_finish(void)
+{
+    nrf52_check_active();
+    nrf52_session.active = false;
+
+    if (nrf52_session.programmed_bytes != nrf52_session.image_length)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("image is incomplete"));
+    }
+
+    // Read back what was written. The init packet has the hash little endian
+    uint8_t digest[32];
+    flash_sha256(STAGED_UPDATE_IMAGE_START, nrf52_session.image_length, digest);
+
+    for (size_t i = 0; i < sizeof(digest); i++)
+    {
+        if (digest[i] != nrf52_session.hash[sizeof(digest) - 1 - i])
+        {
+            mp_raise_ValueError(
+                MP_ERROR_TEXT("image does not match the init packet hash"));
+        }
+    }
+
+    uint32_t header[] = {
+        STAGED_UPDATE_MAGIC,
+        STAGED_UPDATE_STATE_READY,
+        nrf52_session.init_length,
+        nrf52_session.image_length,
+    };
+    monocle_flash_write((uint8_t *)header, STAGED_UPDATE_START, sizeof(header));
+
+    return mp_obj_new_int(nrf52_session.image_length);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(update_finish_nrf52_obj, update_nrf52_finish);
+
+STATIC mp_obj_t update_nrf52_apply(void)
+{
+    staged_update_header_t header;
+    monocle_flash_read((uint8_t *)&header, STAGED_UPDATE_START,
+                       offsetof(staged_update_header_t, init));
+
+    if (header.magic != STAGED_UPDATE_MAGIC ||
+        header.state != STAGED_UPDATE_STATE_READY)
+    {
+        mp_raise_ValueError(MP_ERROR_TEXT("no verified image is staged"));
+    }
+
+    storage_flush_all();
+    monocle_enter_staged_update();
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(update_apply_nrf52_obj, update_nrf52_apply);
+
 STATIC const mp_rom_map_elem_t update_module_globals_table[] = {
 
     {MP_ROM_QSTR(MP_QSTR_nrf52), MP_ROM_PTR(&update_nrf52_obj)},
+    {MP_ROM_QSTR(MP_QSTR_start_nrf52), MP_ROM_PTR(&update_start_nrf52_obj)},
+    {MP_ROM_QSTR(MP_QSTR_write_nrf52), MP_ROM_PTR(&update_write_nrf52_obj)},
+    {MP_ROM_QSTR(MP_QSTR_finish_nrf52), MP_ROM_PTR(&update_finish_nrf52_obj)},
+    {MP_ROM_QSTR(MP_QSTR_apply_nrf52), MP_ROM_PTR(&update_apply_nrf52_obj)},
     {MP_ROM_QSTR(MP_QSTR_read_fpga_app), MP_ROM_PTR(&update_read_fpga_app_obj)},
+    {MP_ROM_QSTR(MP_QSTR_readinto_fpga_app), MP_ROM_PTR(&update_readinto_fpga_app_obj)},
     {MP_ROM_QSTR(MP_QSTR_write_fpga_app), MP_ROM_PTR(&update_write_fpga_app_obj)},
+    {MP_ROM_QSTR(MP_QSTR_write_fpga_app_compressed), MP_ROM_PTR(&update_write_fpga_app_compressed_obj)},
+    {MP_ROM_QSTR(MP_QSTR_start_fpga_app), MP_ROM_PTR(&update_start_fpga_app_obj)},
+    {MP_ROM_QSTR(MP_QSTR_crc_fpga_app), MP_ROM_PTR(&update_crc_fpga_app_obj)},
+    {MP_ROM_QSTR(MP_QSTR_finish_fpga_app), MP_ROM_PTR(&update_finish_fpga_app_obj)},
     {MP_ROM_QSTR(MP_QSTR_erase_fpga_app), MP_ROM_PTR(&update_erase_fpga_app_obj)},
+    {MP_ROM_QSTR(MP_QSTR_write_assets), MP_ROM_PTR(&update_write_assets_obj)},
+    {MP_ROM_QSTR(MP_QSTR_erase_assets), MP_ROM_PTR(&update_erase_assets_obj)},
+    {MP_ROM_QSTR(MP_QSTR_crc32), MP_ROM_PTR(&update_crc32_obj)},
+    {MP_ROM_QSTR(MP_QSTR_sha256), MP_ROM_PTR(&update_sha256_obj)},
 };
 STATIC MP_DEFINE_CONST_DICT(update_module_globals, update_module_globals_table);
 
@@ -30,12 +30,85 @@ def micropython():
     print("If the update fails, it will stay in the update mode and you can try again.")
     __update.nrf52()
 
+class Nrf52:
+    def start(init_packet):
+        return __update.start_nrf52(init_packet)
+
+    def write(data):
+        return __update.write_nrf52(data)
+
+    def finish():
+        return __update.finish_nrf52()
+
+    def apply():
+        print("Monocle will now restart with the new firmware.")
+        __update.apply_nrf52()
+
+def migrate_filesystem():
+    import os, gc, device
+
+    # Files are moved into a filesystem of the current size on the next boot
+    if os.statvfs('/')[2] <= device.Storage().ioctl(4, 0):
+        raise ValueError("the filesystem already has the current layout")
+
+    size = 0
+    stack = ['/']
+    while stack:
+        path = stack.pop()
+        for entry in os.ilistdir(path):
+            if entry[1] == 0x4000:
+                if path + entry[0] != '/.mpy':
+                    stack.append(path + entry[0] + '/')
+            else:
+                size += entry[3]
+
+    gc.collect()
+    if size > gc.mem_free() // 2:
+        raise OSError("the files are too large to move, delete some first")
+
+    # Left by an earlier attempt, with the reason it stayed on this layout
+    try:
+        os.remove('/.migrate_failed')
+    except OSError:
+        pass
+
+    open('/.migrate', 'w').close()
+    print("Monocle will now restart and move the files to the new layout.")
+    device.reset()
+
+def crc32(address, length):
+    return __update.crc32(address, length)
+
+def sha256(address, length):
+    return __update.sha256(address, length)
+
 class Fpga:
     def read(address, length):
         return __update.read_fpga_app(address, length)
+
+    def readinto(address, buffer):
+        return __update.readinto_fpga_app(address, buffer)
+
+    def start(length, crc):
+        return __update.start_fpga_app(length, crc)
+
+    def crc():
+        return __update.crc_fpga_app()
     
-    def write(data):
+    def write(data, compressed=False):
+        if compressed:
+            return __update.write_fpga_app_compressed(data)
         return __update.write_fpga_app(data)
+
+    def finish():
+        return __update.finish_fpga_app()
     
     def erase():
-        return __update.erase_fpga_app()
\ No newline at end of file
+        return __update.erase_fpga_app()
+
+class Assets:
+    def write(data):
+        return __update.write_assets(data)
+
+    def erase():
+        return __update.erase_assets()
@@ -30,14 +30,20 @@
 #include <math.h>
 #include <string.h>
 #include "monocle.h"
+#include "battery.h"
+#include "bootloader/staged_update.h"
+#include "events.h"
+#include "storage.h"
 #include "nrf_gpio.h"
 #include "nrf_sdm.h"
 #include "nrf_soc.h"
+#include "nrfx_gpiote.h"
 #include "nrfx_systick.h"
 #include "nrf_power.h"
 #include "nrfx_timer.h"
 #include "nrfx_twim.h"
 #include "nrfx_spim.h"
+#include "py/mphal.h"
 
 static const nrfx_twim_t i2c_bus_0 = NRFX_TWIM_INSTANCE(0);
 static const nrfx_twim_t i2c_bus_1 = NRFX_TWIM_INSTANCE(1);
@@ -47,6 +53,40 @@ bool prevent_sleep_flag = false;
 
 bool force_sleep_flag = false;
 
+static boot_mark_t boot_timeline[BOOT_TIMELINE_LENGTH];
+static size_t boot_timeline_length = 0;
+
+// The cycle counter pauses while the CPU sleeps, so the RTC takes over once
+// it runs. This is the cycle counter time at which it started
+static bool boot_rtc_running = false;
+static uint32_t boot_rtc_base_us = 0;
+
+void monocle_boot_mark(const char *step)
+{
+    if (boot_timeline_length == BOOT_TIMELINE_LENGTH)
+    {
+        return;
+    }
+
+    uint32_t us = boot_rtc_running
+                      ? boot_rtc_base_us + mp_hal_ticks_ms() * 1000
+                      : monocle_cycles_now() / 64;
+
+    boot_timeline[boot_timeline_length++] = (boot_mark_t){step, us};
+}
+
+void monocle_boot_rtc_started(void)
+{
+    boot_rtc_base_us = monocle_cycles_now() / 64 - mp_hal_ticks_ms() * 1000;
+    boot_rtc_running = true;
+}
+
+size_t monocle_boot_timeline(const boot_mark_t **marks)
+{
+    *marks = boot_timeline;
+    return boot_timeline_length;
+}
+
 static void power_all_rails(bool enable)
 {
     if (enable)
@@ -64,13 +104,39 @@ static void power_all_rails(bool enable)
         return;
     }
 
+    // Only wait for the 10V to decay if the boost was on. GPO_DO is bit 3
+    i2c_response_t boost_response = monocle_i2c_read(PMIC_I2C_ADDRESS, 0x13, 0x08);
+    app_err(boost_response.fail);
+
     app_err(monocle_i2c_write(PMIC_I2C_ADDRESS, 0x13, 0x2D, 0x04).fail); // Turn off 10V on PMIC GPIO2
-    nrfx_systick_delay_ms(200);                                          // Let the 10V decay
+    if (boost_response.value)
+    {
+        nrfx_systick_delay_ms(200); // Let the 10V decay
+    }
     app_err(monocle_i2c_write(PMIC_I2C_ADDRESS, 0x2A, 0x0F, 0x0C).fail); // Turn off 2.8V
     app_err(monocle_i2c_write(PMIC_I2C_ADDRESS, 0x39, 0x1F, 0x1C).fail); // Turn off 1.8V on load switch LSW0
     app_err(monocle_i2c_write(PMIC_I2C_ADDRESS, 0x2E, 0x0F, 0x0C).fail); // Turn off 1.2V
 }
 
+// Charger, CHGIN and temperature events come on PMIC_INTERRUPT_PIN. The timer
+// only polls with PMIC_POLL=1, or while going to sleep is being retried. It
+// keeps running in any case, as it also triggers the battery sampling
+static const nrfx_timer_t charge_timer = NRFX_TIMER_INSTANCE(4);
+
+// PMIC interrupt flags, which clear when read, and their masks
+#define PMIC_INT_GLBL0 0x00
+#define PMIC_INT_CHG 0x01
+#define PMIC_INT_M_CHG 0x07
+#define PMIC_INTM_GLBL0 0x09
+
+#define PMIC_INT_CHG_THM 0x01    // Battery temperature zone changed
+#define PMIC_INT_CHG_CHG 0x02    // Charger state changed
+#define PMIC_INT_CHG_CHGIN 0x04  // Charger input inserted or removed
+#define PMIC_INT_GLBL0_TJAL 0x30 // Die temperature alarms 1 and 2
+
+// I2C is read from a software interrupt, so the pin interrupt only pends it
+#define PMIC_BOTTOM_HALF_IRQn SWI0_EGU0_IRQn
+
 static void check_if_battery_charging_and_sleep(nrf_timer_event_t event_type,
                                                 void *p_context)
 {
@@ -82,6 +148,7 @@ static void check_if_battery_charging_and_sleep(nrf_timer_event_t event_type,
     app_err(charging_response.fail);
 
     bool charging = charging_response.value;
+    battery_charging_update(charging);
 
     if (charging || force_sleep_flag)
     {
@@ -90,6 +157,13 @@ static void check_if_battery_charging_and_sleep(nrf_timer_event_t event_type,
             return;
         }
 
+        // Let the filesystem cache write back first, and try again next time
+        if (storage_flush_before_sleep())
+        {
+            nrfx_timer_compare_int_enable(&charge_timer, NRF_TIMER_CC_CHANNEL0);
+            return;
+        }
+
         // Turn off Bluetooth
         app_err(sd_softdevice_disable());
 
@@ -136,6 +210,70 @@ static void check_if_battery_charging_and_sleep(nrf_timer_event_t event_type,
     }
 }
 
+static void pmic_interrupt_handler(nrfx_gpiote_pin_t pin,
+                                   nrf_gpiote_polarity_t polarity)
+{
+    (void)pin;
+    (void)polarity;
+
+    NRFX_IRQ_PENDING_SET(PMIC_BOTTOM_HALF_IRQn);
+}
+
+void SWI0_EGU0_IRQHandler(void)
+{
+    // Reading the flags clears them, and releases nIRQ
+    i2c_response_t global = monocle_i2c_read(PMIC_I2C_ADDRESS, PMIC_INT_GLBL0, 0xFF);
+    app_err(global.fail);
+
+    i2c_response_t charger = monocle_i2c_read(PMIC_I2C_ADDRESS, PMIC_INT_CHG, 0xFF);
+    app_err(charger.fail);
+
+    if (charger.value & (PMIC_INT_CHG_CHG | PMIC_INT_CHG_CHGIN))
+    {
+        events_push(EVENT_CHARGER);
+    }
+
+    if ((charger.value & PMIC_INT_CHG_THM) || (global.value & PMIC_INT_GLBL0_TJAL))
+    {
+        events_push(EVENT_THERMAL);
+    }
+
+    check_if_battery_charging_and_sleep(0, NULL);
+}
+
+void monocle_pmic_irq_init(void)
+{
+    NRFX_IRQ_PRIORITY_SET(PMIC_BOTTOM_HALF_IRQn, 7);
+    NRFX_IRQ_ENABLE(PMIC_BOTTOM_HALF_IRQn);
+
+    // Unmask the charger and temperature interrupts
+    app_err(monocle_i2c_write(PMIC_I2C_ADDRESS, PMIC_INT_M_CHG,
+                              PMIC_INT_CHG_THM | PMIC_INT_CHG_CHG | PMIC_INT_CHG_CHGIN,
+                              0x00)
+                .fail);
+    app_err(monocle_i2c_write(PMIC_I2C_ADDRESS, PMIC_INTM_GLBL0,
+                              PMIC_INT_GLBL0_TJAL, 0x00)
+                .fail);
+
+    // nIRQ is open drain, and stays low until the flags are read
+    nrfx_gpiote_in_config_t config = NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(false);
+    config.pull = NRF_GPIO_PIN_PULLUP;
+
+    app_err(nrfx_gpiote_in_init(PMIC_INTERRUPT_PIN,
+                                &config,
+                                pmic_interrupt_handler));
+
+    nrfx_gpiote_in_event_enable(PMIC_INTERRUPT_PIN, true);
+
+    // Anything flagged before now wouldn't give an edge
+    monocle_pmic_check();
+}
+
+void monocle_pmic_check(void)
+{
+    NRFX_IRQ_PENDING_SET(PMIC_BOTTOM_HALF_IRQn);
+}
+
 void monocle_critical_startup(void)
 {
     // Enable the the DC/DC convertor
@@ -144,6 +282,9 @@ void monocle_critical_startup(void)
     // Enable systick timer functions
     nrfx_systick_init();
 
+    // Time the rest of the boot
+    monocle_cycles_enable();
+
     // Set up the I2C buses
     {
         nrfx_twim_config_t bus_0_config = NRFX_TWIM_DEFAULT_CONFIG(
@@ -156,10 +297,14 @@ void monocle_critical_startup(void)
             CAMERA_I2C_SCL_PIN,
             CAMERA_I2C_SDA_PIN);
 
-        bus_1_config.frequency = NRF_TWIM_FREQ_100K;
+        // The camera supports fast mode, which its long tables make use of
+        bus_1_config.frequency = NRF_TWIM_FREQ_400K;
 
+        // Touch is read from its interrupt, so the PMIC and touch bus stays
+        // blocking, while the camera bus completes from the TWIM interrupt
         app_err(nrfx_twim_init(&i2c_bus_0, &bus_0_config, NULL, NULL));
-        app_err(nrfx_twim_init(&i2c_bus_1, &bus_1_config, NULL, NULL));
+        app_err(nrfx_twim_init(&i2c_bus_1, &bus_1_config,
+                               monocle_i2c_event_handler, NULL));
 
         nrfx_twim_enable(&i2c_bus_0);
         nrfx_twim_enable(&i2c_bus_1);
@@ -223,6 +368,8 @@ void monocle_critical_startup(void)
 
         // Connect AMUX to battery voltage
         app_err(monocle_i2c_write(PMIC_I2C_ADDRESS, 0x28, 0x0F, 0x03).fail);
+
+        monocle_boot_mark("pmic");
     }
 
     // Configure the touch IC
@@ -249,8 +396,20 @@ void monocle_critical_startup(void)
         app_err(monocle_i2c_write(TOUCH_I2C_ADDRESS, 0x63, 0xFF, 0x0A).fail); // Proximity thresholds
         app_err(monocle_i2c_write(TOUCH_I2C_ADDRESS, 0xD0, 0x22, 0x22).fail); // Redo ATI and enable event mode
 
-        // TODO optimize this delay
-        nrfx_systick_delay_ms(1000);
+        // Poll until ATI completes, rather than waiting a whole second. The
+        // IN_ATI flag is bit 2 of the system flags
+        for (uint32_t waited = 0; waited < 1000; waited += 10)
+        {
+            nrfx_systick_delay_ms(10);
+
+            i2c_response_t flags = monocle_i2c_read(TOUCH_I2C_ADDRESS, 0x10, 0x04);
+            if (flags.fail || flags.value == 0)
+            {
+                break;
+            }
+        }
+
+        monocle_boot_mark("touch");
     }
 
     // Start SPI before sleeping otherwise we'll crash
@@ -259,21 +418,20 @@ void monocle_critical_startup(void)
     // This wont return if Monocle is charging
     check_if_battery_charging_and_sleep(0, NULL);
 
-    // Set up a timer for checking charge state periodically
+    // Set up a timer for checking charge state periodically, if polling
     {
-        nrfx_timer_t timer = NRFX_TIMER_INSTANCE(4);
-
         nrfx_timer_config_t timer_config = NRFX_TIMER_DEFAULT_CONFIG;
         timer_config.frequency = NRF_TIMER_FREQ_31250Hz;
         timer_config.bit_width = NRF_TIMER_BIT_WIDTH_24;
-        app_err(nrfx_timer_init(&timer,
+        app_err(nrfx_timer_init(&charge_timer,
                                 &timer_config,
                                 check_if_battery_charging_and_sleep));
 
-        nrfx_timer_extended_compare(&timer, NRF_TIMER_CC_CHANNEL0, 15625,
-                                    NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK, true);
+        nrfx_timer_extended_compare(&charge_timer, NRF_TIMER_CC_CHANNEL0, 15625,
+                                    NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK,
+                                    MONOCLE_PMIC_POLL);
 
-        nrfx_timer_enable(&timer);
+        nrfx_timer_enable(&charge_timer);
     }
 
     // Setup GPIOs and set initial values
@@ -300,7 +458,8 @@ void monocle_critical_startup(void)
                      NRF_GPIO_PIN_S0D1,
                      NRF_GPIO_PIN_NOSENSE);
 
-        // TODO Add interrupt functionality to the FPGA_RESET_INT pin
+        // The interrupt side is set up by monocle_fpga_irq_init() once
+        // GPIOTE is running
 
         // Keep camera, display and FPGA in reset
         nrf_gpio_pin_write(CAMERA_RESET_PIN, false);
@@ -312,6 +471,8 @@ void monocle_critical_startup(void)
         nrf_gpio_pin_write(FPGA_CS_MODE_PIN, true);
         nrf_gpio_pin_write(FLASH_CS_PIN, true);
     }
+
+    monocle_boot_mark("gpio");
 }
 
 void monocle_enter_bootloader(void)
@@ -323,6 +484,19 @@ void monocle_enter_bootloader(void)
     NVIC_SystemReset();
 }
 
+void monocle_enter_staged_update(void)
+{
+    // The bootloader reads the slot itself, so the flash has to stay powered
+    // and awake, with the FPGA held in reset to keep it off the bus
+    monocle_spi_wait();
+    monocle_fpga_reset(false);
+
+    sd_power_gpregret_clr(0, 0xFF);
+    sd_power_gpregret_set(0, STAGED_UPDATE_GPREGRET);
+
+    NVIC_SystemReset();
+}
+
 void monocle_fpga_reset(bool reboot)
 {
     // CAUTION: READ DATASHEET CAREFULLY BEFORE CHANGING THESE
@@ -22,10 +22,12 @@
  * PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <string.h>
 #include "monocle.h"
 #include "py/mphal.h"
 #include "py/runtime.h"
 #include "nrf_gpio.h"
+#include "nrfx_gpiote.h"
 #include "nrfx_spim.h"
 #include "nrfx_twim.h"
 #include "nrfx_systick.h"
@@ -62,6 +64,207 @@ static const nrfx_spim_t spi_bus_2 = NRFX_SPIM_INSTANCE(2);
 
 bool not_real_hardware_flag = false;
 
+// PMIC control registers from 0x11 only change when written, so a masked
+// write can start from their last known value instead of reading it back
+#define PMIC_SHADOW_START 0x11
+#define PMIC_SHADOW_END 0x40
+
+static struct pmic_shadow_t
+{
+    uint64_t valid;
+    uint8_t value[PMIC_SHADOW_END - PMIC_SHADOW_START];
+} pmic_shadow;
+
+static bool i2c_shadowed(uint8_t device_address_7bit, uint16_t register_address)
+{
+    return device_address_7bit == PMIC_I2C_ADDRESS &&
+           register_address >= PMIC_SHADOW_START &&
+           register_address < PMIC_SHADOW_END;
+}
+
+static void i2c_shadow_store(uint8_t device_address_7bit,
+                             uint16_t register_address,
+                             uint8_t value)
+{
+    if (i2c_shadowed(device_address_7bit, register_address))
+    {
+        pmic_shadow.valid |= 1ULL << (register_address - PMIC_SHADOW_START);
+        pmic_shadow.value[register_address - PMIC_SHADOW_START] = value;
+    }
+}
+
+// Camera tables are sent in bursts of consecutive registers, relying on
+// the sensor incrementing the address. Each burst is started from the TWIM
+// interrupt when the previous one is done.
+#define I2C_BURST_MAX 32
+#define I2C_TRIES 3
+
+static struct i2c_table_t
+{
+    i2c_register_t const *table;
+    size_t length;
+    size_t next;
+    size_t burst;
+    uint8_t tries;
+    volatile bool busy;
+    bool fail;
+    uint8_t tx[2 + I2C_BURST_MAX];
+} i2c_table;
+
+// Single transfers on the camera bus wait for their event
+static volatile bool i2c_bus_1_busy = false;
+static volatile nrfx_err_t i2c_bus_1_result;
+
+static void i2c_table_send_burst(void)
+{
+    i2c_register_t const *entry = &i2c_table.table[i2c_table.next];
+    size_t n = 0;
+
+    i2c_table.tx[0] = (uint8_t)(entry->address >> 8);
+    i2c_table.tx[1] = (uint8_t)entry->address;
+
+    while (i2c_table.next + n < i2c_table.length &&
+           n < I2C_BURST_MAX &&
+           entry[n].address == entry->address + n)
+    {
+        i2c_table.tx[2 + n] = entry[n].value;
+        n++;
+    }
+
+    i2c_table.burst = n;
+
+    nrfx_twim_xfer_desc_t i2c_tx = NRFX_TWIM_XFER_DESC_TX(CAMERA_I2C_ADDRESS,
+                                                          i2c_table.tx,
+                                                          2 + n);
+    app_err(nrfx_twim_xfer(&i2c_bus_1, &i2c_tx, 0));
+}
+
+void monocle_i2c_event_handler(nrfx_twim_evt_t const *event, void *context)
+{
+    (void)context;
+
+    if (!i2c_table.busy)
+    {
+        switch (event->type)
+        {
+        case NRFX_TWIM_EVT_DONE:
+            i2c_bus_1_result = NRFX_SUCCESS;
+            break;
+        case NRFX_TWIM_EVT_ADDRESS_NACK:
+            i2c_bus_1_result = NRFX_ERROR_DRV_TWI_ERR_ANACK;
+            break;
+        case NRFX_TWIM_EVT_DATA_NACK:
+            i2c_bus_1_result = NRFX_ERROR_DRV_TWI_ERR_DNACK;
+            break;
+        default:
+            i2c_bus_1_result = NRFX_ERROR_DRV_TWI_ERR_OVERRUN;
+            break;
+        }
+        i2c_bus_1_busy = false;
+        return;
+    }
+
+    if (event->type == NRFX_TWIM_EVT_DONE)
+    {
+        i2c_table.next += i2c_table.burst;
+        i2c_table.tries = 0;
+    }
+    else if (++i2c_table.tries == I2C_TRIES)
+    {
+        i2c_table.fail = true;
+        i2c_table.busy = false;
+        return;
+    }
+
+    if (i2c_table.next == i2c_table.length)
+    {
+        i2c_table.busy = false;
+        return;
+    }
+
+    i2c_table_send_burst();
+}
+
+void monocle_i2c_write_table(uint8_t device_address_7bit,
+                             i2c_register_t const *table,
+                             size_t length)
+{
+    if (not_real_hardware_flag)
+    {
+        return;
+    }
+
+    // The other buses are blocking, as touch is read from an interrupt
+    if (device_address_7bit != CAMERA_I2C_ADDRESS)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            i2c_table.fail |= monocle_i2c_write(device_address_7bit,
+                                                table[i].address,
+                                                0xFF,
+                                                table[i].value)
+                                  .fail;
+        }
+        return;
+    }
+
+    monocle_i2c_wait();
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    i2c_table.table = table;
+    i2c_table.length = length;
+    i2c_table.next = 0;
+    i2c_table.tries = 0;
+    i2c_table.busy = true;
+
+    i2c_table_send_burst();
+}
+
+bool monocle_i2c_wait(void)
+{
+    while (i2c_table.busy)
+    {
+    }
+
+    bool fail = i2c_table.fail;
+    i2c_table.fail = false;
+    return fail;
+}
+
+static nrfx_err_t i2c_xfer(nrfx_twim_t const *i2c_handle,
+                           nrfx_twim_xfer_desc_t const *i2c_xfer_desc)
+{
+    if (i2c_handle->p_twim != i2c_bus_1.p_twim)
+    {
+        return nrfx_twim_xfer(i2c_handle, i2c_xfer_desc, 0);
+    }
+
+    // A table write in progress goes first, keeping its failures for
+    // whoever waits on it
+    while (i2c_table.busy)
+    {
+    }
+
+    i2c_bus_1_busy = true;
+    nrfx_err_t err = nrfx_twim_xfer(i2c_handle, i2c_xfer_desc, 0);
+
+    if (err != NRFX_SUCCESS)
+    {
+        i2c_bus_1_busy = false;
+        return err;
+    }
+
+    while (i2c_bus_1_busy)
+    {
+    }
+
+    return i2c_bus_1_result;
+}
+
 i2c_response_t monocle_i2c_read(uint8_t device_address_7bit,
                                 uint16_t register_address,
                                 uint8_t register_mask)
@@ -100,9 +303,9 @@ i2c_response_t monocle_i2c_read(uint8_t device_address_7bit,
                                                           1);
 
     // Try several times
-    for (uint8_t i = 0; i < 3; i++)
+    for (uint8_t i = 0; i < I2C_TRIES; i++)
     {
-        nrfx_err_t tx_err = nrfx_twim_xfer(&i2c_handle, &i2c_tx, 0);
+        nrfx_err_t tx_err = i2c_xfer(&i2c_handle, &i2c_tx);
 
         if (tx_err == NRFX_ERROR_BUSY ||
             tx_err == NRFX_ERROR_NOT_SUPPORTED ||
@@ -113,7 +316,7 @@ i2c_response_t monocle_i2c_read(uint8_t device_address_7bit,
             app_err(tx_err);
         }
 
-        nrfx_err_t rx_err = nrfx_twim_xfer(&i2c_handle, &i2c_rx, 0);
+        nrfx_err_t rx_err = i2c_xfer(&i2c_handle, &i2c_rx);
 
         if (rx_err == NRFX_ERROR_BUSY ||
             rx_err == NRFX_ERROR_NOT_SUPPORTED ||
@@ -127,6 +330,8 @@ i2c_response_t monocle_i2c_read(uint8_t device_address_7bit,
         if (tx_err == NRFX_SUCCESS && rx_err == NRFX_SUCCESS)
         {
             i2c_response.fail = false;
+            i2c_shadow_store(device_address_7bit, register_address,
+                             i2c_response.value);
             break;
         }
     }
@@ -150,11 +355,19 @@ i2c_response_t monocle_i2c_write(uint8_t device_address_7bit,
 
     if (register_mask != 0xFF)
     {
-        resp = monocle_i2c_read(device_address_7bit, register_address, 0xFF);
-
-        if (resp.fail)
+        if (i2c_shadowed(device_address_7bit, register_address) &&
+            pmic_shadow.valid & (1ULL << (register_address - PMIC_SHADOW_START)))
         {
-            return resp;
+            resp.value = pmic_shadow.value[register_address - PMIC_SHADOW_START];
+        }
+        else
+        {
+            resp = monocle_i2c_read(device_address_7bit, register_address, 0xFF);
+
+            if (resp.fail)
+            {
+                return resp;
+            }
         }
     }
 
@@ -182,9 +395,9 @@ i2c_response_t monocle_i2c_write(uint8_t device_address_7bit,
     }
 
     // Try several times
-    for (uint8_t i = 0; i < 3; i++)
+    for (uint8_t i = 0; i < I2C_TRIES; i++)
     {
-        nrfx_err_t err = nrfx_twim_xfer(&i2c_handle, &i2c_tx, 0);
+        nrfx_err_t err = i2c_xfer(&i2c_handle, &i2c_tx);
 
         if (err == NRFX_ERROR_BUSY ||
             err == NRFX_ERROR_NOT_SUPPORTED ||
@@ -197,11 +410,13 @@ i2c_response_t monocle_i2c_write(uint8_t device_address_7bit,
 
         if (err == NRFX_SUCCESS)
         {
+            i2c_shadow_store(device_address_7bit, register_address,
+                             updated_value);
             break;
         }
 
         // If the last try failed. Don't continue
-        if (i == 2)
+        if (i == I2C_TRIES - 1)
         {
             resp.fail = true;
             return resp;
@@ -211,10 +426,143 @@ i2c_response_t monocle_i2c_write(uint8_t device_address_7bit,
     return resp;
 }
 
+// EasyDMA on the nRF52832 can't move more than 255 bytes per transfer
+#define SPIM_MAX_XFER_LENGTH 255
+
+// Transactions queued on SPIM2, and run one after the other from its
+// interrupt. Short writes are copied in, so callers can queue commands
+// from the stack.
+#define SPI_QUEUE_SIZE 8
+#define SPI_INLINE_LENGTH 8
+
+typedef struct spi_queue_entry_t
+{
+    spi_transaction_t transaction;
+    uint8_t inline_tx[SPI_INLINE_LENGTH];
+    size_t offset;
+} spi_queue_entry_t;
+
+static spi_queue_entry_t spi_queue[SPI_QUEUE_SIZE];
+static volatile size_t spi_queue_head = 0;
+static volatile size_t spi_queue_tail = 0;
+
+// Running counts of transactions queued and completed, so that callers can
+// wait for one of their own instead of the whole queue
+static volatile uint32_t spi_submitted = 0;
+static volatile uint32_t spi_completed = 0;
+
+// Set while the last transaction queued keeps its chip select down, as the
+// next one belongs to the same exchange
+static bool spi_cs_held = false;
+
+// The display and FPGA are LSB first, flash is MSB first and can go faster.
+// The bus is reconfigured whenever a transaction starts.
+static const struct spi_device_config_t
+{
+    uint8_t cs_pin;
+    nrf_spim_frequency_t frequency;
+    nrf_spim_bit_order_t bit_order;
+} spi_devices[] = {
+    [DISPLAY] = {DISPLAY_CS_PIN, NRF_SPIM_FREQ_4M, NRF_SPIM_BIT_ORDER_LSB_FIRST},
+    [FPGA] = {FPGA_CS_MODE_PIN, NRF_SPIM_FREQ_4M, NRF_SPIM_BIT_ORDER_LSB_FIRST},
+    [FLASH] = {FLASH_CS_PIN, NRF_SPIM_FREQ_8M, NRF_SPIM_BIT_ORDER_MSB_FIRST},
+};
+
+static uint8_t spi_cs_pin(spi_device_t spi_device)
+{
+    return spi_devices[spi_device].cs_pin;
+}
+
+static void spi_configure(spi_device_t spi_device)
+{
+    nrf_spim_configure(spi_bus_2.p_reg,
+                       NRF_SPIM_MODE_3,
+                       spi_devices[spi_device].bit_order);
+    nrf_spim_frequency_set(spi_bus_2.p_reg,
+                           spi_devices[spi_device].frequency);
+}
+
+RAMFUNC static void spi_transaction_done(spi_queue_entry_t *entry)
+{
+    spi_transaction_t *t = &entry->transaction;
+
+    if (!t->hold_down_cs)
+    {
+        nrf_gpio_pin_set(spi_cs_pin(t->device));
+    }
+
+    TRACE(TRACE_SPI_END, t->device);
+
+    spi_queue_tail = (spi_queue_tail + 1) % SPI_QUEUE_SIZE;
+    spi_completed++;
+
+    if (t->callback != NULL)
+    {
+        t->callback(t->context);
+    }
+}
+
+/**
+ * Start the next chunk of the transaction at the tail of the queue. Empty
+ * transactions only toggle their chip select, so they complete right here.
+ * Must run from the SPIM interrupt, or with it masked.
+ */
+RAMFUNC static void spi_queue_run(void)
+{
+    while (spi_queue_tail != spi_queue_head)
+    {
+        spi_queue_entry_t *entry = &spi_queue[spi_queue_tail];
+        spi_transaction_t *t = &entry->transaction;
+
+        if (entry->offset == 0)
+        {
+            TRACE(TRACE_SPI_START, t->device);
+            spi_configure(t->device);
+            nrf_gpio_pin_clear(spi_cs_pin(t->device));
+        }
+
+        if (entry->offset < t->length)
+        {
+            size_t length = MIN(t->length - entry->offset, SPIM_MAX_XFER_LENGTH);
+            nrfx_spim_xfer_desc_t xfer =
+                t->rx != NULL
+                    ? (nrfx_spim_xfer_desc_t)NRFX_SPIM_XFER_RX(t->rx + entry->offset, length)
+                    : (nrfx_spim_xfer_desc_t)NRFX_SPIM_XFER_TX(t->tx + entry->offset, length);
+
+            entry->offset += length;
+            app_err(nrfx_spim_xfer(&spi_bus_2, &xfer, 0));
+            return;
+        }
+
+        spi_transaction_done(entry);
+    }
+}
+
+RAMFUNC static void spi_event_handler(nrfx_spim_evt_t const *event, void *context)
+{
+    (void)context;
+
+    if (event->type != NRFX_SPIM_EVENT_DONE)
+    {
+        return;
+    }
+
+    spi_queue_entry_t *entry = &spi_queue[spi_queue_tail];
+
+    // Chain the remaining chunks of a long transfer from the interrupt
+    if (entry->offset == entry->transaction.length)
+    {
+        spi_transaction_done(entry);
+    }
+
+    spi_queue_run();
+}
+
 void monocle_spi_enable(bool enable)
 {
     if (enable == false)
     {
+        monocle_spi_wait();
         nrfx_spim_uninit(&spi_bus_2);
         return;
     }
@@ -229,119 +577,311 @@ void monocle_spi_enable(bool enable)
     config.mode = NRF_SPIM_MODE_3;
     config.bit_order = NRF_SPIM_BIT_ORDER_LSB_FIRST;
 
-    app_err(nrfx_spim_init(&spi_bus_2, &config, NULL, NULL));
+    app_err(nrfx_spim_init(&spi_bus_2, &config, spi_event_handler, NULL));
 }
 
-static uint8_t bit_reverse(uint8_t byte)
+void monocle_spi_check_buffer(const void *buffer, size_t length)
 {
-    byte = (byte & 0xF0) >> 4 | (byte & 0x0F) << 4;
-    byte = (byte & 0xCC) >> 2 | (byte & 0x33) << 2;
-    byte = (byte & 0xAA) >> 1 | (byte & 0x55) << 1;
-    return byte;
+    // EasyDMA can only reach RAM, which excludes strings frozen in flash
+    if (length > 0 && !nrfx_is_in_ram(buffer))
+    {
+        mp_raise_TypeError(MP_ERROR_TEXT("buffer must be a bytes object"));
+    }
 }
 
-void monocle_spi_read(spi_device_t spi_device, uint8_t *data, size_t length,
-                      bool hold_down_cs)
+RAMFUNC void monocle_spi_submit(spi_transaction_t const *transaction)
 {
-    uint8_t cs_pin;
-
-    switch (spi_device)
+    // Interrupts may queue transactions too, so the slot is claimed with
+    // them masked, waiting for the SPIM interrupt to make room otherwise
+    bool queued = false;
+    while (!queued)
     {
-    case DISPLAY:
-        cs_pin = DISPLAY_CS_PIN;
-        break;
-    case FPGA:
-        cs_pin = FPGA_CS_MODE_PIN;
-        break;
-    case FLASH:
-        cs_pin = FLASH_CS_PIN;
-        break;
+        NRFX_CRITICAL_SECTION_ENTER();
+
+        size_t next = (spi_queue_head + 1) % SPI_QUEUE_SIZE;
+        if (next != spi_queue_tail)
+        {
+            spi_queue_entry_t *entry = &spi_queue[spi_queue_head];
+            entry->transaction = *transaction;
+            entry->offset = 0;
+
+            if (transaction->rx == NULL && transaction->length <= SPI_INLINE_LENGTH)
+            {
+                memcpy(entry->inline_tx, transaction->tx, transaction->length);
+                entry->transaction.tx = entry->inline_tx;
+            }
+
+            spi_cs_held = transaction->hold_down_cs;
+            spi_submitted++;
+
+            // Only kick the bus if it was idle, otherwise the interrupt gets to it
+            bool idle = spi_queue_head == spi_queue_tail;
+            spi_queue_head = next;
+            if (idle)
+            {
+                spi_queue_run();
+            }
+            queued = true;
+        }
+
+        NRFX_CRITICAL_SECTION_EXIT();
     }
+}
+
+bool monocle_spi_can_submit(size_t count)
+{
+    size_t used = (spi_queue_head + SPI_QUEUE_SIZE - spi_queue_tail) % SPI_QUEUE_SIZE;
+    return !spi_cs_held && used + count < SPI_QUEUE_SIZE;
+}
+
+void monocle_spi_write_async(spi_device_t spi_device, const uint8_t *data,
+                             size_t length, bool hold_down_cs)
+{
+    spi_transaction_t transaction = {
+        .device = spi_device,
+        .hold_down_cs = hold_down_cs,
+        .tx = data,
+        .length = length,
+    };
+
+    monocle_spi_submit(&transaction);
+}
 
-    if (!nrfx_is_in_ram(data))
+void monocle_spi_wait(void)
+{
+    while (spi_queue_tail != spi_queue_head)
     {
-        nrf_gpio_pin_set(cs_pin);
-        mp_raise_TypeError(MP_ERROR_TEXT("buffer must be a bytes object"));
     }
+}
 
-    nrf_gpio_pin_clear(cs_pin);
+bool monocle_spi_idle(void)
+{
+    return spi_queue_tail == spi_queue_head;
+}
 
-    // TODO prevent blocking here, and add a mutex
-    nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_RX(data, length);
-    app_err(nrfx_spim_xfer(&spi_bus_2, &xfer, 0));
+uint32_t monocle_spi_last_submitted(void)
+{
+    return spi_submitted;
+}
 
-    if (!hold_down_cs)
+void monocle_spi_wait_for(uint32_t sequence)
+{
+    while ((int32_t)(spi_completed - sequence) < 0)
     {
-        nrf_gpio_pin_set(cs_pin);
     }
+}
+
+void monocle_spi_read(spi_device_t spi_device, uint8_t *data, size_t length,
+                      bool hold_down_cs)
+{
+    spi_transaction_t transaction = {
+        .device = spi_device,
+        .hold_down_cs = hold_down_cs,
+        .rx = data,
+        .length = length,
+    };
+
+    monocle_spi_submit(&transaction);
+    monocle_spi_wait();
+}
+
+void monocle_spi_write(spi_device_t spi_device, uint8_t *data, size_t length,
+                       bool hold_down_cs)
+{
+    monocle_spi_write_async(spi_device, data, length, hold_down_cs);
+    monocle_spi_wait();
+}
+
+// Set from the GPIOTE interrupt when the FPGA pulls its INT line low
+static volatile bool fpga_irq_flag = false;
+
+static void fpga_interrupt_handler(nrfx_gpiote_pin_t pin,
+                                   nrf_gpiote_polarity_t polarity)
+{
+    (void)pin;
+    (void)polarity;
+
+    fpga_irq_flag = true;
+}
+
+void monocle_fpga_irq_init(void)
+{
+    // The pin is also driven as the FPGA reset, so only watch it
+    nrfx_gpiote_in_config_t config = NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(false);
+    config.is_watcher = true;
+
+    app_err(nrfx_gpiote_in_init(FPGA_RESET_INT_PIN,
+                                &config,
+                                fpga_interrupt_handler));
+
+    nrfx_gpiote_in_event_enable(FPGA_RESET_INT_PIN, true);
+}
+
+void monocle_fpga_irq_clear(void)
+{
+    fpga_irq_flag = false;
+}
+
+bool monocle_fpga_irq_pending(void)
+{
+    return fpga_irq_flag;
+}
+
+bool monocle_fpga_irq_wait(uint32_t timeout_ms)
+{
+    uint32_t start_time = mp_hal_ticks_ms();
 
-    // Flash is LSB first, so we need to flip all the bytes before returning
-    if (spi_device == FLASH)
+    while (!fpga_irq_flag)
     {
-        for (size_t i = 0; i < length; i++)
+        if (mp_hal_ticks_ms() - start_time >= timeout_ms)
         {
-            data[i] = bit_reverse(data[i]);
+            return false;
         }
     }
+
+    return true;
 }
 
-void monocle_spi_write(spi_device_t spi_device, uint8_t *data, size_t length,
-                       bool hold_down_cs)
-{
-    uint8_t cs_pin;
+// Set whenever a program or erase is started, and cleared once the status
+// register says it's done, so that accesses to an idle chip skip the status
+// round trip. It starts set as a reset may happen in the middle of an erase
+static bool flash_busy = true;
 
-    switch (spi_device)
+static bool flash_is_busy(void)
+{
+    if (flash_busy == false)
     {
-    case DISPLAY:
-        cs_pin = DISPLAY_CS_PIN;
-        break;
-    case FPGA:
-        cs_pin = FPGA_CS_MODE_PIN;
-        break;
-    case FLASH:
-        cs_pin = FLASH_CS_PIN;
-        break;
+        return false;
     }
 
-    if (!nrfx_is_in_ram(data))
+    uint8_t status_cmd[] = {0x05};
+    monocle_spi_write(FLASH, status_cmd, sizeof(status_cmd), true);
+    monocle_spi_read(FLASH, status_cmd, sizeof(status_cmd), false);
+
+    flash_busy = status_cmd[0] & 0x01;
+    return flash_busy;
+}
+
+static flash_stats_t flash_stats[2];
+
+flash_stats_t *monocle_flash_stats(flash_region_t region)
+{
+    return &flash_stats[region];
+}
+
+static flash_stats_t *flash_stats_at(size_t address)
+{
+    return &flash_stats[address < 0x6D000 ? FLASH_REGION_FPGA_APP
+                                          : FLASH_REGION_STORAGE];
+}
+
+// Page programs finish in well under a millisecond, so poll quickly at
+// first, and only hand over to the event loop during long sector erases.
+// The wait is counted against whatever access had to wait for it
+static void flash_wait_ready(flash_stats_t *stats)
+{
+    if (flash_busy == false)
     {
-        nrf_gpio_pin_set(cs_pin);
-        mp_raise_TypeError(MP_ERROR_TEXT("buffer must be a bytes object"));
+        return;
     }
 
-    nrf_gpio_pin_clear(cs_pin);
+    monocle_cycles_enable();
+    uint32_t start = monocle_cycles_now();
 
-    // Flash is LSB first, so we need to flip all the bytes before sending
-    if (spi_device == FLASH)
+    for (size_t i = 0; flash_is_busy(); i++)
     {
-        for (size_t i = 0; i < length; i++)
+        if (i < 20)
         {
-            data[i] = bit_reverse(data[i]);
+            nrfx_systick_delay_us(50);
+        }
+        else
+        {
+            mp_hal_delay_ms(1);
         }
     }
 
-    // TODO prevent blocking here, and add a mutex
-    nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_TX(data, length);
-    app_err(nrfx_spim_xfer(&spi_bus_2, &xfer, 0));
+    stats->busy_us += (monocle_cycles_now() - start) / 64;
+}
+
+// Sectors known to read back as all 0xFF, so erasing them can be skipped.
+// The idle scanner fills this in, and any program or erase keeps it current
+static uint8_t flash_erased[0x100000 / 0x1000 / 8];
+static size_t flash_scan_address = 0;
 
-    if (!hold_down_cs)
+// The scan reads 256 bytes per step, so it takes one step every few ms at
+// most rather than one on every pass through the poll hook
+#define FLASH_SCAN_INTERVAL_MS 4
+static uint32_t flash_scan_last_ms = 0;
+
+static bool flash_sector_is_erased(size_t address)
+{
+    size_t sector = address / 0x1000;
+    return flash_erased[sector / 8] & (1 << (sector % 8));
+}
+
+static void flash_sector_mark(size_t address, bool erased)
+{
+    size_t sector = address / 0x1000;
+
+    if (erased)
+    {
+        flash_erased[sector / 8] |= 1 << (sector % 8);
+    }
+    else
+    {
+        flash_erased[sector / 8] &= ~(1 << (sector % 8));
+    }
+
+    // Restart the scan of this sector, as the part already read is stale
+    if (flash_scan_address / 0x1000 == sector)
     {
-        nrf_gpio_pin_set(cs_pin);
+        flash_scan_address = sector * 0x1000;
     }
 }
 
-static bool flash_is_busy(void)
+void monocle_flash_scan_step(void)
 {
-    uint8_t status_cmd[] = {0x05};
-    monocle_spi_write(FLASH, status_cmd, sizeof(status_cmd), true);
-    monocle_spi_read(FLASH, status_cmd, sizeof(status_cmd), false);
+    if (flash_scan_address >= 0x100000 ||
+        spi_queue_tail != spi_queue_head ||
+        flash_is_busy())
+    {
+        return;
+    }
 
-    if ((status_cmd[0] & 0x01) == 0)
+    uint32_t now = mp_hal_ticks_ms();
+
+    if (now - flash_scan_last_ms < FLASH_SCAN_INTERVAL_MS)
     {
-        return false;
+        return;
     }
 
-    return true;
+    flash_scan_last_ms = now;
+
+    // Read directly, so that scanning doesn't show up in the counters
+    uint8_t chunk[256];
+    uint8_t read_cmd[] = {0x03,
+                          flash_scan_address >> 16,
+                          flash_scan_address >> 8,
+                          flash_scan_address};
+    monocle_spi_write(FLASH, read_cmd, sizeof(read_cmd), true);
+    monocle_spi_read(FLASH, chunk, sizeof(chunk), false);
+
+    for (size_t i = 0; i < sizeof(chunk); i++)
+    {
+        if (chunk[i] != 0xFF)
+        {
+            flash_scan_address = (flash_scan_address / 0x1000 + 1) * 0x1000;
+            return;
+        }
+    }
+
+    flash_scan_address += sizeof(chunk);
+
+    if (flash_scan_address % 0x1000 == 0)
+    {
+        size_t sector = flash_scan_address / 0x1000 - 1;
+        flash_erased[sector / 8] |= 1 << (sector % 8);
+    }
 }
 
 void monocle_flash_read(uint8_t *buffer, size_t address, size_t length)
@@ -352,10 +892,9 @@ void monocle_flash_read(uint8_t *buffer, size_t address, size_t length)
             MP_ERROR_TEXT("address + length cannot exceed 1048576 bytes"));
     }
 
-    while (flash_is_busy())
-    {
-        mp_hal_delay_ms(1);
-    }
+    flash_stats_t *stats = flash_stats_at(address);
+    flash_wait_ready(stats);
+    stats->bytes_read += length;
 
     uint8_t read_cmd[] = {0x03,
                           address >> 16,
@@ -363,19 +902,8 @@ void monocle_flash_read(uint8_t *buffer, size_t address, size_t length)
                           address};
     monocle_spi_write(FLASH, read_cmd, sizeof(read_cmd), true);
 
-    size_t bytes_read = 0;
-    while (bytes_read < length)
-    {
-        // nRF DMA can only handle 255 bytes at a time
-        size_t max_readable_length = MIN(length - bytes_read, 255);
-
-        // If we're going to need another transfer, keep cs held
-        bool hold = length - bytes_read > 255;
-
-        monocle_spi_read(FLASH, buffer + bytes_read, max_readable_length, hold);
-
-        bytes_read += max_readable_length;
-    }
+    // The SPI queue splits this into DMA sized chunks
+    monocle_spi_read(FLASH, buffer, length, false);
 }
 
 void monocle_flash_write(uint8_t *buffer, size_t address, size_t length)
@@ -386,6 +914,8 @@ void monocle_flash_write(uint8_t *buffer, size_t address, size_t length)
             MP_ERROR_TEXT("address + length cannot exceed 1048576 bytes"));
     }
 
+    monocle_spi_check_buffer(buffer, length);
+
     size_t bytes_written = 0;
     while (bytes_written < length)
     {
@@ -397,13 +927,10 @@ void monocle_flash_write(uint8_t *buffer, size_t address, size_t length)
         size_t max_writable_length = MIN(bytes_left_in_page,
                                          bytes_left_to_write);
 
-        // nRF DMA can only handle 255 bytes at a time
-        max_writable_length = MIN(max_writable_length, 255);
-
-        while (flash_is_busy())
-        {
-            mp_hal_delay_ms(1);
-        }
+        flash_stats_t *stats = flash_stats_at(address_offset);
+        flash_wait_ready(stats);
+        flash_sector_mark(address_offset, false);
+        stats->bytes_programmed += max_writable_length;
 
         uint8_t write_enable_cmd[] = {0x06};
         monocle_spi_write(FLASH, write_enable_cmd, sizeof(write_enable_cmd), false);
@@ -414,6 +941,7 @@ void monocle_flash_write(uint8_t *buffer, size_t address, size_t length)
                                       address_offset};
         monocle_spi_write(FLASH, page_program_cmd, sizeof(page_program_cmd), true);
         monocle_spi_write(FLASH, buffer + bytes_written, max_writable_length, false);
+        flash_busy = true;
 
         bytes_written += max_writable_length;
     }
@@ -427,11 +955,17 @@ void monocle_flash_page_erase(size_t address)
             "address must be aligned to a page size of 4096 bytes"));
     }
 
-    while (flash_is_busy())
+    flash_stats_t *stats = flash_stats_at(address);
+
+    if (flash_sector_is_erased(address))
     {
-        mp_hal_delay_ms(1);
+        stats->erases_skipped++;
+        return;
     }
 
+    flash_wait_ready(stats);
+    stats->sectors_erased++;
+
     uint8_t write_enable_cmd[] = {0x06};
     monocle_spi_write(FLASH, write_enable_cmd, sizeof(write_enable_cmd), false);
 
@@ -440,4 +974,17 @@ void monocle_flash_page_erase(size_t address)
                               address >> 8,
                               address};
     monocle_spi_write(FLASH, sector_erase, sizeof(sector_erase), false);
+    flash_busy = true;
+
+    // The erase carries on in the background, and the next access waits
+    flash_sector_mark(address, true);
+}
+
+void monocle_flash_jedec_id(uint8_t id[3])
+{
+    flash_wait_ready(flash_stats_at(0));
+
+    uint8_t jedec_id_cmd[] = {0x9F};
+    monocle_spi_write(FLASH, jedec_id_cmd, sizeof(jedec_id_cmd), true);
+    monocle_spi_read(FLASH, id, 3, false);
 }
@@ -28,6 +28,9 @@ extern uint32_t _stack_top;
 extern uint32_t _sidata;
 extern uint32_t _sdata;
 extern uint32_t _edata;
+extern uint32_t _siramfunc;
+extern uint32_t _sramfunc;
+extern uint32_t _eramfunc;
 extern uint32_t _sbss;
 extern uint32_t _ebss;
 
@@ -51,6 +54,15 @@ void Reset_Handler(void)
         *p_dest++ = *p_src++;
     }
 
+    // Copy the hot functions to RAM
+    p_src = &_siramfunc;
+    p_dest = &_sramfunc;
+
+    while (p_dest < &_eramfunc)
+    {
+        *p_dest++ = *p_src++;
+    }
+
     uint32_t *p_bss = &_sbss;
     uint32_t *p_bss_end = &_ebss;
     while (p_bss < p_bss_end)
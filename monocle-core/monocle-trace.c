@@ -0,0 +1,70 @@
+/*
+ * This file is part of the MicroPython for Monocle project:
+ *      https://github.com/brilliantlabsAR/monocle-micropython
+ *
+ * Authored by: Josuah Demangeon (me@josuah.net)
+ *              Raj Nakarja / Brilliant Labs Ltd. (raj@itsbrilliant.co)
+ *
+ * ISC Licence
+ *
+ * Copyright © 2023 Brilliant Labs Ltd.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR
+ * OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "monocle.h"
+
+#if MONOCLE_TRACE
+
+#include "SEGGER_RTT.h"
+
+#define TRACE_CHANNEL (1)
+#define TRACE_BUFFER_SIZE (4096)
+
+// Records are packed so that more of them fit in the RTT buffer
+typedef struct __attribute__((packed)) trace_record_t
+{
+    uint8_t event;
+    uint8_t arg;
+    uint32_t cycles;
+} trace_record_t;
+
+static uint8_t trace_buffer[TRACE_BUFFER_SIZE];
+
+void monocle_trace_init(void)
+{
+    monocle_cycles_enable();
+
+    // Drop new records rather than stall when the host isn't keeping up
+    SEGGER_RTT_ConfigUpBuffer(TRACE_CHANNEL, "trace",
+                              trace_buffer, sizeof(trace_buffer),
+                              SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
+
+void monocle_trace(trace_event_t event, uint8_t arg)
+{
+    trace_record_t record = {
+        .event = event,
+        .arg = arg,
+        .cycles = monocle_cycles_now(),
+    };
+
+    SEGGER_RTT_Write(TRACE_CHANNEL, &record, sizeof(record));
+}
+
+void monocle_trace_scheduled(void)
+{
+    monocle_trace(TRACE_SCHEDULED, 0);
+}
+
+#endif
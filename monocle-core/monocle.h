@@ -28,6 +28,7 @@
 #include <stdbool.h>
 #include "nrfx.h"
 #include "nrfx_log.h"
+#include "nrfx_twim.h"
 
 /**
  * @brief Monocle PCB pinout.
@@ -70,11 +71,45 @@ void monocle_set_led(led_t led, bool enable);
 void monocle_critical_startup(void);
 
 /**
- * @brief Bootloader entry function.
+ * @brief Boot timeline, in microseconds since monocle_critical_startup().
+ *        The CPU cycle counter is used until the RTC runs after the
+ *        SoftDevice has started the low frequency clock.
+ */
+
+#define BOOT_TIMELINE_LENGTH (16)
+
+typedef struct boot_mark_t
+{
+    const char *step;
+    uint32_t us;
+} boot_mark_t;
+
+void monocle_boot_mark(const char *step);
+
+void monocle_boot_rtc_started(void);
+
+size_t monocle_boot_timeline(const boot_mark_t **marks);
+
+/**
+ * @brief PMIC interrupt, for charger and temperature events. Set up once
+ *        GPIOTE is running. monocle_pmic_check() reads the charge state again
+ *        from the same bottom half, such as after changing the sleep flags.
+ */
+
+void monocle_pmic_irq_init(void);
+
+void monocle_pmic_check(void);
+
+/**
+ * @brief Bootloader entry functions. The staged update one lets the
+ *        bootloader copy a verified image from external flash, see
+ *        bootloader/staged_update.h.
  */
 
 void monocle_enter_bootloader(void);
 
+void monocle_enter_staged_update(void);
+
 /**
  * @brief Resets the FPGA, and either holds it in reset, or reboots.
  */
@@ -122,6 +157,27 @@ i2c_response_t monocle_i2c_write(uint8_t device_address_7bit,
                                  uint8_t register_mask,
                                  uint8_t set_value);
 
+/**
+ * @brief Register tables. On the camera bus, runs of consecutive registers
+ *        go out as bursts, chained from the TWIM interrupt, and the write
+ *        returns straight away. Other camera accesses wait for it, and
+ *        monocle_i2c_wait() returns true if any register failed.
+ */
+
+typedef struct i2c_register_t
+{
+    uint16_t address;
+    uint8_t value;
+} i2c_register_t;
+
+void monocle_i2c_write_table(uint8_t device_address_7bit,
+                             i2c_register_t const *table,
+                             size_t length);
+
+bool monocle_i2c_wait(void);
+
+void monocle_i2c_event_handler(nrfx_twim_evt_t const *event, void *context);
+
 /**
  * @brief Low level SPI driver for accessing FPGA, display and flash.
  */
@@ -141,6 +197,62 @@ void monocle_spi_read(spi_device_t spi_device, uint8_t *data, size_t length,
 void monocle_spi_write(spi_device_t spi_device, uint8_t *data, size_t length,
                        bool hold_down_cs);
 
+/**
+ * @brief Queued SPI transactions. Each one selects its device, transfers
+ *        either tx or rx, then releases the chip select unless it is held
+ *        for the next transaction. The callback runs from the SPIM
+ *        interrupt once done. Writes of up to 8 bytes are copied, larger
+ *        buffers must stay valid until then.
+ */
+
+typedef struct spi_transaction_t
+{
+    spi_device_t device;
+    bool hold_down_cs;
+    const uint8_t *tx;
+    uint8_t *rx;
+    size_t length;
+    void (*callback)(void *context);
+    void *context;
+} spi_transaction_t;
+
+void monocle_spi_submit(spi_transaction_t const *transaction);
+
+// Raises TypeError for buffers DMA can't reach. For Python facing callers,
+// as monocle_spi_submit() may run from interrupts and doesn't check
+void monocle_spi_check_buffer(const void *buffer, size_t length);
+
+void monocle_spi_write_async(spi_device_t spi_device, const uint8_t *data,
+                             size_t length, bool hold_down_cs);
+
+void monocle_spi_wait(void);
+
+bool monocle_spi_idle(void);
+
+// Transactions are numbered as they are queued. Waiting for one returns once
+// it is complete, while later ones may still be queued
+uint32_t monocle_spi_last_submitted(void);
+
+void monocle_spi_wait_for(uint32_t sequence);
+
+// For interrupts, which can't wait on the queue or split an exchange that
+// holds a chip select down. Only valid with other submitters masked.
+bool monocle_spi_can_submit(size_t count);
+
+/**
+ * @brief Completion interrupt raised by the FPGA on FPGA_RESET_INT_PIN.
+ *        Clear it before sending a command, then wait with a worst case
+ *        timeout. The wait returns false if the interrupt never came.
+ */
+
+void monocle_fpga_irq_init(void);
+
+void monocle_fpga_irq_clear(void);
+
+bool monocle_fpga_irq_pending(void);
+
+bool monocle_fpga_irq_wait(uint32_t timeout_ms);
+
 /**
  * @brief High level SPI driver for accessing flash.
  */
@@ -151,6 +263,91 @@ void monocle_flash_write(uint8_t *buffer, size_t address, size_t length);
 
 void monocle_flash_page_erase(size_t address);
 
+void monocle_flash_scan_step(void);
+
+void monocle_flash_jedec_id(uint8_t id[3]);
+
+// Counters are kept separately for the FPGA app, and what's after it
+typedef enum flash_region_t
+{
+    FLASH_REGION_FPGA_APP,
+    FLASH_REGION_STORAGE,
+} flash_region_t;
+
+typedef struct flash_stats_t
+{
+    uint32_t bytes_read;
+    uint32_t bytes_programmed;
+    uint32_t sectors_erased;
+    uint32_t erases_skipped;
+    uint32_t busy_us;
+} flash_stats_t;
+
+flash_stats_t *monocle_flash_stats(flash_region_t region);
+
+/**
+ * @brief CPU cycle counter, for timing in 64MHz cycles.
+ */
+
+static inline void monocle_cycles_enable(void)
+{
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+static inline uint32_t monocle_cycles_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Binary event trace on RTT channel 1, stamped with the cycle
+ *        counter. tools/trace.py turns a capture into a timeline. Build
+ *        with TRACE=1, otherwise trace points compile to nothing.
+ */
+
+typedef enum trace_event_t
+{
+    TRACE_BLE_HVX_QUEUED,   // arg: the ble_tx_channel_t
+    TRACE_BLE_HVX_COMPLETE, // arg: notifications completed
+    TRACE_SPI_START,        // arg: the spi_device_t
+    TRACE_SPI_END,          // arg: the spi_device_t
+    TRACE_SHOW_START,
+    TRACE_SHOW_END,
+    TRACE_ROW_RENDER_START,
+    TRACE_ROW_RENDER_END,
+    TRACE_ROW_FLUSH_START,
+    TRACE_ROW_FLUSH_END,
+    TRACE_GC_START,
+    TRACE_GC_END,
+    TRACE_SCHEDULED,
+} trace_event_t;
+
+#if MONOCLE_TRACE
+void monocle_trace_init(void);
+void monocle_trace(trace_event_t event, uint8_t arg);
+#define TRACE(event, arg) monocle_trace(event, arg)
+#else
+#define monocle_trace_init()
+#define TRACE(event, arg)
+#endif
+
+/**
+ * @brief Marks a hot function to be built for speed and run from RAM, where
+ *        tight loops avoid the flash wait states. Reset_Handler copies the
+ *        .ramfunc section along with .data. Build with RAMFUNC=0 to compare.
+ */
+
+#if MONOCLE_RAMFUNC
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline, optimize("O2")))
+#else
+#define RAMFUNC
+#endif
+
 /**
  * @brief Error handling macro.
  */
@@ -41,6 +41,18 @@
 
 #define MICROPY_PERSISTENT_CODE_LOAD (1)
 
+// Lets modules/mpycache.c compile sources to .mpy files on the device
+#define MICROPY_PERSISTENT_CODE_SAVE (1)
+
+// Native and viper code is emitted onto the heap, which monocle.ld places in
+// executable RAM above the SoftDevice. Build with NATIVE=0 to drop the emitters
+#ifndef MICROPY_EMIT_THUMB
+#define MICROPY_EMIT_THUMB (1)
+#endif
+#ifndef MICROPY_EMIT_INLINE_THUMB
+#define MICROPY_EMIT_INLINE_THUMB (1)
+#endif
+
 #define MICROPY_ENABLE_SCHEDULER (1)
 
 #define MICROPY_COMP_MODULE_CONST (1)
@@ -125,5 +137,21 @@
 
 #define MP_STATE_PORT MP_STATE_VM
 
+// Sizes of the BLE REPL rings. They can be overridden from the Makefile
+#ifndef BLE_REPL_RX_BUFFER_SIZE
+#define BLE_REPL_RX_BUFFER_SIZE (1024)
+#endif
+#ifndef BLE_REPL_TX_BUFFER_SIZE
+#define BLE_REPL_TX_BUFFER_SIZE (1024)
+#endif
+
+// Raw-paste mode offers the host half of this as its flow control window
+#define MICROPY_REPL_STDIN_BUFFER_MAX (BLE_REPL_RX_BUFFER_SIZE / 2)
+
 void mp_event_poll_hook(void);
 #define MICROPY_EVENT_POLL_HOOK mp_event_poll_hook();
+
+#if MONOCLE_TRACE
+void monocle_trace_scheduled(void);
+#define MICROPY_SCHED_HOOK_SCHEDULED monocle_trace_scheduled()
+#endif
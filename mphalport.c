@@ -27,6 +27,8 @@
 #include "py/lexer.h"
 #include "py/runtime.h"
 #include "mpconfigport.h"
+#include "monocle.h"
+#include "nrf_soc.h"
 #include "nrfx_rtc.h"
 
 const char help_text[] = {
@@ -44,33 +46,182 @@ const char help_text[] = {
 
 static nrfx_rtc_t rtc = NRFX_RTC_INSTANCE(1);
 
+extern uint64_t time_at_boot_s;
+
+// The RTC counter is only 24 bits, which only lasts 4.5 hours at 1024Hz
+static volatile uint32_t rtc_overflows = 0;
+
+uint64_t mp_hal_wakeup_ticks = 0;
+
+// About 3ms, the shortest the compare can catch without returning at once
+#define MP_HAL_POLL_INTERVAL_TICKS 3
+
+// TIMER3 counts microseconds, and is started when first used as it keeps the
+// high frequency clock running. PPI captures it on every RTC tick
+#define HIRES_PPI_CHANNEL (0)
+static bool hires_timer_running = false;
+
+void mp_hal_rtc_event_handler(nrfx_rtc_int_type_t int_type)
+{
+    // Other compare events only need to wake the CPU, which has happened by now
+    if (int_type == NRFX_RTC_INT_OVERFLOW)
+    {
+        rtc_overflows++;
+    }
+
+    if (int_type == NRFX_RTC_INT_COMPARE1)
+    {
+        mp_hal_alarm_handler();
+    }
+}
+
+static uint64_t rtc_ticks(void)
+{
+    uint32_t overflows;
+    uint32_t counter;
+
+    do
+    {
+        overflows = rtc_overflows;
+        counter = nrfx_rtc_counter_get(&rtc);
+
+        // The overflow may not have been handled yet if called from an IRQ
+        if (nrf_rtc_event_check(rtc.p_reg, NRF_RTC_EVENT_OVERFLOW) &&
+            counter < (RTC_COUNTER_COUNTER_Msk >> 1))
+        {
+            overflows++;
+        }
+    } while (overflows != rtc_overflows);
+
+    return ((uint64_t)overflows << 24) | counter;
+}
+
+static void hires_timer_start(void)
+{
+    if (hires_timer_running)
+    {
+        return;
+    }
+
+    NRF_TIMER3->MODE = TIMER_MODE_MODE_Timer;
+    NRF_TIMER3->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER3->PRESCALER = 4; // 16MHz / 2^4 = 1MHz
+    NRF_TIMER3->TASKS_START = 1;
+
+    app_err(sd_ppi_channel_assign(HIRES_PPI_CHANNEL,
+                                  &NRF_RTC1->EVENTS_TICK,
+                                  &NRF_TIMER3->TASKS_CAPTURE[0]));
+    app_err(sd_ppi_channel_enable_set(1 << HIRES_PPI_CHANNEL));
+
+    hires_timer_running = true;
+}
+
+static uint32_t hires_timer_now(void)
+{
+    NRF_TIMER3->TASKS_CAPTURE[1] = 1;
+    return NRF_TIMER3->CC[1];
+}
+
 uint64_t mp_hal_time_ns(void)
 {
-    return 0;
+    uint64_t ticks;
+    uint32_t since_tick_us;
+
+    hires_timer_start();
+
+    // The RTC keeps the long term accuracy, the timer fills in between ticks
+    do
+    {
+        ticks = rtc_ticks();
+        since_tick_us = hires_timer_now() - NRF_TIMER3->CC[0];
+    } while (rtc_ticks() != ticks);
+
+    // Stay below one tick of 976.5625us so that time never goes backwards
+    if (since_tick_us > 976)
+    {
+        since_tick_us = 976;
+    }
+
+    return time_at_boot_s * 1000000000ULL +
+           ticks * 1953125 / 2 +
+           since_tick_us * 1000ULL;
 }
 
 mp_uint_t mp_hal_ticks_ms(void)
 {
-    uint32_t value = nrfx_rtc_counter_get(&rtc);
-
     // Correct for the slightly faster tick frequency of 1024Hz
-    float ms = (float)value / 1024 * 1000;
+    return (mp_uint_t)((rtc_ticks() * 125) >> 7);
+}
 
-    return (mp_uint_t)ms;
+mp_uint_t mp_hal_ticks_us(void)
+{
+    hires_timer_start();
+    return hires_timer_now();
 }
 
 mp_uint_t mp_hal_ticks_cpu(void)
 {
-    // This doesn't seem to be used by anything so it's not implemented
-    return 0;
+    // This stops while the CPU sleeps in sd_app_evt_wait()
+    monocle_cycles_enable();
+    return monocle_cycles_now();
+}
+
+void mp_hal_wait_for_event(uint64_t wakeup_ticks)
+{
+    if (wakeup_ticks == MP_HAL_WAKEUP_ON_EVENT)
+    {
+        app_err(sd_app_evt_wait());
+        return;
+    }
+
+    // Loops without a deadline, such as uselect's timeout, still check back
+    if (wakeup_ticks == 0)
+    {
+        wakeup_ticks = rtc_ticks() + MP_HAL_POLL_INTERVAL_TICKS;
+    }
+
+    // The RTC needs the compare value at least two ticks ahead to catch it
+    if (rtc_ticks() + 2 >= wakeup_ticks)
+    {
+        return;
+    }
+
+    nrfx_rtc_cc_set(&rtc, 0, (uint32_t)wakeup_ticks & RTC_COUNTER_COUNTER_Msk, true);
+
+    if (rtc_ticks() + 1 < wakeup_ticks)
+    {
+        app_err(sd_app_evt_wait());
+    }
+}
+
+void mp_hal_alarm_set(uint32_t delay_ms)
+{
+    // Rounded up, and at least two ticks ahead for the compare to catch it
+    uint64_t ticks = ((uint64_t)delay_ms * 128 + 124) / 125;
+
+    if (ticks < 2)
+    {
+        ticks = 2;
+    }
+
+    uint32_t compare = (uint32_t)(rtc_ticks() + ticks) & RTC_COUNTER_COUNTER_Msk;
+
+    nrfx_rtc_cc_set(&rtc, 1, compare, true);
+}
+
+void mp_hal_poll_hook_ms(mp_uint_t ms)
+{
+    mp_hal_wakeup_ticks = rtc_ticks() + ((uint64_t)ms * 128 + 124) / 125;
+    MICROPY_EVENT_POLL_HOOK;
 }
 
 void mp_hal_delay_ms(mp_uint_t ms)
 {
-    uint32_t start_time = mp_hal_ticks_ms();
+    uint64_t deadline = rtc_ticks() + ((uint64_t)ms * 128 + 124) / 125;
 
-    while (mp_hal_ticks_ms() - start_time < ms)
+    while (rtc_ticks() < deadline)
     {
+        mp_hal_wakeup_ticks = deadline;
         MICROPY_EVENT_POLL_HOOK;
     }
 }
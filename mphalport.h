@@ -37,6 +37,31 @@ typedef long mp_off_t;
 
 mp_uint_t mp_hal_ticks_ms(void);
 
+mp_uint_t mp_hal_ticks_us(void);
+
+mp_uint_t mp_hal_ticks_cpu(void);
+
+void mp_hal_rtc_event_handler(nrfx_rtc_int_type_t int_type);
+
+// One shot alarm on the second RTC compare channel, calling
+// mp_hal_alarm_handler() from the RTC interrupt. Setting it again replaces it
+void mp_hal_alarm_set(uint32_t delay_ms);
+
+void mp_hal_alarm_handler(void);
+
+// A deadline in RTC ticks, for the next MICROPY_EVENT_POLL_HOOK only. Without
+// one, the hook wakes again within a few ms
+extern uint64_t mp_hal_wakeup_ticks;
+
+// Sleeps until an interrupt instead, for loops only an interrupt can end
+#define MP_HAL_WAKEUP_ON_EVENT UINT64_MAX
+
+void mp_hal_wait_for_event(uint64_t wakeup_ticks);
+
+// Loops polling anything else, or waiting with a timeout, use this to wake up
+// again within ms
+void mp_hal_poll_hook_ms(mp_uint_t ms);
+
 void mp_hal_set_interrupt_char(int c);
 
 int mp_hal_generate_random_seed(void);
@@ -47,10 +72,76 @@ typedef enum ble_tx_channel_t
 {
     REPL_TX,
     DATA_TX,
+    FILE_TX,
 } ble_tx_channel_t;
 
+bool ble_is_connected(void);
+
 bool ble_are_tx_notifications_enabled(ble_tx_channel_t channel);
 
 size_t ble_get_max_payload_size(void);
 
-bool ble_send_raw_data(const uint8_t *bytes, size_t len);
\ No newline at end of file
+bool ble_send_raw_data(const uint8_t *bytes, size_t len);
+
+bool ble_send_file_data(const uint8_t *bytes, size_t len);
+
+#if MONOCLE_L2CAP
+
+void ble_l2cap_listen(uint16_t psm);
+
+void ble_l2cap_close(void);
+
+bool ble_l2cap_is_connected(void);
+
+bool ble_l2cap_send(const uint8_t *bytes, size_t len);
+
+size_t ble_l2cap_available(void);
+
+size_t ble_l2cap_read(uint8_t *buffer, size_t len);
+
+#else
+
+// Without the channel, senders always fall back to notifications
+static inline bool ble_l2cap_is_connected(void)
+{
+    return false;
+}
+
+static inline bool ble_l2cap_send(const uint8_t *bytes, size_t len)
+{
+    return true;
+}
+
+#endif
+
+bool ble_request_connection_params(uint32_t min_interval_us,
+                                   uint32_t max_interval_us,
+                                   uint16_t slave_latency,
+                                   uint16_t supervision_timeout_ms);
+
+typedef struct ble_stats_t
+{
+    uint32_t repl_notifications_queued;
+    uint32_t repl_notifications_rejected;
+    uint32_t data_notifications_queued;
+    uint32_t data_notifications_rejected;
+    uint32_t repl_bytes_sent;
+    uint32_t repl_bytes_received;
+    uint32_t data_bytes_sent;
+    uint32_t data_bytes_received;
+    uint32_t repl_rx_dropped;
+    uint16_t repl_tx_high_water;
+    uint16_t repl_rx_high_water;
+    uint8_t tx_phy;
+    uint8_t rx_phy;
+    uint16_t connection_interval;
+    uint16_t slave_latency;
+    uint16_t supervision_timeout;
+    uint16_t max_tx_octets;
+    uint16_t max_rx_octets;
+    uint32_t connection_param_updates;
+} ble_stats_t;
+
+const ble_stats_t *ble_get_stats(void);
+
+void ble_reset_stats(void);
\ No newline at end of file
@@ -33,7 +33,7 @@
 #define NRFX_LOG_UART_DISABLED 1
 
 #define NRFX_GPIOTE_ENABLED 1
-#define NRFX_GPIOTE_CONFIG_NUM_OF_LOW_POWER_EVENTS 1
+#define NRFX_GPIOTE_CONFIG_NUM_OF_LOW_POWER_EVENTS 3 // Touch, FPGA and PMIC
 #define NRFX_GPIOTE_DEFAULT_CONFIG_IRQ_PRIORITY 7
 
 #define NRFX_TWIM0_ENABLED 1
@@ -54,7 +54,9 @@
 
 #define NRFX_TIMER_ENABLED 1
 #define NRFX_TIMER0_ENABLED 1 // Used by the SoftDevice
-#define NRFX_TIMER4_ENABLED 1 // Used for checking battery state
+#define NRFX_TIMER4_ENABLED 1 // Triggers battery sampling, polls the charger if PMIC_POLL=1
+// TIMER1 is driven directly by modules/microphone.c for its burst reads
+// TIMER3 is driven directly by mphalport.c for ticks_us() and time_ns()
 #define NRFX_TIMER_DEFAULT_CONFIG_IRQ_PRIORITY 7
 
 #define NRFX_SAADC_ENABLED 1
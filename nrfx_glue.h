@@ -106,7 +106,7 @@
 
 #define NRFX_DPPI_GROUPS_USED 0
 
-#define NRFX_PPI_CHANNELS_USED 0
+#define NRFX_PPI_CHANNELS_USED (1 << 0) // Used by mphalport.c for time_ns()
 
 #define NRFX_PPI_GROUPS_USED 0
 
@@ -0,0 +1,201 @@
+"""
+Bluetooth throughput and latency benchmarks for Monocle.
+
+Connects to the first Monocle found, runs every benchmark, and prints one
+JSON object, or writes it to the given file to keep a record per build:
+
+    python3 tools/benchmark.py
+    python3 tools/benchmark.py results.json
+
+Host side timings cover the REPL echo, raw REPL uploads, and the data
+service in both directions. The frozen benchmark module on the device
+times display.show() and the flash, and reports the negotiated link,
+which goes alongside the numbers with the firmware version.
+
+Needs bleak, as for tools/serial_console.py.
+"""
+
+import asyncio
+import json
+import statistics
+import sys
+import time
+
+REPL_RX_CHAR_UUID = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"
+REPL_TX_CHAR_UUID = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"
+DATA_RX_CHAR_UUID = "E5700002-7BAC-429A-B4CE-57FF900F479D"
+DATA_TX_CHAR_UUID = "E5700003-7BAC-429A-B4CE-57FF900F479D"
+
+ECHO_ROUNDS = 20
+UPLOAD_BYTES = 8192
+DATA_BYTES = 32768
+
+
+def sliced(data, n):
+    return [data[i : i + n] for i in range(0, len(data), n)]
+
+
+class Monocle:
+    def __init__(self, client):
+        self.client = client
+        self.repl = bytearray()
+        self.repl_event = asyncio.Event()
+        self.data_bytes = 0
+        self.data_first = None
+        self.data_last = None
+
+    async def start(self):
+        await self.client.start_notify(REPL_TX_CHAR_UUID, self.handle_repl)
+        await self.client.start_notify(DATA_TX_CHAR_UUID, self.handle_data)
+        self.repl_rx = self.client.services.get_characteristic(REPL_RX_CHAR_UUID)
+        self.data_rx = self.client.services.get_characteristic(DATA_RX_CHAR_UUID)
+
+    def handle_repl(self, _, data):
+        self.repl.extend(data)
+        self.repl_event.set()
+
+    def handle_data(self, _, data):
+        now = time.perf_counter()
+        if self.data_first is None:
+            self.data_first = now
+        self.data_last = now
+        self.data_bytes += len(data)
+
+    async def write(self, characteristic, data):
+        for chunk in sliced(data, characteristic.max_write_without_response_size):
+            await self.client.write_gatt_char(characteristic, chunk, response=False)
+
+    async def read_until(self, marker, timeout=30):
+        deadline = time.perf_counter() + timeout
+        while marker not in self.repl:
+            self.repl_event.clear()
+            remaining = deadline - time.perf_counter()
+            if remaining <= 0:
+                raise TimeoutError(f"no {marker!r} from the REPL")
+            await asyncio.wait_for(self.repl_event.wait(), remaining)
+        index = self.repl.index(marker) + len(marker)
+        output = bytes(self.repl[:index])
+        del self.repl[:index]
+        return output
+
+    async def raw_repl(self):
+        self.repl.clear()
+        await self.write(self.repl_rx, b"\x03\x01")
+        await self.read_until(b"raw REPL; CTRL-B to exit\r\n>")
+
+    async def exec_start(self, code):
+        await self.write(self.repl_rx, code.encode() + b"\x04")
+        await self.read_until(b"OK")
+
+    async def exec_result(self):
+        output = await self.read_until(b"\x04")
+        error = await self.read_until(b"\x04>")
+        if error[:-2]:
+            raise RuntimeError(error[:-2].decode())
+        return output[:-1].decode()
+
+    async def eval(self, code):
+        await self.exec_start(f"print(repr({code}))")
+        return eval(await self.exec_result())
+
+
+async def echo_latency(monocle):
+    # The friendly REPL echoes each character typed, and the backspace after
+    await monocle.write(monocle.repl_rx, b"\x02")
+    await monocle.read_until(b">>> ")
+    rounds = []
+    for _ in range(ECHO_ROUNDS):
+        for key, echo in ((b"x", b"x"), (b"\x08", b"\x08 \x08")):
+            start = time.perf_counter()
+            await monocle.write(monocle.repl_rx, key)
+            await monocle.read_until(echo)
+            rounds.append((time.perf_counter() - start) * 1000)
+    await monocle.raw_repl()
+    return {
+        "rounds": len(rounds),
+        "median_ms": round(statistics.median(rounds), 2),
+        "max_ms": round(max(rounds), 2),
+    }
+
+
+async def raw_upload(monocle):
+    code = "#" + "x" * (UPLOAD_BYTES - 1) + "\n"
+    start = time.perf_counter()
+    await monocle.exec_start(code)
+    seconds = time.perf_counter() - start
+    await monocle.exec_result()
+    return {"bytes": len(code), "bytes_per_s": round(len(code) / seconds)}
+
+
+async def data_send(monocle):
+    monocle.data_bytes = 0
+    monocle.data_first = None
+    await monocle.exec_start(f"print(repr(benchmark.send({DATA_BYTES})))")
+    device = eval(await monocle.exec_result())
+    seconds = (monocle.data_last or 0) - (monocle.data_first or 0)
+    return {
+        "bytes": monocle.data_bytes,
+        "bytes_per_s": round(monocle.data_bytes / seconds) if seconds else 0,
+        "device": device,
+    }
+
+
+async def data_receive(monocle):
+    await monocle.exec_start(f"print(repr(benchmark.receive({DATA_BYTES})))")
+    start = time.perf_counter()
+    await monocle.write(monocle.data_rx, bytes(DATA_BYTES))
+    seconds = time.perf_counter() - start
+    device = eval(await monocle.exec_result())
+    return {
+        "bytes": DATA_BYTES,
+        "bytes_per_s": round(DATA_BYTES / seconds),
+        "device": device,
+    }
+
+
+async def run():
+    from bleak import BleakClient, BleakScanner
+
+    device = await BleakScanner.find_device_by_filter(
+        lambda device, adv: (adv.local_name or "").lower() == "monocle"
+    )
+    if device is None:
+        sys.exit("no Monocle found")
+
+    async with BleakClient(device) as client:
+        monocle = Monocle(client)
+        await monocle.start()
+        await monocle.raw_repl()
+        await monocle.exec_start("import benchmark, device")
+        await monocle.exec_result()
+
+        results = {
+            "time": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+            "version": await monocle.eval("device.VERSION"),
+            "git_tag": await monocle.eval("device.GIT_TAG"),
+            "link": await monocle.eval("benchmark.link()"),
+            "repl_echo": await echo_latency(monocle),
+            "raw_repl_upload": await raw_upload(monocle),
+            "data_send": await data_send(monocle),
+            "data_receive": await data_receive(monocle),
+            "display_fps": await monocle.eval("benchmark.show()"),
+            "flash": await monocle.eval("benchmark.flash()"),
+        }
+
+        await monocle.write(monocle.repl_rx, b"\x02")
+
+    return results
+
+
+if __name__ == "__main__":
+    if len(sys.argv) > 2:
+        print(__doc__)
+        sys.exit(1)
+
+    results = asyncio.run(run())
+
+    if len(sys.argv) == 2:
+        with open(sys.argv[1], "w") as f:
+            json.dump(results, f, indent=2)
+    else:
+        print(json.dumps(results, indent=2))
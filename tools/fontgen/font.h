@@ -1,5 +1,10 @@
 extern uint8_t const font_50[];
+extern uint16_t const font_50_index[];
 extern uint8_t const font_26[];
+extern uint16_t const font_26_index[];
 extern uint8_t const font_13[];
+extern uint16_t const font_13_index[];
 extern uint8_t const font_7[];
+extern uint16_t const font_7_index[];
 extern uint8_t const font_8[];
+extern uint16_t const font_8_index[];
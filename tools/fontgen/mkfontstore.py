@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""
+Build a font store image for the external flash from txt2cfont sources.
+
+Glyphs use the same encoding as txt2cfont: a width byte, then the bitmap
+with one bit per pixel, row by row, least significant bit first. Unlike
+txt2cfont, glyphs may be any UTF-8 character and in any order. Codepoints
+missing between the first and the last one are drawn as a space.
+
+With -s, glyphs are spans as with txt2cfont -s instead: the width, then
+for each row the number of spans before it and one past the last row, then
+each span as a start from the right edge and a length. The font entry is
+flagged so that the display renders it as such.
+
+Write the image to Monocle with update.Assets.erase() then
+update.Assets.write() in chunks.
+
+usage: mkfontstore.py [-s] font_26.txt font_13.txt ... >fontstore.bin
+"""
+
+import struct
+import sys
+
+STORE_LENGTH = 0x10000
+MAGIC = b"MFNT"
+MAX_FONTS = 16
+HEADER = struct.Struct("<4sHH")
+ENTRY = struct.Struct("<BBHHHI")
+FORMAT_BITMAP = 0
+FORMAT_SPANS = 1
+
+
+def parse_font(path):
+    glyphs = {}
+    name = None
+    rows = []
+
+    def end_glyph():
+        if name is None:
+            return
+        widths = {len(row) for row in rows}
+        if len(widths) != 1:
+            sys.exit(f"{path}: glyph {name!r} changes its width")
+        glyphs[name] = rows
+
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.rstrip("\r\n")
+            if line.strip() == "":
+                continue
+            if line.startswith("\t"):
+                rows.append([c == "#" for c in line if c in ".#"])
+                continue
+            if len(line) < 2 or line[1] != ":":
+                sys.exit(f"{path}: expected 'c:' got {line!r}")
+            end_glyph()
+            name = line[0]
+            rows = []
+        end_glyph()
+
+    heights = {len(rows) for rows in glyphs.values()}
+    if len(heights) != 1:
+        sys.exit(f"{path}: glyphs of different heights")
+    if " " not in glyphs:
+        sys.exit(f"{path}: a space glyph is required")
+
+    return heights.pop(), glyphs
+
+
+def encode_glyph(rows):
+    bits = [bit for row in rows for bit in row]
+    data = bytearray((len(bits) + 7) // 8)
+    for i, bit in enumerate(bits):
+        if bit:
+            data[i // 8] |= 1 << (i % 8)
+    return bytes([len(rows[0])]) + bytes(data)
+
+
+def encode_glyph_spans(rows):
+    width = len(rows[0])
+    first = []
+    spans = []
+    for row in rows:
+        first.append(len(spans) // 2)
+        mirrored = row[::-1]
+        m = 0
+        while m < width:
+            if not mirrored[m]:
+                m += 1
+                continue
+            beg = m
+            while m < width and mirrored[m]:
+                m += 1
+            spans += [beg, m - beg]
+    first.append(len(spans) // 2)
+    if first[-1] > 255:
+        sys.exit("glyph has too many spans")
+    return bytes([width] + first + spans)
+
+
+def main(paths):
+    spans = paths[:1] == ["-s"]
+    if spans:
+        paths = paths[1:]
+
+    if not paths or len(paths) > MAX_FONTS:
+        sys.exit(__doc__.strip().splitlines()[-1])
+
+    fonts = [parse_font(path) for path in paths]
+    image = bytearray(HEADER.size + ENTRY.size * len(fonts))
+    HEADER.pack_into(image, 0, MAGIC, len(fonts), 0)
+
+    for n, (height, glyphs) in enumerate(fonts):
+        codepoints = sorted(ord(c) for c in glyphs)
+        first, last = codepoints[0], codepoints[-1]
+
+        index_at = len(image)
+        image += bytes(4 * (last - first + 1))
+
+        addresses = {}
+        for c, rows in glyphs.items():
+            addresses[ord(c)] = len(image)
+            image += encode_glyph_spans(rows) if spans else encode_glyph(rows)
+
+        for i, cp in enumerate(range(first, last + 1)):
+            address = addresses.get(cp, addresses[ord(" ")])
+            struct.pack_into("<I", image, index_at + 4 * i, address)
+
+        ENTRY.pack_into(image, HEADER.size + ENTRY.size * n,
+                        height, FORMAT_SPANS if spans else FORMAT_BITMAP,
+                        first, last, 0, index_at)
+
+    if len(image) > STORE_LENGTH:
+        sys.exit(f"image is {len(image)} bytes, the store is {STORE_LENGTH}")
+
+    sys.stdout.buffer.write(image)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
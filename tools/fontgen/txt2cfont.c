@@ -34,6 +34,7 @@ struct {
 static char *flag_t = "uint8_t const";
 static char *flag_a;
 static char *flag_p = "";
+static int flag_s;
 
 static void
 fatal(char *fmt, ...)
@@ -60,6 +61,15 @@ parse_name(char *s)
 	return s[0];
 }
 
+static void
+print_index(char *name, size_t *offsets)
+{
+	printf("\nuint16_t const %s_index[] = {\n", name);
+	for (char c = ASCII_FIRST; c <= '~'; c++)
+		printf("\t/* %c */ %zu,\n", c, offsets[c - ASCII_FIRST]);
+	printf("};\n");
+}
+
 static void
 print_glyph(glyph_t *g)
 {
@@ -74,6 +84,65 @@ print_glyph(glyph_t *g)
 	printf("\n");
 }
 
+static int
+get_bit(glyph_t *g, size_t x, size_t y)
+{
+	size_t i = y * g->width + x;
+
+	return g->buf[i / 8] >> (i % 8) & 1;
+}
+
+/*
+ * With -s, glyphs are horizontal spans instead of a bitmap: the width, then
+ * for each row the number of spans before it, and one past the last row, then
+ * each span as a start and a length. Starts count from the right edge of the
+ * glyph, as the display is flipped horizontally, so spans fill the row buffer
+ * in order.
+ */
+static size_t
+glyph_spans(glyph_t *g, uint8_t *first, uint8_t *spans)
+{
+	size_t n = 0;
+
+	for (size_t y = 0; y < g->height; y++) {
+		first[y] = n;
+		for (size_t m = 0; m < g->width;) {
+			if (!get_bit(g, g->width - 1 - m, y)) {
+				m++;
+				continue;
+			}
+			size_t beg = m;
+			while (m < g->width && get_bit(g, g->width - 1 - m, y))
+				m++;
+			if (n == UINT8_MAX)
+				fatal("glyph '%c' has too many spans", g->c);
+			spans[2 * n + 0] = beg;
+			spans[2 * n + 1] = m - beg;
+			n++;
+		}
+	}
+	first[g->height] = n;
+	return n;
+}
+
+static size_t
+print_glyph_spans(glyph_t *g)
+{
+	uint8_t first[GLYPH_MAX_SIZE + 1], spans[2 * UINT8_MAX];
+	size_t n;
+
+	n = glyph_spans(g, first, spans);
+
+	printf("\t/* %c */ %zd,", g->c, g->width);
+	for (size_t y = 0; y <= g->height; y++)
+		printf(" %"PRIu8",", first[y]);
+	for (size_t i = 0; i < 2 * n; i++)
+		printf(" %"PRIu8",", spans[i]);
+	printf("\n");
+
+	return 1 + g->height + 1 + 2 * n;
+}
+
 static void
 add_bit(uint8_t *buf, size_t sz, size_t *byte, size_t *bit, int val)
 {
@@ -191,7 +260,8 @@ static void
 txt2cfont(char *path)
 {
 	char buf[128];
-	size_t h;
+	size_t h, offset;
+	size_t offsets['~' - ASCII_FIRST + 1];
 
 	memset(&ctx, 0, sizeof ctx);
 	ctx.ascii = ASCII_FIRST;
@@ -203,17 +273,29 @@ txt2cfont(char *path)
 	if (flag_a != NULL)
 		printf("%s\n", flag_a);
 	printf("%s %s[] = {\n", flag_t, font_name(buf, sizeof buf, path));
+
+	/* the height byte comes first, then each glyph's width and bitmap */
+	offset = 1;
 	for (glyph_t g; parse_glyph(&g); h = g.height) {
 		if (ctx.ascii == ASCII_FIRST)
 			printf("\n\t/* height */ %zu,\n\n", g.height);
 		else if (h != g.height)
 			fatal("glyph '%c' of different height", ctx.ascii);
-		print_glyph(&g);
+		offsets[ctx.ascii - ASCII_FIRST] = offset;
+		if (flag_s) {
+			offset += print_glyph_spans(&g);
+		} else {
+			print_glyph(&g);
+			offset += 1 + (g.height * g.width + 7) / 8;
+		}
 		ctx.ascii++;
 	}
 	if (ctx.ascii <= '~')
 		fatal("missing characters, next should be '%c'", ctx.ascii);
 	printf("};\n");
+	if (offset > UINT16_MAX)
+		fatal("%s: font too large for a 16-bit index", path);
+	print_index(font_name(buf, sizeof buf, path), offsets);
 }
 
 char const *arg0;
@@ -222,7 +304,7 @@ static void
 usage(void)
 {
 	fprintf(stderr, "usage: %s"
-	    " [-a attribute] [-i include] [-p prefix] [-t type] file\n",
+	    " [-s] [-a attribute] [-i include] [-p prefix] [-t type] file\n",
 	    arg0);
 	exit(1);
 }
@@ -231,7 +313,7 @@ int
 main(int argc, char *argv[])
 {
 	arg0 = *argv;
-	for (int o; (o = getopt(argc, argv, "a:i:p:t:")) != -1;) {
+	for (int o; (o = getopt(argc, argv, "a:i:p:st:")) != -1;) {
 		switch (o) {
 		case 'a':
 			flag_a = optarg;
@@ -242,6 +324,9 @@ main(int argc, char *argv[])
 		case 'p':
 			flag_p = optarg;
 			break;
+		case 's':
+			flag_s = 1;
+			break;
 		case 't':
 			flag_t = optarg;
 			break;
@@ -0,0 +1,154 @@
+"""
+Sampling profiler reports for Monocle.
+
+On the device, profile some code and keep the dump:
+
+    import profiler
+    profiler.start(hz=1000)
+    ...
+    profiler.stop()
+
+Then either fetch the dump over Bluetooth, which runs
+bluetooth.send_stream(profiler.dump()) through the REPL and reassembles
+the stream fragments from the data service:
+
+    python3 tools/profiler.py capture profile.bin
+
+Or save the bytes of profiler.dump() to a file by other means. Then
+symbolise against the firmware built with `make`:
+
+    python3 tools/profiler.py report profile.bin build/application.elf
+    python3 tools/profiler.py report profile.bin build/application.map
+
+Reading the ELF needs arm-none-eabi-nm on the PATH.
+"""
+
+import bisect
+import re
+import struct
+import subprocess
+import sys
+
+REPL_RX_CHAR_UUID = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"
+DATA_TX_CHAR_UUID = "E5700003-7BAC-429A-B4CE-57FF900F479D"
+
+# Fragments from bluetooth.send_stream() start with this header byte
+STREAM_HEADER_LAST = 0x80
+STREAM_HEADER_SEQUENCE = 0x7F
+
+
+def parse_dump(data):
+    magic, rate, samples, dropped = struct.unpack_from("<4sIII", data)
+    if magic != b"PROF":
+        raise ValueError("not a profiler dump")
+    pcs = list(struct.iter_unpack("<II", data[16:]))
+    return rate, samples, dropped, pcs
+
+
+def symbols_from_elf(path):
+    output = subprocess.run(
+        ["arm-none-eabi-nm", "--numeric-sort", "--print-size", "--demangle", path],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in "tTwW":
+            symbols.append((int(fields[0], 16), int(fields[1], 16), fields[3]))
+    return symbols
+
+
+def symbols_from_map(path):
+    # With -ffunction-sections each function is a .text.<name> input section,
+    # which ld prints either on one line or with the address on the next one
+    section = re.compile(r"^ \.text\.(\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+))?")
+    location = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s")
+    symbols = []
+    pending = None
+    with open(path) as f:
+        for line in f:
+            match = section.match(line)
+            if match:
+                if match.group(2):
+                    symbols.append((int(match.group(2), 16), int(match.group(3), 16), match.group(1)))
+                    pending = None
+                else:
+                    pending = match.group(1)
+                continue
+            match = location.match(line)
+            if pending and match:
+                symbols.append((int(match.group(1), 16), int(match.group(2), 16), pending))
+            pending = None
+    return sorted(symbols)
+
+
+def symbolise(pcs, symbols):
+    starts = [start for start, _, _ in symbols]
+    totals = {}
+    for pc, count in pcs:
+        i = bisect.bisect_right(starts, pc) - 1
+        name = "?"
+        if i >= 0:
+            start, size, symbol = symbols[i]
+            if pc < start + max(size, 1):
+                name = symbol
+        if name == "?":
+            name = f"0x{pc:08x}"
+        totals[name] = totals.get(name, 0) + count
+    return sorted(totals.items(), key=lambda item: item[1], reverse=True)
+
+
+def report(dump_path, firmware_path):
+    with open(dump_path, "rb") as f:
+        rate, samples, dropped, pcs = parse_dump(f.read())
+
+    if firmware_path.endswith(".map"):
+        symbols = symbols_from_map(firmware_path)
+    else:
+        symbols = symbols_from_elf(firmware_path)
+
+    print(f"{samples} samples at {rate} Hz, {dropped} dropped from a full table")
+    for name, count in symbolise(pcs, symbols):
+        print(f"{100 * count / max(samples, 1):6.2f}% {count:8d}  {name}")
+
+
+async def capture(dump_path):
+    import asyncio
+    from bleak import BleakClient, BleakScanner
+
+    device = await BleakScanner.find_device_by_filter(
+        lambda device, adv: (adv.local_name or "").lower() == "monocle"
+    )
+    if device is None:
+        sys.exit("no Monocle found")
+
+    fragments = bytearray()
+    done = asyncio.Event()
+
+    def handle_data(_, data):
+        fragments.extend(data[1:])
+        if data[0] & STREAM_HEADER_LAST:
+            done.set()
+
+    async with BleakClient(device) as client:
+        await client.start_notify(DATA_TX_CHAR_UUID, handle_data)
+        command = b"import profiler, bluetooth; bluetooth.send_stream(profiler.dump())\r\n"
+        await client.write_gatt_char(REPL_RX_CHAR_UUID, command, response=False)
+        await asyncio.wait_for(done.wait(), 30)
+
+    with open(dump_path, "wb") as f:
+        f.write(fragments)
+    print(f"saved {len(fragments)} bytes to {dump_path}")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 3 and sys.argv[1] == "capture":
+        import asyncio
+        asyncio.run(capture(sys.argv[2]))
+    elif len(sys.argv) == 4 and sys.argv[1] == "report":
+        report(sys.argv[2], sys.argv[3])
+    else:
+        print(__doc__)
+        sys.exit(1)
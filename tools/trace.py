@@ -0,0 +1,101 @@
+"""
+Event trace timelines for Monocle.
+
+Build the firmware with the trace points enabled, and flash it:
+
+    make TRACE=1 flash
+
+Then log the binary stream from RTT channel 1 with a J-Link, while running
+whatever is being looked at:
+
+    JLinkRTTLogger -Device NRF52832_XXAA -If SWD -Speed 4000 -RTTChannel 1 trace.bin
+
+And convert it to Chrome trace JSON, to be opened in chrome://tracing or
+https://ui.perfetto.dev:
+
+    python3 tools/trace.py trace.bin trace.json
+
+Records are 6 bytes: event, argument, and the 64MHz cycle counter. The
+counter wraps every 67 seconds, so a gap longer than that between two
+events shifts the rest of the timeline.
+"""
+
+import json
+import struct
+import sys
+
+CPU_HZ = 64_000_000
+
+BLE_CHANNELS = ["repl", "data", "file"]
+SPI_DEVICES = ["display", "fpga", "flash"]
+
+# Event number: (track, name, phase), in the order of trace_event_t
+EVENTS = [
+    ("ble", "hvx queued", "i"),
+    ("ble", "hvx complete", "i"),
+    ("spi", "spi", "B"),
+    ("spi", "spi", "E"),
+    ("display", "show", "B"),
+    ("display", "show", "E"),
+    ("display", "render row", "B"),
+    ("display", "render row", "E"),
+    ("display", "flush row", "B"),
+    ("display", "flush row", "E"),
+    ("gc", "gc", "B"),
+    ("gc", "gc", "E"),
+    ("scheduler", "scheduled", "i"),
+]
+
+TRACKS = ["display", "spi", "ble", "gc", "scheduler"]
+
+
+def parse_records(data):
+    usable = len(data) - len(data) % 6
+    return struct.iter_unpack("<BBI", data[:usable])
+
+
+def chrome_events(records):
+    events = [
+        {"ph": "M", "pid": 0, "tid": tid, "name": "thread_name", "args": {"name": track}}
+        for tid, track in enumerate(TRACKS)
+    ]
+    last = None
+    wraps = 0
+
+    for event, arg, cycles in records:
+        if event >= len(EVENTS):
+            raise ValueError(f"unknown trace event {event}")
+
+        # Unwrap the 32-bit cycle counter
+        if last is not None and cycles < last:
+            wraps += 1
+        last = cycles
+        us = ((wraps << 32) + cycles) * 1_000_000 / CPU_HZ
+
+        track, name, phase = EVENTS[event]
+        record = {"ph": phase, "pid": 0, "tid": TRACKS.index(track), "ts": us}
+
+        if track == "spi":
+            name = SPI_DEVICES[arg] if arg < len(SPI_DEVICES) else f"spi {arg}"
+        elif name == "hvx queued":
+            record["args"] = {"channel": BLE_CHANNELS[arg] if arg < len(BLE_CHANNELS) else arg}
+        elif name == "hvx complete":
+            record["args"] = {"count": arg}
+
+        if phase == "i":
+            record["s"] = "t"
+        record["name"] = name
+        events.append(record)
+
+    return events
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("usage: trace.py trace.bin trace.json")
+
+    with open(sys.argv[1], "rb") as f:
+        records = parse_records(f.read())
+
+    with open(sys.argv[2], "w") as f:
+        json.dump({"traceEvents": chrome_events(records)}, f)